@@ -4,3 +4,4 @@
 
 static constexpr uint32_t kTerrainDecalServiceID = 0xD4A3B911;
 static constexpr uint32_t GZIID_cIGZTerrainDecalService = 0xD4A3B912;
+static constexpr uint32_t GZIID_cIGZTerrainDecalService2 = 0xD4A3B913;
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "cIGZTerrainDecalService.h"
+
+// Per-item outcome of a batch call.
+enum class TerrainDecalBatchResult : uint32_t {
+    Ok = 0,
+    InvalidArgument = 1,
+    ValidationFailed = 2,
+    NotFound = 3,
+    NoCity = 4,
+    NoOverlayManager = 5,
+    RuntimeFailed = 6,
+};
+
+// Field mask for UpdateDecal. Fields outside the mask keep their current value.
+static constexpr uint32_t kTerrainDecalFieldCenter = 1u << 0;
+// The whole decalInfo, center included.
+static constexpr uint32_t kTerrainDecalFieldDecalInfo = 1u << 1;
+static constexpr uint32_t kTerrainDecalFieldOpacity = 1u << 2;
+static constexpr uint32_t kTerrainDecalFieldEnabled = 1u << 3;
+static constexpr uint32_t kTerrainDecalFieldColor = 1u << 4;
+static constexpr uint32_t kTerrainDecalFieldDrawMode = 1u << 5;
+// hasUvWindow and uvWindow.
+static constexpr uint32_t kTerrainDecalFieldUvWindow = 1u << 6;
+static constexpr uint32_t kTerrainDecalFieldDepthOffset = 1u << 7;
+
+enum class TerrainDecalChangeKind : uint32_t {
+    Created = 0,
+    // ReplaceDecal, UpdateDecal or their batch variants changed the state.
+    Replaced = 1,
+    Removed = 2,
+};
+
+struct TerrainDecalChange {
+    uint64_t sequence = 0;
+    TerrainDecalId id{};
+    TerrainDecalChangeKind kind = TerrainDecalChangeKind::Created;
+};
+
+enum class TerrainDecalChangesResult : uint32_t {
+    Ok = 0,
+    // The requested sequence is no longer in the journal (or was never issued). Rebuild from
+    // CopyDecals and continue from the returned sequence.
+    ResyncRequired = 1,
+    InvalidArgument = 2,
+};
+
+// Progress of recreating the decals loaded with a city. Loaded decals are recreated over several ticks,
+// nearest to the camera first.
+struct TerrainDecalRebindProgress {
+    // Decals read from the save.
+    uint32_t loaded = 0;
+    uint32_t rebound = 0;
+    // Still waiting, including decals whose overlay manager was unavailable and will be retried.
+    uint32_t pending = 0;
+    // Attempts that failed and were queued for another try.
+    uint32_t retries = 0;
+    uint32_t ticks = 0;
+    float elapsedMs = 0.0f;
+};
+
+// Why the built-in renderer handed an overlay draw back to the game's own terrain decal path.
+enum class TerrainDecalFallThroughReason : uint32_t {
+    RendererDisabled = 0,
+    IncompleteRequest = 1,
+    InvalidOverlaySlot = 2,
+    NonFiniteMatrix = 3,
+    // Nothing to clip and no managed overrides, so the vanilla draw is equivalent.
+    NoCustomPath = 4,
+    TransformOverrideFailed = 5,
+    NoTextureTransformStage = 6,
+    NoTerrainCells = 7,
+    ClipProducedNothing = 8,
+};
+
+static constexpr uint32_t kTerrainDecalFallThroughReasonCount = 9;
+
+// Renderer counters since the render hook was installed. Reasons may be appended, so fallThroughs stays last.
+struct TerrainDecalRendererDiagnostics {
+    // Overlay draws the renderer was asked for, including the shadow recovery pass.
+    uint64_t draws = 0;
+    // Terrain cells skipped because their clip UVs were not finite. The overlay itself is still drawn.
+    uint64_t nonFiniteClipCells = 0;
+    // Indexed by TerrainDecalFallThroughReason.
+    uint64_t fallThroughs[kTerrainDecalFallThroughReasonCount]{};
+};
+
+// Work done by the built-in renderer over one frame. A frame ends when the overlay manager moves on from
+// decals to shadows, after the shadow recovery replays. When the shadow pass does not run (shadows off),
+// the service closes the frame on its next tick instead, and only if decals were drawn since the last one.
+struct TerrainDecalRendererFrameStats {
+    // Frames completed since the render hook was installed; 0 until the first one.
+    uint64_t frame = 0;
+    // Normal-pass overlay draws drawn by the renderer or handed back to the game.
+    uint32_t decalsHandled = 0;
+    uint32_t decalsFallenThrough = 0;
+    uint32_t cellsVisited = 0;
+    // Visited cells outside the clip box.
+    uint32_t cellsCulled = 0;
+    uint32_t cellsFullyInside = 0;
+    // Cells cut against the clip box edges.
+    uint32_t cellsClipped = 0;
+    // Overlay draws that reused clipped geometry from the cache instead of visiting cells.
+    uint32_t geometryCacheHits = 0;
+    uint32_t verticesSubmitted = 0;
+    uint32_t drawCalls = 0;
+    uint32_t shadowRecoveryReplays = 0;
+    // Wall time inside the renderer's Draw, both passes, including the draw calls it made. Only measured
+    // while stats are being polled, so the first frame after polling starts reports 0.
+    float drawMs = 0.0f;
+};
+
+// Revision 2 of the terrain decal service, obtained with
+// QueryInterface(GZIID_cIGZTerrainDecalService2). Revision 1 callers keep using
+// cIGZTerrainDecalService unchanged; new entry points are only ever appended here.
+//
+// Batch calls resolve the city and overlay managers once per call. Arrays are
+// walked with the given element size as stride, like CopyDecals. outResults is
+// optional; when present it receives one entry per item. Each call returns the
+// number of items that succeeded.
+// ReSharper disable once CppPolymorphicClassWithNonVirtualPublicDestructor
+class cIGZTerrainDecalService2 : public cIGZTerrainDecalService {
+public:
+    virtual uint32_t CreateDecals(const TerrainDecalState* initialStates,
+                                  uint32_t count,
+                                  uint32_t stateSize,
+                                  TerrainDecalId* outIds,
+                                  TerrainDecalBatchResult* outResults) = 0;
+    virtual uint32_t RemoveDecals(const TerrainDecalId* ids,
+                                  uint32_t count,
+                                  TerrainDecalBatchResult* outResults) = 0;
+    virtual uint32_t ReplaceDecals(const TerrainDecalId* ids,
+                                   const TerrainDecalState* newStates,
+                                   uint32_t count,
+                                   uint32_t stateSize,
+                                   TerrainDecalBatchResult* outResults) = 0;
+
+    // Applies only the masked fields of newState to an existing decal, in place on its current overlay.
+    // ReplaceDecal also updates in place whenever textureKey and overlayType are unchanged.
+    virtual bool UpdateDecal(TerrainDecalId id,
+                             const TerrainDecalState* newState,
+                             uint32_t stateSize,
+                             uint32_t fieldMask) = 0;
+
+    // Spatial queries in world X/Z over each decal's base footprint square (center, baseSize,
+    // rotationTurns). They return the total number of matches and write at most capacity ids.
+    // Rect queries match footprint bounds; point queries test the rotated footprint itself.
+    virtual uint32_t QueryDecalsInRect(float minX,
+                                       float minZ,
+                                       float maxX,
+                                       float maxZ,
+                                       TerrainDecalId* outIds,
+                                       uint32_t capacity) const = 0;
+    virtual uint32_t QueryDecalsAtPoint(float x, float z, TerrainDecalId* outIds, uint32_t capacity) const = 0;
+    // Decal whose footprint center is closest to (x, z), if any lies within maxDistance.
+    virtual bool QueryNearestDecal(float x, float z, float maxDistance, TerrainDecalId* outId) const = 0;
+
+    // Change journal. Every create, replace and remove is assigned the next sequence number and kept in
+    // a bounded ring, so consumers can poll deltas instead of copying every snapshot. Start with sequence
+    // 0 and pass the returned *outSequence on the next call. Changes are written oldest first; when more
+    // than capacity are pending, *outSequence is the last one written and the rest follow next call.
+    // Loading or leaving a city drops the journal, which reports ResyncRequired to every older sequence.
+    // To start from a full copy, read GetChangeSequence() and then call CopyDecals.
+    [[nodiscard]] virtual uint64_t GetChangeSequence() const = 0;
+    virtual TerrainDecalChangesResult GetChangesSince(uint64_t sequence,
+                                                      TerrainDecalChange* outChanges,
+                                                      uint32_t capacity,
+                                                      uint32_t changeSize,
+                                                      uint32_t* outCount,
+                                                      uint64_t* outSequence) const = 0;
+
+    virtual bool GetRebindProgress(TerrainDecalRebindProgress* outProgress, uint32_t progressSize) const = 0;
+
+    // Terrain height revisions. The service hashes the terrain grid in blocks of 16 x 16 cells, a share of
+    // the blocks each tick, and gives a block the next revision number whenever its heights change.
+    // Revisions only grow, so geometry conformed to the terrain can keep the revision of the rect it
+    // covers and rebuild once that changes. GetTerrainRevision changes whenever any block does.
+    [[nodiscard]] virtual uint64_t GetTerrainRevision() const = 0;
+    // Highest block revision under the world X/Z rect.
+    [[nodiscard]] virtual uint64_t GetTerrainRevisionInRect(float minX, float minZ, float maxX, float maxZ) const = 0;
+
+    // Fall-through counters of the built-in renderer. Returns false while the render hook is not installed.
+    virtual bool GetRendererDiagnostics(TerrainDecalRendererDiagnostics* outDiagnostics,
+                                        uint32_t diagnosticsSize) const = 0;
+
+    // Stats of the last completed frame. The renderer fills one block while the previous one is read,
+    // so the copy never mixes two frames. Poll once per UI frame and compare frame to spot new data.
+    // Returns false while the render hook is not installed.
+    virtual bool GetRendererFrameStats(TerrainDecalRendererFrameStats* outStats, uint32_t statsSize) const = 0;
+};
@@ -5,14 +5,16 @@
 #include "public/ImGuiPanelAdapter.h"
 #include "public/ImGuiServiceIds.h"
 #include "public/cIGZImGuiService.h"
-#include "public/cIGZTerrainDecalService.h"
+#include "public/cIGZTerrainDecalService2.h"
 #include "public/TerrainDecalServiceIds.h"
 #include "cISTETerrainView.h"
 #include "utils/Logger.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
+#include <iterator>
 #include <vector>
 
 namespace
@@ -22,6 +24,41 @@ namespace
     constexpr uint32_t kDefaultTextureType = 0x7AB50E44;
     constexpr uint32_t kDefaultTextureGroup = 0x1ABE787D;
     constexpr uint32_t kDefaultTextureInstance = 0xAA40173A;
+    // Renderer frames averaged by the stats section.
+    constexpr size_t kRendererStatsHistory = 120;
+
+    struct RendererStatRow
+    {
+        const char* label;
+        uint32_t TerrainDecalRendererFrameStats::* field;
+    };
+
+    constexpr RendererStatRow kRendererStatRows[] = {
+        {"Decals handled", &TerrainDecalRendererFrameStats::decalsHandled},
+        {"Decals fallen through", &TerrainDecalRendererFrameStats::decalsFallenThrough},
+        {"Cells visited", &TerrainDecalRendererFrameStats::cellsVisited},
+        {"Cells culled", &TerrainDecalRendererFrameStats::cellsCulled},
+        {"Cells fully inside", &TerrainDecalRendererFrameStats::cellsFullyInside},
+        {"Cells clipped", &TerrainDecalRendererFrameStats::cellsClipped},
+        {"Geometry cache hits", &TerrainDecalRendererFrameStats::geometryCacheHits},
+        {"Vertices submitted", &TerrainDecalRendererFrameStats::verticesSubmitted},
+        {"Draw calls", &TerrainDecalRendererFrameStats::drawCalls},
+        {"Shadow recovery replays", &TerrainDecalRendererFrameStats::shadowRecoveryReplays},
+    };
+
+    // Indexed by TerrainDecalFallThroughReason.
+    constexpr const char* kFallThroughReasonLabels[kTerrainDecalFallThroughReasonCount] = {
+        "Renderer disabled",
+        "Incomplete request",
+        "Invalid overlay slot",
+        "Non-finite matrix",
+        "No custom path",
+        "Transform override failed",
+        "No texture transform stage",
+        "No terrain cells",
+        "Clip produced nothing",
+    };
+
     static float SnapToTileCenter(const float value)
     {
         return std::floor(value / 16.0f) * 16.0f + 8.0f;
@@ -126,6 +163,10 @@ namespace
         void OnInit() override
         {
             LOG_INFO("TerrainDecalSample: panel initialized");
+            if (service_ &&
+                !service_->QueryInterface(GZIID_cIGZTerrainDecalService2, reinterpret_cast<void**>(&service2_))) {
+                service2_ = nullptr;
+            }
             RefreshList();
         }
 
@@ -138,8 +179,8 @@ namespace
                 return;
             }
 
-            if (autoRefresh_ && listDirty_) {
-                RefreshList();
+            if (autoRefresh_) {
+                PollChanges();
             }
 
             ImGui::Begin("TerrainDecals Sample", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
@@ -167,6 +208,11 @@ namespace
             ImGui::SeparatorText("Actions");
             RenderActions_();
 
+            // Polling is what turns on the renderer's Draw timing, so only poll while the section is open.
+            if (ImGui::CollapsingHeader("Renderer stats")) {
+                RenderRendererStats_();
+            }
+
             ImGui::Separator();
             ImGui::TextWrapped("%s", status_);
             ImGui::End();
@@ -175,6 +221,10 @@ namespace
         void OnShutdown() override
         {
             LOG_INFO("TerrainDecalSample: panel shutdown");
+            if (service2_) {
+                service2_->Release();
+                service2_ = nullptr;
+            }
             delete this;
         }
 
@@ -186,8 +236,10 @@ namespace
     private:
         void RefreshList()
         {
-            listDirty_ = false;
             decals_.clear();
+            if (service2_) {
+                changeSequence_ = service2_->GetChangeSequence();
+            }
 
             const uint32_t count = service_->GetDecalCount();
             if (count == 0) {
@@ -211,9 +263,74 @@ namespace
             }
         }
 
-        void MarkListDirty()
+        // Applies journal deltas to decals_; falls back to a full copy when the journal has moved on.
+        void PollChanges()
+        {
+            if (!service2_) {
+                return;
+            }
+
+            TerrainDecalChange changes[64];
+            for (;;) {
+                uint32_t count = 0;
+                uint64_t nextSequence = changeSequence_;
+                const TerrainDecalChangesResult result = service2_->GetChangesSince(
+                    changeSequence_,
+                    changes,
+                    static_cast<uint32_t>(std::size(changes)),
+                    static_cast<uint32_t>(sizeof(TerrainDecalChange)),
+                    &count,
+                    &nextSequence);
+                if (result != TerrainDecalChangesResult::Ok) {
+                    RefreshList();
+                    return;
+                }
+
+                for (uint32_t i = 0; i < count; ++i) {
+                    ApplyChange(changes[i]);
+                }
+                changeSequence_ = nextSequence;
+                if (count < std::size(changes)) {
+                    return;
+                }
+            }
+        }
+
+        void ApplyChange(const TerrainDecalChange& change)
+        {
+            const auto it = std::find_if(decals_.begin(), decals_.end(), [&](const TerrainDecalSnapshot& snapshot) {
+                return snapshot.id.value == change.id.value;
+            });
+
+            TerrainDecalSnapshot snapshot{};
+            const bool live = change.kind != TerrainDecalChangeKind::Removed &&
+                              service_->GetDecal(change.id, &snapshot, static_cast<uint32_t>(sizeof(snapshot)));
+            if (!live) {
+                if (it != decals_.end()) {
+                    decals_.erase(it);
+                }
+                if (selectedId_.value == change.id.value) {
+                    selectedId_ = {};
+                }
+                return;
+            }
+
+            if (it != decals_.end()) {
+                *it = snapshot;
+            }
+            else {
+                decals_.push_back(snapshot);
+            }
+        }
+
+        void SyncList()
         {
-            listDirty_ = true;
+            if (service2_) {
+                PollChanges();
+            }
+            else {
+                RefreshList();
+            }
         }
 
         void SetStatus(const char* text)
@@ -249,8 +366,7 @@ namespace
             }
 
             selectedId_ = newId;
-            MarkListDirty();
-            RefreshList();
+            SyncList();
             SetStatus("Decal created");
             return true;
         }
@@ -267,8 +383,7 @@ namespace
                 return false;
             }
 
-            MarkListDirty();
-            RefreshList();
+            SyncList();
             SetStatus("Decal updated");
             return true;
         }
@@ -286,8 +401,7 @@ namespace
             }
 
             selectedId_ = {};
-            MarkListDirty();
-            RefreshList();
+            SyncList();
             SetStatus("Decal removed");
             return true;
         }
@@ -404,14 +518,99 @@ namespace
             }
         }
 
+        void RenderRendererStats_()
+        {
+            if (!service2_) {
+                ImGui::TextUnformatted("Renderer stats need cIGZTerrainDecalService2.");
+                return;
+            }
+
+            TerrainDecalRendererFrameStats stats{};
+            if (!service2_->GetRendererFrameStats(&stats, static_cast<uint32_t>(sizeof(stats)))) {
+                ImGui::TextUnformatted("The custom terrain decal renderer is not installed.");
+                return;
+            }
+
+            if (stats.frame != 0 && stats.frame != lastStatsFrame_) {
+                lastStatsFrame_ = stats.frame;
+                statsHistory_[statsHistoryNext_] = stats;
+                statsHistoryNext_ = (statsHistoryNext_ + 1) % statsHistory_.size();
+                statsHistoryCount_ = std::min(statsHistoryCount_ + 1, statsHistory_.size());
+            }
+
+            ImGui::Text("Frame %llu, averaged over the last %zu frames",
+                        static_cast<unsigned long long>(stats.frame),
+                        statsHistoryCount_);
+            ImGui::SameLine();
+            if (ImGui::Button("Reset averages")) {
+                statsHistoryCount_ = 0;
+                statsHistoryNext_ = 0;
+            }
+
+            if (statsHistoryCount_ > 0 && ImGui::BeginTable("##RendererStats", 3, ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Per frame");
+                ImGui::TableSetupColumn("Last");
+                ImGui::TableSetupColumn("Average");
+                ImGui::TableHeadersRow();
+
+                for (const RendererStatRow& row : kRendererStatRows) {
+                    double sum = 0.0;
+                    for (size_t i = 0; i < statsHistoryCount_; ++i) {
+                        sum += statsHistory_[i].*row.field;
+                    }
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(row.label);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", stats.*row.field);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", sum / static_cast<double>(statsHistoryCount_));
+                }
+
+                double drawMsSum = 0.0;
+                for (size_t i = 0; i < statsHistoryCount_; ++i) {
+                    drawMsSum += statsHistory_[i].drawMs;
+                }
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted("Time in Draw (ms)");
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.drawMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", drawMsSum / static_cast<double>(statsHistoryCount_));
+                ImGui::EndTable();
+            }
+
+            TerrainDecalRendererDiagnostics diagnostics{};
+            if (!service2_->GetRendererDiagnostics(&diagnostics, static_cast<uint32_t>(sizeof(diagnostics)))) {
+                return;
+            }
+
+            ImGui::Text("Since install: %llu draws, %llu non-finite clip cells",
+                        static_cast<unsigned long long>(diagnostics.draws),
+                        static_cast<unsigned long long>(diagnostics.nonFiniteClipCells));
+            for (uint32_t i = 0; i < kTerrainDecalFallThroughReasonCount; ++i) {
+                if (diagnostics.fallThroughs[i] != 0) {
+                    ImGui::BulletText("%s: %llu",
+                                      kFallThroughReasonLabels[i],
+                                      static_cast<unsigned long long>(diagnostics.fallThroughs[i]));
+                }
+            }
+        }
+
     private:
         cIGZTerrainDecalService* service_ = nullptr;
+        cIGZTerrainDecalService2* service2_ = nullptr;
         std::vector<TerrainDecalSnapshot> decals_{};
+        uint64_t changeSequence_ = 0;
         TerrainDecalId selectedId_{};
         TerrainDecalState editor_{};
         bool autoRefresh_ = true;
-        bool listDirty_ = true;
         char status_[256] = "Idle";
+        std::array<TerrainDecalRendererFrameStats, kRendererStatsHistory> statsHistory_{};
+        size_t statsHistoryNext_ = 0;
+        size_t statsHistoryCount_ = 0;
+        uint64_t lastStatsFrame_ = 0;
     };
 }
 
@@ -27,6 +27,7 @@
 #include "cIGZSerializable.h"
 #include "cIGZVariant.h"
 #include "public/cIGZImGuiService.h"
+#include "public/cIGZTerrainDecalService2.h"
 #include "utils/Logger.h"
 
 #ifdef min
@@ -1282,6 +1283,56 @@ void RebuildRoadDecalGeometry()
     SetRoadDecalSelectedStroke(GetSelectedRoadMarkupStrokeConst());
 }
 
+bool RefreshRoadMarkupsForTerrain(const cIGZTerrainDecalService2* terrainDecalService)
+{
+    static uint64_t sLastTerrainRevision = 0;
+    if (!terrainDecalService) {
+        return false;
+    }
+
+    const uint64_t terrainRevision = terrainDecalService->GetTerrainRevision();
+    if (terrainRevision == sLastTerrainRevision) {
+        return false;
+    }
+    sLastTerrainRevision = terrainRevision;
+
+    bool changed = false;
+    for (auto& layer : gRoadMarkupLayers) {
+        for (auto& stroke : layer.strokes) {
+            if (stroke.points.empty()) {
+                continue;
+            }
+
+            float minX = stroke.points.front().x;
+            float maxX = minX;
+            float minZ = stroke.points.front().z;
+            float maxZ = minZ;
+            for (const auto& p : stroke.points) {
+                minX = std::min(minX, p.x);
+                maxX = std::max(maxX, p.x);
+                minZ = std::min(minZ, p.z);
+                maxZ = std::max(maxZ, p.z);
+            }
+            // Symbols and crossings are built around their points, so widen by the larger extent.
+            const float margin = std::max(stroke.width, stroke.length);
+            const uint64_t strokeRevision = terrainDecalService->GetTerrainRevisionInRect(
+                minX - margin, minZ - margin, maxX + margin, maxZ + margin);
+            if (strokeRevision == stroke.terrainRevision) {
+                continue;
+            }
+
+            stroke.terrainRevision = strokeRevision;
+            ConformPointsToTerrain(stroke.points);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        RebuildRoadDecalGeometry();
+    }
+    return changed;
+}
+
 void DrawRoadDecals()
 {
     if (gRoadDecalVertices.empty() &&
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+class cIGZTerrainDecalService2;
+
 struct RoadDecalPoint
 {
     float x;
@@ -90,6 +92,8 @@ struct RoadMarkupStroke
     float opacity = 1.0f;
     bool visible = true;
     uint32_t layerId = 0;
+    // Terrain revision under the stroke when its points were last conformed; 0 until first checked.
+    uint64_t terrainRevision = 0;
 };
 
 struct RoadMarkupLayer
@@ -130,6 +134,8 @@ bool MoveSelectedRoadMarkupStroke(float deltaX, float deltaZ);
 bool RotateSelectedRoadMarkupStroke(float deltaRadians);
 
 void RebuildRoadDecalGeometry();
+// Re-conforms the strokes whose terrain revision changed and rebuilds the geometry if any did.
+bool RefreshRoadMarkupsForTerrain(const cIGZTerrainDecalService2* terrainDecalService);
 void DrawRoadDecals();
 
 // Shows the currently edited stroke (already-placed click points).
@@ -6,6 +6,8 @@
 #include "public/ImGuiServiceIds.h"
 #include "public/cIGZDrawService.h"
 #include "public/cIGZImGuiService.h"
+#include "public/cIGZTerrainDecalService2.h"
+#include "public/TerrainDecalServiceIds.h"
 #include "sample/road-decal/RoadDecalData.hpp"
 #include "sample/road-decal/RoadDecalInputControl.hpp"
 #include "utils/Logger.h"
@@ -134,11 +136,12 @@ namespace
         }
     }
 
-    void DrawPassRoadDecalCallback(DrawServicePass pass, bool begin, void*)
+    void DrawPassRoadDecalCallback(DrawServicePass pass, bool begin, void* userData)
     {
         if (pass != DrawServicePass::PreDynamic || begin) {
             return;
         }
+        RefreshRoadMarkupsForTerrain(static_cast<const cIGZTerrainDecalService2*>(userData));
         DrawRoadDecals();
     }
 
@@ -485,9 +488,16 @@ public:
             return true;
         }
 
+        if (!mpFrameWork->GetSystemService(kTerrainDecalServiceID,
+                                           GZIID_cIGZTerrainDecalService2,
+                                           reinterpret_cast<void**>(&terrainDecalService_))) {
+            LOG_WARN("RoadMarkup: Terrain decal service not available, markups will not follow terrain edits");
+            terrainDecalService_ = nullptr;
+        }
+
         drawService_->RegisterDrawPassCallback(DrawServicePass::PreDynamic,
                                                &DrawPassRoadDecalCallback,
-                                               nullptr,
+                                               terrainDecalService_,
                                                &drawPassCallbackToken_);
         return true;
     }
@@ -503,6 +513,11 @@ public:
             drawService_ = nullptr;
         }
 
+        if (terrainDecalService_) {
+            terrainDecalService_->Release();
+            terrainDecalService_ = nullptr;
+        }
+
         DestroyRoadDecalTool();
         gImGuiServiceForD3DOverlay.store(nullptr, std::memory_order_release);
 
@@ -518,6 +533,7 @@ public:
 private:
     cIGZImGuiService* imguiService_ = nullptr;
     cIGZDrawService* drawService_ = nullptr;
+    cIGZTerrainDecalService2* terrainDecalService_ = nullptr;
     uint32_t drawPassCallbackToken_ = 0;
     bool panelRegistered_ = false;
 };
@@ -113,9 +113,15 @@ public:
                  settings.GetEnableDrawService(),
                  settings.GetEnableTerrainDecalService(),
                  settings.GetEnableCustomTerrainDecalRenderer());
-        LOG_INFO("RenderServicesDirector: terrain decal renderer settings (DefaultDepthOffset={}, ShadowRecoveryOpacityScale={})",
+        LOG_INFO("RenderServicesDirector: terrain decal renderer settings (DefaultDepthOffset={}, ShadowRecoveryOpacityScale={}, GeometryCacheBudgetKB={}, IndexedSubmission={})",
                  settings.GetTerrainDecalCustomDefaultDepthOffset(),
-                 settings.GetTerrainDecalShadowRecoveryOpacityScale());
+                 settings.GetTerrainDecalShadowRecoveryOpacityScale(),
+                 settings.GetTerrainDecalGeometryCacheBudgetKB(),
+                 settings.GetTerrainDecalIndexedSubmission());
+        LOG_INFO("RenderServicesDirector: terrain decal save/load settings (SidecarFormat={}, RebindBudgetMs={}, RebindBudgetCount={})",
+                 settings.GetTerrainDecalSidecarFormat(),
+                 settings.GetTerrainDecalRebindBudgetMs(),
+                 settings.GetTerrainDecalRebindBudgetCount());
 
         if (!mpFrameWork) {
             LOG_WARN("RenderServicesDirector: framework not available");
@@ -155,9 +161,11 @@ public:
         }
 
         // Register camera service (641-gated inside Init)
+        bool cameraServiceRegistered = false;
         if (settings.GetEnableS3DCameraService()) {
             if (cameraService_.Init()) {
                 mpFrameWork->AddSystemService(&cameraService_);
+                cameraServiceRegistered = true;
                 LOG_INFO("RenderServicesDirector: S3DCameraService registered");
             } else {
                 LOG_WARN("RenderServicesDirector: S3DCameraService not registered (version check failed)");
@@ -182,6 +190,12 @@ public:
             terrainDecalService_.SetEnableCustomRenderer(settings.GetEnableCustomTerrainDecalRenderer());
             terrainDecalService_.SetCustomDefaultDepthOffset(settings.GetTerrainDecalCustomDefaultDepthOffset());
             terrainDecalService_.SetShadowRecoveryOpacityScale(settings.GetTerrainDecalShadowRecoveryOpacityScale());
+            terrainDecalService_.SetGeometryCacheBudgetKB(settings.GetTerrainDecalGeometryCacheBudgetKB());
+            terrainDecalService_.SetIndexedSubmission(settings.GetTerrainDecalIndexedSubmission());
+            terrainDecalService_.SetCompactSidecar(settings.GetTerrainDecalSidecarFormat() == "2.0");
+            terrainDecalService_.SetRebindBudget(settings.GetTerrainDecalRebindBudgetMs(),
+                                                 settings.GetTerrainDecalRebindBudgetCount());
+            terrainDecalService_.SetCameraService(cameraServiceRegistered ? &cameraService_ : nullptr);
             if (terrainDecalService_.Init()) {
                 mpFrameWork->AddSystemService(&terrainDecalService_);
                 mpFrameWork->AddToTick(&terrainDecalService_);
@@ -0,0 +1,201 @@
+#include "ClippedGeometryCache.h"
+
+#include <cstring>
+
+namespace TerrainDecal
+{
+    namespace
+    {
+        constexpr uint64_t kFnvOffsetBasis = 0xCBF29CE484222325ull;
+        constexpr uint64_t kFnvPrime = 0x100000001B3ull;
+
+        void HashBytes(uint64_t& hash, const void* const data, const size_t size) noexcept
+        {
+            const auto* const bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= kFnvPrime;
+            }
+        }
+
+        [[nodiscard]] bool SignaturesEqual(const ClippedGeometrySignature& a, const ClippedGeometrySignature& b) noexcept
+        {
+            // Bitwise matrix compare: the renderer never caches non-finite matrices.
+            return std::memcmp(a.slotMatrix.data(), b.slotMatrix.data(), sizeof(float) * a.slotMatrix.size()) == 0 &&
+                   a.xStart == b.xStart &&
+                   a.zStart == b.zStart &&
+                   a.xEnd == b.xEnd &&
+                   a.zEnd == b.zEnd &&
+                   a.clipU == b.clipU &&
+                   a.clipV == b.clipV &&
+                   a.clipBounds.minU == b.clipBounds.minU &&
+                   a.clipBounds.maxU == b.clipBounds.maxU &&
+                   a.clipBounds.minV == b.clipBounds.minV &&
+                   a.clipBounds.maxV == b.clipBounds.maxV &&
+                   a.terrainRevision == b.terrainRevision &&
+                   a.terrainHash == b.terrainHash;
+        }
+
+        [[nodiscard]] size_t GeometryBytes(const ClippedGeometry& geometry) noexcept
+        {
+            return geometry.vertices.size() * sizeof(PackedTerrainVertex) + geometry.indices.size() * sizeof(uint16_t);
+        }
+
+        [[nodiscard]] size_t EntryBytes(const ClippedGeometry& geometry) noexcept
+        {
+            return geometry.vertices.capacity() * sizeof(PackedTerrainVertex) +
+                   geometry.indices.capacity() * sizeof(uint16_t);
+        }
+    }
+
+    uint64_t HashClippedGeometrySignature(const ClippedGeometrySignature& signature) noexcept
+    {
+        uint64_t hash = kFnvOffsetBasis;
+        HashBytes(hash, signature.slotMatrix.data(), sizeof(float) * signature.slotMatrix.size());
+        const int rect[] = {signature.xStart, signature.zStart, signature.xEnd, signature.zEnd};
+        HashBytes(hash, rect, sizeof(rect));
+        const uint8_t clipFlags = static_cast<uint8_t>((signature.clipU ? 1u : 0u) | (signature.clipV ? 2u : 0u));
+        HashBytes(hash, &clipFlags, sizeof(clipFlags));
+        const float bounds[] = {
+            signature.clipBounds.minU,
+            signature.clipBounds.maxU,
+            signature.clipBounds.minV,
+            signature.clipBounds.maxV,
+        };
+        HashBytes(hash, bounds, sizeof(bounds));
+        HashBytes(hash, &signature.terrainRevision, sizeof(signature.terrainRevision));
+        HashBytes(hash, &signature.terrainHash, sizeof(signature.terrainHash));
+        return hash;
+    }
+
+    size_t ClippedGeometryCache::KeyHash::operator()(const Key& key) const noexcept
+    {
+        const auto managerBits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key.overlayManager));
+        return static_cast<size_t>((managerBits * kFnvPrime) ^ key.overlayId);
+    }
+
+    void ClippedGeometryCache::SetByteBudget(const size_t byteBudget)
+    {
+        byteBudget_ = byteBudget;
+        if (byteBudget_ == 0) {
+            Clear();
+            return;
+        }
+
+        EvictToBudget_();
+    }
+
+    size_t ClippedGeometryCache::GetByteBudget() const noexcept
+    {
+        return byteBudget_;
+    }
+
+    bool ClippedGeometryCache::IsEnabled() const noexcept
+    {
+        return byteBudget_ > 0;
+    }
+
+    const ClippedGeometry* ClippedGeometryCache::Find(const void* const overlayManager,
+                                                      const uint32_t overlayId,
+                                                      const ClippedGeometrySignature& signature) noexcept
+    {
+        const auto it = entries_.find(Key{overlayManager, overlayId});
+        if (it == entries_.end()) {
+            ++misses_;
+            return nullptr;
+        }
+
+        Entry& entry = it->second;
+        if (entry.signatureHash != HashClippedGeometrySignature(signature) ||
+            !SignaturesEqual(entry.signature, signature)) {
+            // Stale geometry for this overlay; drop it now so the slot is rebuilt on Store.
+            EraseEntry_(it);
+            ++misses_;
+            return nullptr;
+        }
+
+        lru_.splice(lru_.begin(), lru_, entry.lruPosition);
+        ++hits_;
+        return &entry.geometry;
+    }
+
+    void ClippedGeometryCache::Store(const void* const overlayManager,
+                                     const uint32_t overlayId,
+                                     const ClippedGeometrySignature& signature,
+                                     const ClippedGeometry& geometry)
+    {
+        if (!IsEnabled() || geometry.vertices.empty()) {
+            return;
+        }
+
+        if (GeometryBytes(geometry) > byteBudget_) {
+            return;
+        }
+
+        const Key key{overlayManager, overlayId};
+        if (const auto existing = entries_.find(key); existing != entries_.end()) {
+            EraseEntry_(existing);
+        }
+
+        lru_.push_front(key);
+        Entry entry{};
+        entry.signatureHash = HashClippedGeometrySignature(signature);
+        entry.signature = signature;
+        entry.geometry.vertices.assign(geometry.vertices.begin(), geometry.vertices.end());
+        entry.geometry.indices.assign(geometry.indices.begin(), geometry.indices.end());
+        entry.geometry.indexed = geometry.indexed;
+        entry.lruPosition = lru_.begin();
+        bytesUsed_ += EntryBytes(entry.geometry);
+        entries_.emplace(key, std::move(entry));
+
+        EvictToBudget_();
+    }
+
+    void ClippedGeometryCache::Remove(const void* const overlayManager, const uint32_t overlayId) noexcept
+    {
+        const auto it = entries_.find(Key{overlayManager, overlayId});
+        if (it != entries_.end()) {
+            EraseEntry_(it);
+        }
+    }
+
+    void ClippedGeometryCache::Clear() noexcept
+    {
+        entries_.clear();
+        lru_.clear();
+        bytesUsed_ = 0;
+    }
+
+    ClippedGeometryCacheStats ClippedGeometryCache::GetStats() const noexcept
+    {
+        return ClippedGeometryCacheStats{
+            .hits = hits_,
+            .misses = misses_,
+            .evictions = evictions_,
+            .entryCount = static_cast<uint32_t>(entries_.size()),
+            .bytesUsed = bytesUsed_,
+            .byteBudget = byteBudget_,
+        };
+    }
+
+    void ClippedGeometryCache::EraseEntry_(const std::unordered_map<Key, Entry, KeyHash>::iterator it) noexcept
+    {
+        bytesUsed_ -= EntryBytes(it->second.geometry);
+        lru_.erase(it->second.lruPosition);
+        entries_.erase(it);
+    }
+
+    void ClippedGeometryCache::EvictToBudget_() noexcept
+    {
+        while (bytesUsed_ > byteBudget_ && !lru_.empty()) {
+            const auto it = entries_.find(lru_.back());
+            if (it == entries_.end()) {
+                lru_.pop_back();
+                continue;
+            }
+
+            EraseEntry_(it);
+            ++evictions_;
+        }
+    }
+}
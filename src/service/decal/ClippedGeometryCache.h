@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "FootprintUvKernel.h"
+#include "TerrainDecalGeometry.h"
+
+namespace TerrainDecal
+{
+    // Everything the clipped triangles of one overlay depend on. The grid vertices are represented by the
+    // highest TerrainRevisionTracker block revision under the draw rect and by a hash of the heights
+    // under the rect itself (TerrainRevisionTracker::HashCells).
+    struct ClippedGeometrySignature
+    {
+        std::array<float, 16> slotMatrix{};
+        int xStart = 0;
+        int zStart = 0;
+        int xEnd = 0;
+        int zEnd = 0;
+        bool clipU = false;
+        bool clipV = false;
+        ClipBounds clipBounds{};
+        uint64_t terrainRevision = 0;
+        uint64_t terrainHash = 0;
+    };
+
+    struct ClippedGeometryCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint32_t entryCount = 0;
+        size_t bytesUsed = 0;
+        size_t byteBudget = 0;
+    };
+
+    // LRU cache of emitted decal geometry per (overlay manager, normalized overlay id), bounded by a
+    // byte budget. Hits and LRU promotion do not allocate.
+    class ClippedGeometryCache final
+    {
+    public:
+        void SetByteBudget(size_t byteBudget);
+        [[nodiscard]] size_t GetByteBudget() const noexcept;
+        [[nodiscard]] bool IsEnabled() const noexcept;
+
+        [[nodiscard]] const ClippedGeometry* Find(const void* overlayManager,
+                                                  uint32_t overlayId,
+                                                  const ClippedGeometrySignature& signature) noexcept;
+        void Store(const void* overlayManager,
+                   uint32_t overlayId,
+                   const ClippedGeometrySignature& signature,
+                   const ClippedGeometry& geometry);
+        void Remove(const void* overlayManager, uint32_t overlayId) noexcept;
+        void Clear() noexcept;
+
+        [[nodiscard]] ClippedGeometryCacheStats GetStats() const noexcept;
+
+    private:
+        struct Key
+        {
+            const void* overlayManager = nullptr;
+            uint32_t overlayId = 0;
+
+            bool operator==(const Key& other) const noexcept = default;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const noexcept;
+        };
+
+        struct Entry
+        {
+            uint64_t signatureHash = 0;
+            ClippedGeometrySignature signature{};
+            ClippedGeometry geometry{};
+            std::list<Key>::iterator lruPosition{};
+        };
+
+        void EraseEntry_(std::unordered_map<Key, Entry, KeyHash>::iterator it) noexcept;
+        void EvictToBudget_() noexcept;
+
+    private:
+        std::unordered_map<Key, Entry, KeyHash> entries_{};
+        // Most recently used at the front.
+        std::list<Key> lru_{};
+        size_t byteBudget_ = 0;
+        size_t bytesUsed_ = 0;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t evictions_ = 0;
+    };
+
+    [[nodiscard]] uint64_t HashClippedGeometrySignature(const ClippedGeometrySignature& signature) noexcept;
+}
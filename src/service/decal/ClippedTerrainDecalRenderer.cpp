@@ -3,15 +3,19 @@
 #include <algorithm>
 #include <array>
 #include <bit>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <limits>
-#include <mutex>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "cISTETerrain.h"
+#include "FallThroughDiagnostics.h"
+#include "FootprintUvKernel.h"
+#include "TerrainGridView.h"
+#include "TerrainRevisionTracker.h"
 #include "utils/Logger.h"
 
 namespace
@@ -19,7 +23,6 @@ namespace
     // SC4 uses primType 0 for caller-supplied explicit triangles.
     constexpr uint32_t kPrimTypeTriangleList = 0;
     constexpr uint32_t kTerrainVertexFormat = 0x0B;
-    constexpr float kClipEpsilon = 1.0e-5f;
     using SetTexTransform4Fn = void(__thiscall*)(SC4DrawContext*, const float*, int);
 
     struct TerrainDrawRect
@@ -30,35 +33,47 @@ namespace
         int zEnd;
     };
 
-    struct TerrainGridDimensions
+    using TerrainDecal::CaptureTerrainGridView;
+    using TerrainDecal::CellInfoEntry;
+    using TerrainDecal::ClipBounds;
+    using TerrainDecal::ClippedGeometry;
+    using TerrainDecal::ClipVertex;
+    using TerrainDecal::EvaluateFootprintUv;
+    using TerrainDecal::ExpandToTriangleList;
+    using TerrainDecal::FallThroughDiagnostics;
+    using TerrainDecal::GetCellInfoRow;
+    using TerrainDecal::IsClipVertexInside;
+    using TerrainDecal::IsLeveledTerrainCell;
+    using TerrainDecal::kClipEpsilon;
+    using TerrainDecal::kMaxIndexedVertices;
+    using TerrainDecal::PackedTerrainVertex;
+    using TerrainDecal::TerrainGridDimensions;
+    using TerrainDecal::TerrainGridView;
+
+    // A terrain quad clipped by at most four axis-aligned UV planes gains at most one
+    // vertex per plane, so 8 slots are always enough.
+    constexpr size_t kMaxClipPolygonVertices = 8;
+
+    struct ClipPolygon
     {
-        int cellCountX = 0;
-        int cellCountZ = 0;
-        int vertexCountX = 0;
-        int vertexCountZ = 0;
-        int vertexCount = 0;
-    };
-
-    struct PackedTerrainVertex
-    {
-        float x;
-        float y;
-        float z;
-        uint32_t diffuse;
-        float u;
-        float v;
-        float extra0;
-        float extra1;
-    };
-
-    static_assert(sizeof(PackedTerrainVertex) == 0x20,
-                  "PackedTerrainVertex must match the game's 32-byte terrain vertex layout.");
-
-    struct ClipVertex
-    {
-        PackedTerrainVertex vertex{};
-        float clipU = 0.0f;
-        float clipV = 0.0f;
+        std::array<ClipVertex, kMaxClipPolygonVertices> vertices{};
+        size_t count = 0;
+
+        [[nodiscard]] bool empty() const noexcept { return count == 0; }
+        [[nodiscard]] size_t size() const noexcept { return count; }
+        [[nodiscard]] const ClipVertex& operator[](const size_t index) const noexcept { return vertices[index]; }
+        [[nodiscard]] const ClipVertex& back() const noexcept { return vertices[count - 1]; }
+        [[nodiscard]] const ClipVertex* begin() const noexcept { return vertices.data(); }
+        [[nodiscard]] const ClipVertex* end() const noexcept { return vertices.data() + count; }
+
+        void clear() noexcept { count = 0; }
+
+        void push_back(const ClipVertex& vertex) noexcept
+        {
+            if (count < vertices.size()) {
+                vertices[count++] = vertex;
+            }
+        }
     };
 
     struct OverlaySlotView
@@ -75,14 +90,6 @@ namespace
         bool active = false;
     };
 
-    struct ClipBounds
-    {
-        float minU = 0.0f;
-        float maxU = 1.0f;
-        float minV = 0.0f;
-        float maxV = 1.0f;
-    };
-
     struct ClipDebugSample
     {
         bool captured = false;
@@ -98,18 +105,6 @@ namespace
         bool activeAllInside = false;
     };
 
-    [[nodiscard]] bool ShouldLogOverlayOnce(const uint32_t overlayId, const char* const category) noexcept
-    {
-        static std::mutex mutex;
-        static std::unordered_set<uint64_t> seenKeys;
-
-        const uint64_t key =
-            (static_cast<uint64_t>(std::hash<std::string_view>{}(category)) << 32u) | overlayId;
-
-        std::lock_guard lock(mutex);
-        return seenKeys.insert(key).second;
-    }
-
     void LogClipDebugSample(const uint32_t overlayId,
                             const ClipDebugSample& sample,
                             const ClipBounds& bounds,
@@ -265,20 +260,10 @@ namespace
         return overlayId & 0x7FFFFFFFu;
     }
 
-    struct CellInfoEntry
-    {
-        int vertexIndex;
-        uint32_t flatYBits;
-    };
-
-    struct RowTableEntry
-    {
-        const std::byte* data;
-        uint32_t unknown1;
-        uint32_t unknown2;
-    };
-
     using DrawPrimsFn = void(__thiscall*)(SC4DrawContext*, uint32_t, uint32_t, uint32_t, const void*);
+    // primType, vertexFormat, vertexCount, vertices, indexCount, 16-bit indices.
+    using DrawPrimsIndexedRawFn =
+        void(__thiscall*)(SC4DrawContext*, uint32_t, uint32_t, uint32_t, const void*, uint32_t, const uint16_t*);
     using SetDepthOffsetFn = void(__thiscall*)(SC4DrawContext*, int);
     // SC4DrawContext::SetTransparency is a tail-call shim to the renderer; the float
     // opacity stays on the stack just like the original DrawDecals call sequence.
@@ -288,6 +273,8 @@ namespace
     // Set decals to 4+ to ensure they win the depth test against shadow pixels.
     constexpr int kVanillaDecalDepthOffset = 2;
     constexpr std::ptrdiff_t kOverlaySlotOpacityOffset = 0x9C;
+    // Overlay ids past this are not recorded for shadow recovery, bounding the per-slot lookup table.
+    constexpr uint32_t kMaxDrawListOverlays = 1u << 16;
 
     [[nodiscard]] OverlaySlotView ReadOverlaySlotView(const std::byte* slotBase)
     {
@@ -505,30 +492,6 @@ namespace
         return out;
     }
 
-    void EvaluateFootprintUv(const float* matrix, ClipVertex& vertex) noexcept
-    {
-        if (!matrix) {
-            return;
-        }
-
-        const float sourceX = vertex.vertex.x;
-        const float sourceY = vertex.vertex.y;
-        const float sourceZ = vertex.vertex.z;
-
-        const float u = sourceX * matrix[0] + sourceY * matrix[4] + sourceZ * matrix[8] + matrix[12];
-        const float v = sourceX * matrix[1] + sourceY * matrix[5] + sourceZ * matrix[9] + matrix[13];
-        const float w = sourceX * matrix[3] + sourceY * matrix[7] + sourceZ * matrix[11] + matrix[15];
-
-        if (std::fabs(w) > kClipEpsilon && std::fabs(w - 1.0f) > kClipEpsilon) {
-            vertex.clipU = u / w;
-            vertex.clipV = v / w;
-        }
-        else {
-            vertex.clipU = u;
-            vertex.clipV = v;
-        }
-    }
-
     [[nodiscard]] ClipVertex LerpClipVertex(const ClipVertex& a,
                                             const ClipVertex& b,
                                             const float t) noexcept
@@ -577,70 +540,170 @@ namespace
         return LerpClipVertex(a, b, std::clamp(t, 0.0f, 1.0f));
     }
 
-    void ClipPolygonAgainstPlane(std::vector<ClipVertex>& polygon,
+    void ClipPolygonAgainstPlane(const ClipPolygon& input,
+                                 ClipPolygon& output,
                                  const bool useU,
                                  const bool isMinPlane,
-                                 const float limit)
+                                 const float limit) noexcept
     {
-        if (polygon.empty()) {
+        output.clear();
+        if (input.empty()) {
             return;
         }
 
-        std::vector<ClipVertex> output;
-        output.reserve(polygon.size() + 2);
-
-        ClipVertex previous = polygon.back();
-        bool previousInside = IsInsidePlane(previous, useU, isMinPlane, limit);
+        const ClipVertex* previous = &input.back();
+        bool previousInside = IsInsidePlane(*previous, useU, isMinPlane, limit);
 
-        for (const auto& current : polygon) {
+        for (const auto& current : input) {
             const bool currentInside = IsInsidePlane(current, useU, isMinPlane, limit);
 
             if (currentInside != previousInside) {
-                output.push_back(IntersectPlane(previous, current, useU, limit));
+                output.push_back(IntersectPlane(*previous, current, useU, limit));
             }
 
             if (currentInside) {
                 output.push_back(current);
             }
 
-            previous = current;
+            previous = &current;
             previousInside = currentInside;
         }
+    }
+
+    constexpr uint32_t kNoEmittedIndex = 0xFFFFFFFFu;
 
-        polygon = std::move(output);
+    // Indexed output degrades to a plain triangle list once another additionalVertices would no longer
+    // fit 16-bit indices. Only very large decals get here.
+    void EnsureIndexCapacity(ClippedGeometry& output, const size_t additionalVertices)
+    {
+        if (!output.indexed || output.vertices.size() + additionalVertices <= kMaxIndexedVertices) {
+            return;
+        }
+
+        std::vector<PackedTerrainVertex> expanded;
+        ExpandToTriangleList(output, expanded);
+        output.vertices.swap(expanded);
+        output.indices.clear();
+        output.indexed = false;
+    }
+
+    [[nodiscard]] uint16_t EmitIndexedVertex(ClippedGeometry& output, const PackedTerrainVertex& vertex)
+    {
+        output.vertices.push_back(vertex);
+        return static_cast<uint16_t>(output.vertices.size() - 1);
+    }
+
+    void EmitQuadIndices(ClippedGeometry& output, const std::array<uint16_t, 4>& corners)
+    {
+        output.indices.push_back(corners[0]);
+        output.indices.push_back(corners[1]);
+        output.indices.push_back(corners[2]);
+        output.indices.push_back(corners[0]);
+        output.indices.push_back(corners[2]);
+        output.indices.push_back(corners[3]);
     }
 
-    void EmitTriangleFan(const std::vector<ClipVertex>& polygon,
-                         std::vector<PackedTerrainVertex>& output)
+    void EmitQuad(const std::array<ClipVertex, 4>& quad, ClippedGeometry& output)
+    {
+        EnsureIndexCapacity(output, quad.size());
+        if (!output.indexed) {
+            output.vertices.push_back(quad[0].vertex);
+            output.vertices.push_back(quad[1].vertex);
+            output.vertices.push_back(quad[2].vertex);
+            output.vertices.push_back(quad[0].vertex);
+            output.vertices.push_back(quad[2].vertex);
+            output.vertices.push_back(quad[3].vertex);
+            return;
+        }
+
+        std::array<uint16_t, 4> corners{};
+        for (size_t i = 0; i < quad.size(); ++i) {
+            corners[i] = EmitIndexedVertex(output, quad[i].vertex);
+        }
+        EmitQuadIndices(output, corners);
+    }
+
+    // Like EmitQuad, but corners are grid vertices shared with neighbouring cells. cornerSlots remember
+    // the index each grid vertex was emitted under so it is written once per draw.
+    void EmitGridQuad(const std::array<ClipVertex, 4>& quad,
+                      const std::array<uint32_t*, 4>& cornerSlots,
+                      ClippedGeometry& output)
+    {
+        EnsureIndexCapacity(output, quad.size());
+        if (!output.indexed) {
+            EmitQuad(quad, output);
+            return;
+        }
+
+        std::array<uint16_t, 4> corners{};
+        for (size_t i = 0; i < quad.size(); ++i) {
+            if (*cornerSlots[i] == kNoEmittedIndex) {
+                *cornerSlots[i] = EmitIndexedVertex(output, quad[i].vertex);
+            }
+            corners[i] = static_cast<uint16_t>(*cornerSlots[i]);
+        }
+        EmitQuadIndices(output, corners);
+    }
+
+    void EmitTriangleFan(const ClipPolygon& polygon,
+                         ClippedGeometry& output)
     {
         if (polygon.size() < 3) {
             return;
         }
 
+        EnsureIndexCapacity(output, polygon.size());
+        if (output.indexed) {
+            const auto base = static_cast<uint16_t>(output.vertices.size());
+            for (const auto& vertex : polygon) {
+                output.vertices.push_back(vertex.vertex);
+            }
+
+            for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+                output.indices.push_back(base);
+                output.indices.push_back(static_cast<uint16_t>(base + i));
+                output.indices.push_back(static_cast<uint16_t>(base + i + 1));
+            }
+            return;
+        }
+
         for (size_t i = 1; i + 1 < polygon.size(); ++i) {
-            output.push_back(polygon[0].vertex);
-            output.push_back(polygon[i].vertex);
-            output.push_back(polygon[i + 1].vertex);
+            output.vertices.push_back(polygon[0].vertex);
+            output.vertices.push_back(polygon[i].vertex);
+            output.vertices.push_back(polygon[i + 1].vertex);
         }
     }
 
-    void ClipAndEmitPolygon(std::vector<ClipVertex> polygon,
-                             const bool clipU,
-                             const bool clipV,
-                             const ClipBounds& bounds,
-                             std::vector<PackedTerrainVertex>& output)
+    void ClipAndEmitPolygon(const std::array<ClipVertex, 4>& quad,
+                            const bool clipU,
+                            const bool clipV,
+                            const ClipBounds& bounds,
+                            ClippedGeometry& output)
     {
+        // Ping-pong between two stack buffers; each plane reads one and writes the other.
+        std::array<ClipPolygon, 2> buffers{};
+        ClipPolygon* front = &buffers[0];
+        ClipPolygon* back = &buffers[1];
+        for (const auto& vertex : quad) {
+            front->push_back(vertex);
+        }
+
+        const auto clipAgainst = [&](const bool useU, const bool isMinPlane, const float limit) {
+            ClipPolygonAgainstPlane(*front, *back, useU, isMinPlane, limit);
+            std::swap(front, back);
+        };
+
         if (clipU) {
-            ClipPolygonAgainstPlane(polygon, true, true, bounds.minU);
-            ClipPolygonAgainstPlane(polygon, true, false, bounds.maxU);
+            clipAgainst(true, true, bounds.minU);
+            clipAgainst(true, false, bounds.maxU);
         }
 
         if (clipV) {
-            ClipPolygonAgainstPlane(polygon, false, true, bounds.minV);
-            ClipPolygonAgainstPlane(polygon, false, false, bounds.maxV);
+            clipAgainst(false, true, bounds.minV);
+            clipAgainst(false, false, bounds.maxV);
         }
 
-        EmitTriangleFan(polygon, output);
+        EmitTriangleFan(*front, output);
     }
 
     [[nodiscard]] bool AllVerticesInside(const std::array<ClipVertex, 4>& vertices,
@@ -649,15 +712,7 @@ namespace
                                          const ClipBounds& bounds) noexcept
     {
         return std::all_of(vertices.begin(), vertices.end(), [clipU, clipV, bounds](const ClipVertex& vertex) {
-            if (!HasFiniteClipUv(vertex)) {
-                return false;
-            }
-
-            const bool insideU = !clipU || (vertex.clipU >= bounds.minU - kClipEpsilon &&
-                                            vertex.clipU <= bounds.maxU + kClipEpsilon);
-            const bool insideV = !clipV || (vertex.clipV >= bounds.minV - kClipEpsilon &&
-                                            vertex.clipV <= bounds.maxV + kClipEpsilon);
-            return insideU && insideV;
+            return IsClipVertexInside(vertex, clipU, clipV, bounds);
         });
     }
 
@@ -667,31 +722,15 @@ namespace
                                        const ClipBounds& bounds) noexcept
     {
         return std::any_of(vertices.begin(), vertices.end(), [clipU, clipV, bounds](const ClipVertex& vertex) {
-            if (!HasFiniteClipUv(vertex)) {
-                return false;
-            }
-
-            const bool insideU = !clipU || (vertex.clipU >= bounds.minU - kClipEpsilon &&
-                                            vertex.clipU <= bounds.maxU + kClipEpsilon);
-            const bool insideV = !clipV || (vertex.clipV >= bounds.minV - kClipEpsilon &&
-                                            vertex.clipV <= bounds.maxV + kClipEpsilon);
-            return insideU && insideV;
+            return IsClipVertexInside(vertex, clipU, clipV, bounds);
         });
     }
 
-    [[nodiscard]] bool QuadMayIntersectClipBox(const std::array<ClipVertex, 4>& vertices,
-                                               const bool clipU,
-                                               const bool clipV,
-                                               const ClipBounds& bounds) noexcept
+    [[nodiscard]] bool QuadBoundsOverlapClipBox(const std::array<ClipVertex, 4>& vertices,
+                                                const bool clipU,
+                                                const bool clipV,
+                                                const ClipBounds& bounds) noexcept
     {
-        if (!AllVerticesHaveFiniteClipUv(vertices)) {
-            return false;
-        }
-
-        if (AnyVertexInside(vertices, clipU, clipV, bounds)) {
-            return true;
-        }
-
         float minU = vertices[0].clipU;
         float maxU = vertices[0].clipU;
         float minV = vertices[0].clipV;
@@ -709,80 +748,99 @@ namespace
         return overlapsU && overlapsV;
     }
 
-    [[nodiscard]] const RowTableEntry* ReadRowTable(const uintptr_t globalAddress) noexcept
+    [[nodiscard]] bool QuadMayIntersectClipBox(const std::array<ClipVertex, 4>& vertices,
+                                               const bool clipU,
+                                               const bool clipV,
+                                               const ClipBounds& bounds) noexcept
     {
-        if (globalAddress == 0) {
-            return nullptr;
+        if (!AllVerticesHaveFiniteClipUv(vertices)) {
+            return false;
         }
 
-        return *reinterpret_cast<const RowTableEntry* const*>(globalAddress);
-    }
-
-    [[nodiscard]] const PackedTerrainVertex* GetTerrainVertexArray(const uintptr_t globalAddress) noexcept
-    {
-        if (globalAddress == 0) {
-            return nullptr;
+        if (AnyVertexInside(vertices, clipU, clipV, bounds)) {
+            return true;
         }
 
-        return *reinterpret_cast<const PackedTerrainVertex* const*>(globalAddress);
+        return QuadBoundsOverlapClipBox(vertices, clipU, clipV, bounds);
     }
 
-    [[nodiscard]] const CellInfoEntry* GetCellInfoRow(const RowTableEntry* rows, const int row) noexcept
+    [[nodiscard]] TerrainDrawRect ClampTerrainDrawRect(const TerrainDrawRect& rect,
+                                                       const TerrainGridDimensions& dimensions) noexcept
     {
-        if (!rows || row < 0) {
-            return nullptr;
-        }
-
-        return reinterpret_cast<const CellInfoEntry*>(rows[row].data);
+        TerrainDrawRect result{};
+        result.xStart = std::clamp(rect.xStart, 0, std::max(0, dimensions.cellCountX));
+        result.zStart = std::clamp(rect.zStart, 0, std::max(0, dimensions.cellCountZ));
+        result.xEnd = std::clamp(rect.xEnd, result.xStart, std::max(0, dimensions.cellCountX));
+        result.zEnd = std::clamp(rect.zEnd, result.zStart, std::max(0, dimensions.cellCountZ));
+        return result;
     }
 
-    [[nodiscard]] const uint16_t* ReadAllLevelCellIndices(const uintptr_t globalAddress) noexcept
-    {
-        if (globalAddress == 0) {
-            return nullptr;
-        }
-
-        return reinterpret_cast<const uint16_t*>(*reinterpret_cast<const void* const*>(globalAddress));
-    }
+    constexpr float kTerrainCellSize = 16.0f;
 
-    [[nodiscard]] TerrainGridDimensions ReadTerrainGridDimensions(const TerrainDecal::HookAddresses& addresses) noexcept
+    // Maps the clip box corners back to world XZ through the inverted slot matrix and returns the cells
+    // whose footprint UV can reach the box, padded by one cell. Only affine matrices whose UV ignores
+    // height qualify; anything else returns false and the caller keeps the full overlay rect.
+    [[nodiscard]] bool TryProjectClipBoxToCells(const float* const matrix,
+                                                const ClipBounds& bounds,
+                                                TerrainDrawRect& cells) noexcept
     {
-        TerrainGridDimensions result{};
-        if (addresses.terrainCellCountXPtr != 0) {
-            result.cellCountX = *reinterpret_cast<const int*>(addresses.terrainCellCountXPtr);
-        }
-
-        if (addresses.terrainCellCountZPtr != 0) {
-            result.cellCountZ = *reinterpret_cast<const int*>(addresses.terrainCellCountZPtr);
-        }
-
-        if (addresses.terrainVertexCountXPtr != 0) {
-            result.vertexCountX = *reinterpret_cast<const int*>(addresses.terrainVertexCountXPtr);
+        if (!matrix ||
+            matrix[3] != 0.0f || matrix[7] != 0.0f || matrix[11] != 0.0f ||
+            std::fabs(matrix[15] - 1.0f) > kClipEpsilon ||
+            matrix[4] != 0.0f || matrix[5] != 0.0f) {
+            return false;
         }
 
-        if (addresses.terrainVertexCountZPtr != 0) {
-            result.vertexCountZ = *reinterpret_cast<const int*>(addresses.terrainVertexCountZPtr);
+        const double a = matrix[0];
+        const double b = matrix[8];
+        const double c = matrix[1];
+        const double d = matrix[9];
+        const double determinant = a * d - b * c;
+        if (!std::isfinite(determinant) || std::fabs(determinant) < 1.0e-12) {
+            return false;
         }
 
-        if (addresses.terrainVertexCountPtr != 0) {
-            result.vertexCount = *reinterpret_cast<const int*>(addresses.terrainVertexCountPtr);
+        const std::array<double, 2> uLimits{bounds.minU - kClipEpsilon, bounds.maxU + kClipEpsilon};
+        const std::array<double, 2> vLimits{bounds.minV - kClipEpsilon, bounds.maxV + kClipEpsilon};
+        double minX = std::numeric_limits<double>::infinity();
+        double maxX = -std::numeric_limits<double>::infinity();
+        double minZ = std::numeric_limits<double>::infinity();
+        double maxZ = -std::numeric_limits<double>::infinity();
+        for (const double u : uLimits) {
+            for (const double v : vLimits) {
+                const double du = u - matrix[12];
+                const double dv = v - matrix[13];
+                const double x = (d * du - b * dv) / determinant;
+                const double z = (a * dv - c * du) / determinant;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minZ = std::min(minZ, z);
+                maxZ = std::max(maxZ, z);
+            }
         }
 
-        if (result.vertexCountZ <= 0 && result.vertexCountX > 0 && result.vertexCount > 0) {
-            result.vertexCountZ = result.vertexCount / result.vertexCountX;
+        if (!std::isfinite(minX) || !std::isfinite(maxX) || !std::isfinite(minZ) || !std::isfinite(maxZ)) {
+            return false;
         }
 
-        return result;
+        static constexpr double kCellLimit = static_cast<double>(std::numeric_limits<int>::max() / 2);
+        const auto toCell = [](const double world, const double offset) {
+            return static_cast<int>(std::clamp(std::floor(world / kTerrainCellSize) + offset, -kCellLimit, kCellLimit));
+        };
+        cells.xStart = toCell(minX, -1.0);
+        cells.zStart = toCell(minZ, -1.0);
+        cells.xEnd = toCell(maxX, 2.0);
+        cells.zEnd = toCell(maxZ, 2.0);
+        return true;
     }
 
-    [[nodiscard]] TerrainDrawRect ClampTerrainDrawRect(const TerrainDrawRect& rect,
-                                                       const TerrainGridDimensions& dimensions) noexcept
+    [[nodiscard]] TerrainDrawRect IntersectTerrainDrawRects(const TerrainDrawRect& a, const TerrainDrawRect& b) noexcept
     {
         TerrainDrawRect result{};
-        result.xStart = std::clamp(rect.xStart, 0, std::max(0, dimensions.cellCountX));
-        result.zStart = std::clamp(rect.zStart, 0, std::max(0, dimensions.cellCountZ));
-        result.xEnd = std::clamp(rect.xEnd, result.xStart, std::max(0, dimensions.cellCountX));
-        result.zEnd = std::clamp(rect.zEnd, result.zStart, std::max(0, dimensions.cellCountZ));
+        result.xStart = std::max(a.xStart, b.xStart);
+        result.zStart = std::max(a.zStart, b.zStart);
+        result.xEnd = std::max(result.xStart, std::min(a.xEnd, b.xEnd));
+        result.zEnd = std::max(result.zStart, std::min(a.zEnd, b.zEnd));
         return result;
     }
 
@@ -798,31 +856,19 @@ namespace
         return result;
     }
 
-    [[nodiscard]] bool LoadTerrainCellVertices(const TerrainDecal::HookAddresses& addresses,
+    // grid must be valid.
+    [[nodiscard]] bool LoadTerrainCellVertices(const TerrainGridView& grid,
                                                const int cellX,
                                                const int cellZ,
-                                               std::array<PackedTerrainVertex, 4>& result)
+                                               std::array<PackedTerrainVertex, 4>& result) noexcept
     {
-        const TerrainGridDimensions dimensions = ReadTerrainGridDimensions(addresses);
-        if (dimensions.cellCountX <= 0 || dimensions.cellCountZ <= 0 ||
-            dimensions.vertexCountX <= 0 || dimensions.vertexCountZ <= 0 || dimensions.vertexCount <= 0) {
-            return false;
-        }
-
+        const TerrainGridDimensions& dimensions = grid.dimensions;
         if (cellX >= dimensions.cellCountX || cellZ >= dimensions.cellCountZ) {
             return false;
         }
 
-        const auto* const vertices = GetTerrainVertexArray(addresses.terrainGridVerticesPtr);
-        const auto* const rows = ReadRowTable(addresses.terrainCellInfoRowsPtr);
-        const auto* const allLevelCellIndices = ReadAllLevelCellIndices(addresses.allLevelCellIndicesPtr);
-        if (!vertices) {
-            return false;
-        }
-        if (!rows || !allLevelCellIndices) {
-            return false;
-        }
-
+        const PackedTerrainVertex* const vertices = grid.vertices;
+        const uint16_t* const allLevelCellIndices = grid.allLevelCellIndices;
         const int vertexCountX = dimensions.vertexCountX;
         const int levelIndexStride = dimensions.cellCountX + 1;
         const int levelIndexBase = levelIndexStride * cellZ;
@@ -832,7 +878,7 @@ namespace
         int rowRelativeIndex = cellX;
         const CellInfoEntry* levelEntry = nullptr;
         if (levelEntryStart < levelEntryEnd) {
-            const auto* const row = GetCellInfoRow(rows, cellZ);
+            const auto* const row = GetCellInfoRow(grid.rows, cellZ);
             if (!row) {
                 return false;
             }
@@ -866,6 +912,194 @@ namespace
 
         return true;
     }
+
+    void EvaluateGridRow(const TerrainGridView& grid,
+                         const float* const matrix,
+                         const bool clipU,
+                         const bool clipV,
+                         const ClipBounds& bounds,
+                         const int gridZ,
+                         const int xStart,
+                         const int xEnd,
+                         ClipVertex* const row,
+                         uint8_t* const insideFlags) noexcept
+    {
+        const int rowBase = gridZ * grid.dimensions.vertexCountX;
+        for (int gridX = xStart; gridX <= xEnd; ++gridX) {
+            const int index = rowBase + gridX;
+            // Cells touching an out-of-range vertex fail the same bounds check and are skipped.
+            row[gridX - xStart].vertex = index < grid.dimensions.vertexCount ? grid.vertices[index] : PackedTerrainVertex{};
+        }
+
+        TerrainDecal::EvaluateFootprintUvBatch(matrix,
+                                               clipU,
+                                               clipV,
+                                               bounds,
+                                               row,
+                                               insideFlags,
+                                               static_cast<size_t>(xEnd - xStart) + 1);
+    }
+
+    struct CellSweepInput
+    {
+        const TerrainGridView* grid = nullptr;
+        TerrainDrawRect drawRect{};
+        const float* matrix = nullptr;
+        const float* activeTexTransform = nullptr;
+        bool clipU = false;
+        bool clipV = false;
+        ClipBounds bounds{};
+        uint32_t overlayId = 0;
+        FallThroughDiagnostics* diagnostics = nullptr;
+    };
+
+    // Clips every terrain cell of the draw rect against the footprint UV box and appends the surviving
+    // triangles to output. Returns whether any terrain cell could be loaded at all.
+    bool SweepTerrainCells(const CellSweepInput& input,
+                           std::vector<ClipVertex>& rowCache,
+                           std::vector<uint8_t>& rowInsideFlags,
+                           std::vector<uint32_t>& rowEmittedIndices,
+                           ClippedGeometry& output,
+                           ClipDebugSample& clipDebugSample,
+                           TerrainDecal::LastDrawStats& stats)
+    {
+        const TerrainGridView& grid = *input.grid;
+        bool loadedAnyTerrainCells = false;
+        uint32_t cellsCulled = 0;
+        uint32_t cellsFullyInside = 0;
+        uint32_t cellsClipped = 0;
+
+        if (grid.valid) {
+            // Row sweep: every grid vertex of the rect is fetched and transformed exactly once into a
+            // rolling two-row cache, and unleveled cells are assembled from it. Leveled cells carry their
+            // own vertex index and flattened height, so they still take the per-cell load.
+            const size_t rowWidth = static_cast<size_t>(input.drawRect.xEnd - input.drawRect.xStart) + 1;
+            rowCache.resize(rowWidth * 2);
+            rowInsideFlags.resize(rowWidth * 2);
+            ClipVertex* upperRow = rowCache.data();
+            ClipVertex* lowerRow = upperRow + rowWidth;
+            uint8_t* upperInside = rowInsideFlags.data();
+            uint8_t* lowerInside = upperInside + rowWidth;
+            rowEmittedIndices.assign(rowWidth * 2, kNoEmittedIndex);
+            uint32_t* upperEmitted = rowEmittedIndices.data();
+            uint32_t* lowerEmitted = upperEmitted + rowWidth;
+            EvaluateGridRow(grid, input.matrix, input.clipU, input.clipV, input.bounds,
+                            input.drawRect.zStart, input.drawRect.xStart, input.drawRect.xEnd, upperRow, upperInside);
+
+            for (int cellZ = input.drawRect.zStart; cellZ < input.drawRect.zEnd; ++cellZ) {
+                EvaluateGridRow(grid, input.matrix, input.clipU, input.clipV, input.bounds,
+                                cellZ + 1, input.drawRect.xStart, input.drawRect.xEnd, lowerRow, lowerInside);
+                std::fill_n(lowerEmitted, rowWidth, kNoEmittedIndex);
+
+                for (int cellX = input.drawRect.xStart; cellX < input.drawRect.xEnd; ++cellX) {
+                    std::array<ClipVertex, 4> vertices{};
+                    std::array<uint8_t, 4> insideFlags{};
+                    // Only unleveled cells share their corners with the grid rows.
+                    std::array<uint32_t*, 4> emittedSlots{};
+                    bool sharesGridCorners = false;
+                    if (IsLeveledTerrainCell(grid, cellX, cellZ)) {
+                        std::array<PackedTerrainVertex, 4> sourceVertices{};
+                        if (!LoadTerrainCellVertices(grid, cellX, cellZ, sourceVertices)) {
+                            continue;
+                        }
+
+                        for (size_t i = 0; i < sourceVertices.size(); ++i) {
+                            vertices[i].vertex = sourceVertices[i];
+                        }
+                        TerrainDecal::EvaluateFootprintUvBatchScalar(input.matrix,
+                                                                     input.clipU,
+                                                                     input.clipV,
+                                                                     input.bounds,
+                                                                     vertices.data(),
+                                                                     insideFlags.data(),
+                                                                     vertices.size());
+                    }
+                    else {
+                        const int baseIndex = cellZ * grid.dimensions.vertexCountX + cellX;
+                        if (baseIndex + grid.dimensions.vertexCountX + 1 >= grid.dimensions.vertexCount) {
+                            continue;
+                        }
+
+                        const size_t column = static_cast<size_t>(cellX - input.drawRect.xStart);
+                        vertices = {upperRow[column], lowerRow[column], lowerRow[column + 1], upperRow[column + 1]};
+                        insideFlags = {upperInside[column], lowerInside[column], lowerInside[column + 1], upperInside[column + 1]};
+                        emittedSlots = {&upperEmitted[column], &lowerEmitted[column], &lowerEmitted[column + 1], &upperEmitted[column + 1]};
+                        sharesGridCorners = true;
+                    }
+
+                    loadedAnyTerrainCells = true;
+
+                    if (!clipDebugSample.captured) {
+                        clipDebugSample.captured = true;
+                        clipDebugSample.cellX = cellX;
+                        clipDebugSample.cellZ = cellZ;
+                        for (size_t i = 0; i < vertices.size(); ++i) {
+                            clipDebugSample.sourceVertices[i] = vertices[i].vertex;
+                        }
+                        clipDebugSample.slotVertices = vertices;
+                        clipDebugSample.slotMayIntersect =
+                            QuadMayIntersectClipBox(clipDebugSample.slotVertices, input.clipU, input.clipV, input.bounds);
+                        clipDebugSample.slotAllInside =
+                            AllVerticesInside(clipDebugSample.slotVertices, input.clipU, input.clipV, input.bounds);
+
+                        if (input.activeTexTransform) {
+                            clipDebugSample.activeTransformUsed = true;
+                            clipDebugSample.activeVertices = vertices;
+                            for (auto& vertex : clipDebugSample.activeVertices) {
+                                EvaluateFootprintUv(input.activeTexTransform, vertex);
+                            }
+                            clipDebugSample.activeMayIntersect =
+                                QuadMayIntersectClipBox(clipDebugSample.activeVertices, input.clipU, input.clipV, input.bounds);
+                            clipDebugSample.activeAllInside =
+                                AllVerticesInside(clipDebugSample.activeVertices, input.clipU, input.clipV, input.bounds);
+                        }
+                    }
+
+                    if (!AllVerticesHaveFiniteClipUv(vertices)) {
+                        if (input.diagnostics->RecordNonFiniteClipCell(input.overlayId)) {
+                            LogClipNanSample(input.overlayId, clipDebugSample, input.matrix);
+                        }
+                        continue;
+                    }
+
+                    const uint32_t insideCount = static_cast<uint32_t>(insideFlags[0]) + insideFlags[1] +
+                                                 insideFlags[2] + insideFlags[3];
+                    if (insideCount == 0 &&
+                        !QuadBoundsOverlapClipBox(vertices, input.clipU, input.clipV, input.bounds)) {
+                        ++cellsCulled;
+                        continue;
+                    }
+
+                    if (insideCount == vertices.size()) {
+                        ++cellsFullyInside;
+                        if (sharesGridCorners) {
+                            EmitGridQuad(vertices, emittedSlots, output);
+                        }
+                        else {
+                            EmitQuad(vertices, output);
+                        }
+                    }
+                    else {
+                        ++cellsClipped;
+                        ClipAndEmitPolygon(vertices,
+                                           input.clipU,
+                                           input.clipV,
+                                           input.bounds,
+                                           output);
+                    }
+                }
+
+                std::swap(upperRow, lowerRow);
+                std::swap(upperInside, lowerInside);
+                std::swap(upperEmitted, lowerEmitted);
+            }
+        }
+
+        stats.cellsCulled = cellsCulled;
+        stats.cellsFullyInside = cellsFullyInside;
+        stats.cellsClipped = cellsClipped;
+        return loadedAnyTerrainCells;
+    }
 }
 
 namespace TerrainDecal
@@ -873,11 +1107,17 @@ namespace TerrainDecal
     ClippedTerrainDecalRenderer::ClippedTerrainDecalRenderer(const RendererOptions options)
         : options_(options)
     {
+        geometryCache_.SetByteBudget(options_.geometryCacheBudgetBytes);
     }
 
     void ClippedTerrainDecalRenderer::SetOptions(const RendererOptions& options) noexcept
     {
+        if (options.enableIndexedSubmission != options_.enableIndexedSubmission) {
+            // Cached geometry was emitted for the other submission mode.
+            geometryCache_.Clear();
+        }
         options_ = options;
+        geometryCache_.SetByteBudget(options_.geometryCacheBudgetBytes);
     }
 
     const RendererOptions& ClippedTerrainDecalRenderer::GetOptions() const noexcept
@@ -939,32 +1179,130 @@ namespace TerrainDecal
         overlayOverridesResolverUserData_ = userData;
     }
 
+    void ClippedTerrainDecalRenderer::SetTerrainRevisionTracker(const TerrainRevisionTracker* const tracker) noexcept
+    {
+        terrainRevisionTracker_ = tracker;
+    }
+
+    void ClippedTerrainDecalRenderer::InvalidateOverlayGeometry(void* const overlayManager, const uint32_t overlayId) noexcept
+    {
+        geometryCache_.Remove(overlayManager, NormalizeOverlayIdKey(overlayId));
+    }
+
+    void ClippedTerrainDecalRenderer::ClearGeometryCache() noexcept
+    {
+        geometryCache_.Clear();
+    }
+
+    ClippedGeometryCacheStats ClippedTerrainDecalRenderer::GetGeometryCacheStats() const noexcept
+    {
+        return geometryCache_.GetStats();
+    }
+
+    const LastDrawStats& ClippedTerrainDecalRenderer::GetLastDrawStats() const noexcept
+    {
+        return lastDrawStats_;
+    }
+
+    TerrainDecalRendererDiagnostics ClippedTerrainDecalRenderer::GetDiagnostics() const noexcept
+    {
+        return diagnostics_.Snapshot();
+    }
+
+    void ClippedTerrainDecalRenderer::PublishFrameStats() noexcept
+    {
+        TerrainDecalRendererFrameStats& completed = frameStats_[frameStatsWriteIndex_];
+        completed.frame = ++frameCount_;
+        completed.drawMs = std::chrono::duration<float, std::milli>(frameDrawTime_).count();
+
+        frameStatsWriteIndex_ ^= 1u;
+        frameStats_[frameStatsWriteIndex_] = {};
+        frameDrawTime_ = {};
+        timeFrameDraws_ = frameStatsPolled_;
+        frameStatsPolled_ = false;
+    }
+
+    void ClippedTerrainDecalRenderer::PublishPendingFrameStats() noexcept
+    {
+        const TerrainDecalRendererFrameStats& current = frameStats_[frameStatsWriteIndex_];
+        if (current.decalsHandled > 0 || current.decalsFallenThrough > 0) {
+            PublishFrameStats();
+        }
+    }
+
+    const TerrainDecalRendererFrameStats& ClippedTerrainDecalRenderer::GetFrameStats() const noexcept
+    {
+        frameStatsPolled_ = true;
+        return frameStats_[frameStatsWriteIndex_ ^ 1u];
+    }
+
     DrawResult ClippedTerrainDecalRenderer::Draw(const DrawRequest& request)
+    {
+        lastDrawStats_ = {};
+        DrawResult result;
+        if (timeFrameDraws_) {
+            const auto start = std::chrono::steady_clock::now();
+            result = DrawOverlay_(request);
+            frameDrawTime_ += std::chrono::steady_clock::now() - start;
+        }
+        else {
+            result = DrawOverlay_(request);
+        }
+
+        TerrainDecalRendererFrameStats& frame = frameStats_[frameStatsWriteIndex_];
+        if (request.mode == DrawMode::ShadowRecovery) {
+            frame.shadowRecoveryReplays += lastDrawStats_.replayed ? 1u : 0u;
+        }
+        else if (result == DrawResult::Handled) {
+            ++frame.decalsHandled;
+        }
+        else {
+            ++frame.decalsFallenThrough;
+        }
+        frame.cellsVisited += lastDrawStats_.cellsVisited;
+        frame.cellsCulled += lastDrawStats_.cellsCulled;
+        frame.cellsFullyInside += lastDrawStats_.cellsFullyInside;
+        frame.cellsClipped += lastDrawStats_.cellsClipped;
+        frame.geometryCacheHits += lastDrawStats_.geometryCacheHit ? 1u : 0u;
+        frame.verticesSubmitted += lastDrawStats_.verticesSubmitted;
+        frame.drawCalls += lastDrawStats_.drawCalls;
+        return result;
+    }
+
+    DrawResult ClippedTerrainDecalRenderer::DrawOverlay_(const DrawRequest& request)
     {
         const bool debugOverridesActive = !overlayUvWindows_.empty();
         const bool shadowRecovery = request.mode == DrawMode::ShadowRecovery;
+        diagnostics_.CountDraw();
 
+        // Before the overlay id is known, failures are reported once under overlay 0.
         if (!options_.enableClippedRendering) {
-            LOG_WARN("TerrainDecalRenderer: falling through to vanilla because clipped rendering is disabled");
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::RendererDisabled, 0)) {
+                LOG_WARN("TerrainDecalRenderer: falling through to vanilla because clipped rendering is disabled");
+            }
             return DrawResult::FallThroughToVanilla;
         }
 
         if (!request.addresses || !request.terrain || !request.overlaySlotBase || !request.drawContext) {
-            LOG_WARN("TerrainDecalRenderer: falling through before draw because request is incomplete "
-                     "(addresses={}, terrain={}, slotBase={}, drawContext={})",
-                     request.addresses != nullptr,
-                     request.terrain != nullptr,
-                     request.overlaySlotBase != nullptr,
-                     request.drawContext != nullptr);
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::IncompleteRequest, 0)) {
+                LOG_WARN("TerrainDecalRenderer: falling through before draw because request is incomplete "
+                         "(addresses={}, terrain={}, slotBase={}, drawContext={})",
+                         request.addresses != nullptr,
+                         request.terrain != nullptr,
+                         request.overlaySlotBase != nullptr,
+                         request.drawContext != nullptr);
+            }
             return DrawResult::FallThroughToVanilla;
         }
 
         const OverlaySlotView slot = ReadOverlaySlotView(request.overlaySlotBase);
         if (slot.state != -1 || !slot.matrix) {
-            LOG_WARN("TerrainDecalRenderer: falling through because slot state/matrix is invalid "
-                     "(state={}, matrix={})",
-                     slot.state,
-                     static_cast<const void*>(slot.matrix));
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::InvalidOverlaySlot, 0)) {
+                LOG_WARN("TerrainDecalRenderer: falling through because slot state/matrix is invalid "
+                         "(state={}, matrix={})",
+                         slot.state,
+                         static_cast<const void*>(slot.matrix));
+            }
             return DrawResult::FallThroughToVanilla;
         }
 
@@ -973,11 +1311,20 @@ namespace TerrainDecal
         uint32_t overlayId = 0;
         const bool hasOverlayId = TryResolveOverlayId(request, overlayId);
         if (!MatrixHasFiniteComponents(slot.matrix)) {
-            if (ShouldLogOverlayOnce(overlayId, "nonfinite-matrix")) {
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::NonFiniteMatrix, overlayId)) {
                 LogNonFiniteMatrixSample(overlayId, slot.matrix);
             }
             return DrawResult::FallThroughToVanilla;
         }
+        if (!shadowRecovery && hasOverlayId && IsDrawRecorded_(request.overlayManager, overlayId)) {
+            // The overlay is drawn again, so a new pass has begun and last pass's list is stale.
+            ResetDrawList();
+        }
+        if (shadowRecovery) {
+            // Only managed decals recorded by the normal pass are redrawn, from their recorded triangles.
+            const float* const replayBaseTexTransform = request.activeTexTransform ? request.activeTexTransform : slot.matrix;
+            return hasOverlayId ? ReplayRecordedDraw_(request, overlayId, replayBaseTexTransform) : DrawResult::Handled;
+        }
         TerrainDecalOverlayOverrides overrides{};
         TerrainDecalUvWindow storedUvWindow{};
         bool hasUvOverride = false;
@@ -997,14 +1344,11 @@ namespace TerrainDecal
                 hasUvOverride = hasUvOverride || overrides.hasUvWindow;
             }
         }
+        // Managed overlays always take the custom path so the shadow recovery pass can replay them.
         const bool isManagedOverlay = hasManagedOverrides || hasUvOverride;
-        if (shadowRecovery && !isManagedOverlay) {
-            return DrawResult::Handled;
-        }
 
         const TerrainDecalUvWindow& uvRect = overrides.uvWindow;
         const bool hasModifiers = HasDecalModifiers(overrides);
-        const bool forceCustomDraw = shadowRecovery && isManagedOverlay;
         const bool clipOnlyUvOverride = hasUvOverride && uvRect.mode == TerrainDecalUvMode::ClipSubrect;
         const bool effectiveClipU = clipU || clipOnlyUvOverride;
         const bool effectiveClipV = clipV || clipOnlyUvOverride;
@@ -1023,9 +1367,11 @@ namespace TerrainDecal
                      effectiveClipU,
                      effectiveClipV);
         }
-        if (!forceCustomDraw && !effectiveClipU && !effectiveClipV && !hasUvOverride && !hasModifiers) {
-            LOG_WARN("TerrainDecalRenderer: overlay {} falling through because no clip or override path is active",
-                     overlayId);
+        if (!isManagedOverlay && !effectiveClipU && !effectiveClipV && !hasUvOverride && !hasModifiers) {
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::NoCustomPath, overlayId)) {
+                LOG_WARN("TerrainDecalRenderer: overlay {} falling through because no clip or override path is active",
+                         overlayId);
+            }
             return DrawResult::FallThroughToVanilla;
         }
 
@@ -1042,8 +1388,10 @@ namespace TerrainDecal
                                                 overrides.uvOffset)
                 : TextureTransformOverride{};
         if (applyUvWindowToTransform && !texTransformOverride.active) {
-            LOG_WARN("TerrainDecalRenderer: UV override exists for overlay {} but transform override could not be built",
-                     overlayId);
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::TransformOverrideFailed, overlayId)) {
+                LOG_WARN("TerrainDecalRenderer: UV override exists for overlay {} but transform override could not be built",
+                         overlayId);
+            }
             return DrawResult::FallThroughToVanilla;
         }
         if (hasUvOverride) {
@@ -1058,8 +1406,10 @@ namespace TerrainDecal
         }
         if ((applyUvWindowToTransform || hasModifiers) &&
             request.activeTexTransformStage < 0) {
-            LOG_WARN("TerrainDecalRenderer: overlay {} transform override requested but no active texture transform stage was captured",
-                     overlayId);
+            if (diagnostics_.Record(TerrainDecalFallThroughReason::NoTextureTransformStage, overlayId)) {
+                LOG_WARN("TerrainDecalRenderer: overlay {} transform override requested but no active texture transform stage was captured",
+                         overlayId);
+            }
             return DrawResult::FallThroughToVanilla;
         }
 
@@ -1076,7 +1426,8 @@ namespace TerrainDecal
             return DrawResult::Handled;
         }
 
-        const TerrainGridDimensions dimensions = ReadTerrainGridDimensions(*request.addresses);
+        const TerrainGridView grid = CaptureTerrainGridView(*request.addresses);
+        const TerrainGridDimensions& dimensions = grid.dimensions;
         if (dimensions.cellCountX <= 0 || dimensions.cellCountZ <= 0) {
             if (hasUvOverride || debugOverridesActive) {
                 LOG_WARN("TerrainDecalRenderer: overlay {} handled with invalid terrain dimensions {}x{}",
@@ -1100,97 +1451,99 @@ namespace TerrainDecal
             return DrawResult::Handled;
         }
 
-        std::vector<PackedTerrainVertex> outputVertices;
-        bool loadedAnyTerrainCells = false;
+        // With both axes clipped only cells under the clip box can contribute, so atlas-style
+        // sub-rectangles walk their visible window rather than the whole overlay footprint.
+        TerrainDrawRect sweepRect = drawRect;
+        TerrainDrawRect clipBoxCells{};
+        if (effectiveClipU && effectiveClipV && TryProjectClipBoxToCells(slot.matrix, clipBounds, clipBoxCells)) {
+            sweepRect = IntersectTerrainDrawRects(drawRect, clipBoxCells);
+        }
+
+        // Geometry depends only on the slot matrix, rect, clip box and terrain, so overlays whose inputs
+        // did not change since the last frame reuse their clipped triangles.
+        const bool useGeometryCache = geometryCache_.IsEnabled() && hasOverlayId;
+        ClippedGeometrySignature geometrySignature{};
+        const ClippedGeometry* cachedGeometry = nullptr;
+        if (useGeometryCache) {
+            std::copy_n(slot.matrix, geometrySignature.slotMatrix.size(), geometrySignature.slotMatrix.begin());
+            geometrySignature.xStart = drawRect.xStart;
+            geometrySignature.zStart = drawRect.zStart;
+            geometrySignature.xEnd = drawRect.xEnd;
+            geometrySignature.zEnd = drawRect.zEnd;
+            geometrySignature.clipU = effectiveClipU;
+            geometrySignature.clipV = effectiveClipV;
+            geometrySignature.clipBounds = clipBounds;
+            geometrySignature.terrainRevision =
+                terrainRevisionTracker_
+                    ? terrainRevisionTracker_->GetRevisionForCells(drawRect.xStart, drawRect.zStart, drawRect.xEnd, drawRect.zEnd)
+                    : 0;
+            // The tracker's round-robin scan can take several ticks to reach an edit, so the heights the sweep
+            // reads are hashed on every lookup as well; a hit never draws on terrain that has changed.
+            geometrySignature.terrainHash =
+                TerrainRevisionTracker::HashCells(grid, sweepRect.xStart, sweepRect.zStart, sweepRect.xEnd, sweepRect.zEnd);
+            cachedGeometry = geometryCache_.Find(request.overlayManager, NormalizeOverlayIdKey(overlayId), geometrySignature);
+        }
+
+        ClippedGeometry& outputGeometry = geometryArena_;
+        outputGeometry.vertices.clear();
+        outputGeometry.indices.clear();
+        bool loadedAnyTerrainCells = cachedGeometry != nullptr;
         ClipDebugSample clipDebugSample{};
-        const int cellCount = std::max(0, drawRect.xEnd - drawRect.xStart) *
-                              std::max(0, drawRect.zEnd - drawRect.zStart);
-        outputVertices.reserve(static_cast<size_t>(cellCount) * 12);
-
-        for (int cellZ = drawRect.zStart; cellZ < drawRect.zEnd; ++cellZ) {
-            for (int cellX = drawRect.xStart; cellX < drawRect.xEnd; ++cellX) {
-                std::array<ClipVertex, 4> vertices{};
-                std::array<PackedTerrainVertex, 4> sourceVertices{};
-                if (!LoadTerrainCellVertices(*request.addresses, cellX, cellZ, sourceVertices)) {
-                    continue;
-                }
+        if (!cachedGeometry) {
+            const int cellCount = std::max(0, sweepRect.xEnd - sweepRect.xStart) *
+                                  std::max(0, sweepRect.zEnd - sweepRect.zStart);
+            outputGeometry.indexed = options_.enableIndexedSubmission && request.addresses->drawPrimsIndexedRaw != 0;
+            if (outputGeometry.indexed) {
+                outputGeometry.vertices.reserve(std::min(static_cast<size_t>(cellCount) * 4, kMaxIndexedVertices));
+                outputGeometry.indices.reserve(static_cast<size_t>(cellCount) * 12);
+            }
+            else {
+                outputGeometry.vertices.reserve(static_cast<size_t>(cellCount) * 12);
+            }
 
+            const CellSweepInput sweepInput{
+                .grid = &grid,
+                .drawRect = sweepRect,
+                .matrix = slot.matrix,
+                .activeTexTransform = request.activeTexTransform,
+                .clipU = effectiveClipU,
+                .clipV = effectiveClipV,
+                .bounds = clipBounds,
+                .overlayId = overlayId,
+                .diagnostics = &diagnostics_,
+            };
+            lastDrawStats_.cellsVisited = static_cast<uint32_t>(cellCount);
+            if (cellCount > 0) {
+                loadedAnyTerrainCells = SweepTerrainCells(sweepInput,
+                                                          gridRowCache_,
+                                                          gridRowInsideFlags_,
+                                                          gridRowEmittedIndices_,
+                                                          outputGeometry,
+                                                          clipDebugSample,
+                                                          lastDrawStats_);
+            }
+            else {
+                // The clip box misses the overlay rect entirely; treat it like a sweep that clipped
+                // every cell away.
                 loadedAnyTerrainCells = true;
-
-                for (size_t i = 0; i < sourceVertices.size(); ++i) {
-                    vertices[i].vertex = sourceVertices[i];
-                }
-
-                if (!clipDebugSample.captured) {
-                    clipDebugSample.captured = true;
-                    clipDebugSample.cellX = cellX;
-                    clipDebugSample.cellZ = cellZ;
-                    clipDebugSample.sourceVertices = sourceVertices;
-                    clipDebugSample.slotVertices = vertices;
-                    for (auto& vertex : clipDebugSample.slotVertices) {
-                        EvaluateFootprintUv(slot.matrix, vertex);
-                    }
-                    clipDebugSample.slotMayIntersect =
-                        QuadMayIntersectClipBox(clipDebugSample.slotVertices, effectiveClipU, effectiveClipV, clipBounds);
-                    clipDebugSample.slotAllInside =
-                        AllVerticesInside(clipDebugSample.slotVertices, effectiveClipU, effectiveClipV, clipBounds);
-
-                    if (request.activeTexTransform) {
-                        clipDebugSample.activeTransformUsed = true;
-                        clipDebugSample.activeVertices = vertices;
-                        for (auto& vertex : clipDebugSample.activeVertices) {
-                            EvaluateFootprintUv(request.activeTexTransform, vertex);
-                        }
-                        clipDebugSample.activeMayIntersect =
-                            QuadMayIntersectClipBox(clipDebugSample.activeVertices, effectiveClipU, effectiveClipV, clipBounds);
-                        clipDebugSample.activeAllInside =
-                            AllVerticesInside(clipDebugSample.activeVertices, effectiveClipU, effectiveClipV, clipBounds);
-                    }
-                }
-
-                for (auto& vertex : vertices) {
-                    EvaluateFootprintUv(slot.matrix, vertex);
-                }
-
-                if (!AllVerticesHaveFiniteClipUv(vertices)) {
-                    if (ShouldLogOverlayOnce(overlayId, "clip-nan")) {
-                        LogClipNanSample(overlayId, clipDebugSample, slot.matrix);
-                    }
-                    continue;
-                }
-
-                if (!QuadMayIntersectClipBox(vertices, effectiveClipU, effectiveClipV, clipBounds)) {
-                    continue;
-                }
-
-                if (AllVerticesInside(vertices, effectiveClipU, effectiveClipV, clipBounds)) {
-                    outputVertices.push_back(vertices[0].vertex);
-                    outputVertices.push_back(vertices[1].vertex);
-                    outputVertices.push_back(vertices[2].vertex);
-                    outputVertices.push_back(vertices[0].vertex);
-                    outputVertices.push_back(vertices[2].vertex);
-                    outputVertices.push_back(vertices[3].vertex);
-                }
-                else {
-                    ClipAndEmitPolygon({vertices[0], vertices[1], vertices[2], vertices[3]},
-                                       effectiveClipU,
-                                       effectiveClipV,
-                                       clipBounds,
-                                       outputVertices);
-                }
+            }
+            if (useGeometryCache) {
+                geometryCache_.Store(request.overlayManager, NormalizeOverlayIdKey(overlayId), geometrySignature, outputGeometry);
             }
         }
+        const ClippedGeometry& submitGeometry = cachedGeometry ? *cachedGeometry : outputGeometry;
+        lastDrawStats_.geometryCacheHit = cachedGeometry != nullptr;
 
-        if (outputVertices.empty()) {
+        if (submitGeometry.vertices.empty()) {
             if (!loadedAnyTerrainCells) {
-                if (ShouldLogOverlayOnce(overlayId, "no-terrain-cells")) {
+                if (diagnostics_.Record(TerrainDecalFallThroughReason::NoTerrainCells, overlayId)) {
                     LOG_TRACE("TerrainDecalRenderer: overlay {} fell through because no terrain cells loaded", overlayId);
                 }
                 return DrawResult::FallThroughToVanilla;
             }
 
-            if (!forceCustomDraw && !hasUvOverride && !hasModifiers) {
-                if (ShouldLogOverlayOnce(overlayId, "clip-empty")) {
+            if (!isManagedOverlay && !hasUvOverride && !hasModifiers) {
+                if (diagnostics_.Record(TerrainDecalFallThroughReason::ClipProducedNothing, overlayId)) {
                     LOG_TRACE("TerrainDecalRenderer: overlay {} fell through because clipping produced no output vertices",
                              overlayId);
                     LogClipDebugSample(overlayId, clipDebugSample, clipBounds, effectiveClipU, effectiveClipV);
@@ -1198,31 +1551,60 @@ namespace TerrainDecal
                 return DrawResult::FallThroughToVanilla;
             }
 
-            if (hasUvOverride || debugOverridesActive || forceCustomDraw) {
+            if (hasUvOverride || debugOverridesActive || isManagedOverlay) {
                 LOG_DEBUG("TerrainDecalRenderer: overlay {} handled but produced no output vertices", overlayId);
             }
             return DrawResult::Handled;
         }
 
-        if (texTransformOverride.active) {
-            const auto setTexTransform = reinterpret_cast<SetTexTransform4Fn>(request.addresses->setTexTransform4);
-            setTexTransform(request.drawContext, texTransformOverride.adjusted.data(), request.activeTexTransformStage);
+        const int effectiveDepthOffset = overrides.depthOffset >= 0 ? overrides.depthOffset : options_.customDefaultDepthOffset;
+        const float* const texTransformOverrideData = texTransformOverride.active ? texTransformOverride.adjusted.data() : nullptr;
+        Submit_(request,
+                SubmitGeometry{
+                    .vertices = submitGeometry.vertices.data(),
+                    .vertexCount = static_cast<uint32_t>(submitGeometry.vertices.size()),
+                    .indices = submitGeometry.indices.data(),
+                    .indexCount = static_cast<uint32_t>(submitGeometry.indices.size()),
+                    .indexed = submitGeometry.indexed,
+                },
+                texTransformOverrideData,
+                baseTexTransform,
+                effectiveDepthOffset,
+                false);
+        if (hasUvOverride || debugOverridesActive) {
+            LOG_TRACE("TerrainDecalRenderer: overlay {} submitted {} vertices, {} indices",
+                      overlayId,
+                      submitGeometry.vertices.size(),
+                      submitGeometry.indices.size());
         }
 
-        const int effectiveDepthOffset = shadowRecovery
-                                             ? options_.shadowRecoveryDepthOffset
-                                             : (overrides.depthOffset >= 0
-                                                    ? overrides.depthOffset
-                                                    : options_.customDefaultDepthOffset);
+        if (isManagedOverlay && hasOverlayId) {
+            RecordDraw_(request, overlayId, submitGeometry, texTransformOverrideData);
+        }
+
+        return DrawResult::Handled;
+    }
+
+    void ClippedTerrainDecalRenderer::Submit_(const DrawRequest& request,
+                                              const SubmitGeometry& geometry,
+                                              const float* const texTransformOverride,
+                                              const float* const baseTexTransform,
+                                              const int depthOffset,
+                                              const bool scaleOpacity)
+    {
+        if (texTransformOverride) {
+            const auto setTexTransform = reinterpret_cast<SetTexTransform4Fn>(request.addresses->setTexTransform4);
+            setTexTransform(request.drawContext, texTransformOverride, request.activeTexTransformStage);
+        }
 
         if (request.addresses->setDepthOffset) {
             const auto setDepthOffset = reinterpret_cast<SetDepthOffsetFn>(request.addresses->setDepthOffset);
-            setDepthOffset(request.drawContext, effectiveDepthOffset);
+            setDepthOffset(request.drawContext, depthOffset);
         }
 
         float originalOpacity = 1.0f;
         bool opacityScaled = false;
-        if (shadowRecovery && request.overlaySlotBase) {
+        if (scaleOpacity && request.overlaySlotBase) {
             originalOpacity = ReadOverlaySlotOpacity(request.overlaySlotBase);
             if (std::isfinite(originalOpacity)) {
                 const float opacityScale = std::clamp(options_.shadowRecoveryOpacityScale, 0.0f, 1.0f);
@@ -1231,15 +1613,27 @@ namespace TerrainDecal
             }
         }
 
-        const auto drawPrims = reinterpret_cast<DrawPrimsFn>(request.addresses->drawPrims);
-        drawPrims(request.drawContext,
-                  kPrimTypeTriangleList,
-                  kTerrainVertexFormat,
-                  static_cast<uint32_t>(outputVertices.size()),
-                  outputVertices.data());
-        if (hasUvOverride || debugOverridesActive) {
-            LOG_TRACE("TerrainDecalRenderer: overlay {} submitted {} vertices", overlayId, outputVertices.size());
+        if (geometry.indexed) {
+            const auto drawPrimsIndexedRaw = reinterpret_cast<DrawPrimsIndexedRawFn>(request.addresses->drawPrimsIndexedRaw);
+            drawPrimsIndexedRaw(request.drawContext,
+                                kPrimTypeTriangleList,
+                                kTerrainVertexFormat,
+                                geometry.vertexCount,
+                                geometry.vertices,
+                                geometry.indexCount,
+                                geometry.indices);
         }
+        else {
+            const auto drawPrims = reinterpret_cast<DrawPrimsFn>(request.addresses->drawPrims);
+            drawPrims(request.drawContext,
+                      kPrimTypeTriangleList,
+                      kTerrainVertexFormat,
+                      geometry.vertexCount,
+                      geometry.vertices);
+        }
+
+        ++lastDrawStats_.drawCalls;
+        lastDrawStats_.verticesSubmitted += geometry.vertexCount;
 
         if (opacityScaled) {
             SetOverlayTransparency(request.drawContext, *request.addresses, originalOpacity);
@@ -1250,11 +1644,101 @@ namespace TerrainDecal
             setDepthOffset(request.drawContext, kVanillaDecalDepthOffset);
         }
 
-        if (texTransformOverride.active) {
+        if (texTransformOverride) {
             const auto setTexTransform = reinterpret_cast<SetTexTransform4Fn>(request.addresses->setTexTransform4);
             setTexTransform(request.drawContext, baseTexTransform, request.activeTexTransformStage);
         }
+    }
 
+    void ClippedTerrainDecalRenderer::RecordDraw_(const DrawRequest& request,
+                                                  const uint32_t overlayId,
+                                                  const ClippedGeometry& geometry,
+                                                  const float* const texTransformOverride)
+    {
+        const uint32_t key = NormalizeOverlayIdKey(overlayId);
+        if (key >= kMaxDrawListOverlays) {
+            return;
+        }
+
+        if (drawListOverlayManager_ != request.overlayManager) {
+            ResetDrawList();
+            drawListOverlayManager_ = request.overlayManager;
+        }
+
+        if (key >= drawListSlots_.size()) {
+            drawListSlots_.resize(static_cast<size_t>(key) + 1);
+        }
+        drawListSlots_[key] = DrawListSlot{
+            .generation = drawListGeneration_,
+            .drawIndex = static_cast<uint32_t>(drawList_.size()),
+        };
+
+        RecordedDraw& draw = drawList_.emplace_back();
+        draw.firstVertex = static_cast<uint32_t>(drawListVertices_.size());
+        draw.vertexCount = static_cast<uint32_t>(geometry.vertices.size());
+        draw.firstIndex = static_cast<uint32_t>(drawListIndices_.size());
+        draw.indexCount = static_cast<uint32_t>(geometry.indices.size());
+        draw.indexed = geometry.indexed;
+        draw.texTransformOverrideActive = texTransformOverride != nullptr;
+        if (texTransformOverride) {
+            std::copy_n(texTransformOverride, draw.texTransformOverride.size(), draw.texTransformOverride.begin());
+        }
+        drawListVertices_.insert(drawListVertices_.end(), geometry.vertices.begin(), geometry.vertices.end());
+        drawListIndices_.insert(drawListIndices_.end(), geometry.indices.begin(), geometry.indices.end());
+    }
+
+    DrawResult ClippedTerrainDecalRenderer::ReplayRecordedDraw_(const DrawRequest& request,
+                                                                const uint32_t overlayId,
+                                                                const float* const baseTexTransform)
+    {
+        if (!IsDrawRecorded_(request.overlayManager, overlayId)) {
+            return DrawResult::Handled;
+        }
+
+        const RecordedDraw& draw = drawList_[drawListSlots_[NormalizeOverlayIdKey(overlayId)].drawIndex];
+        if (draw.texTransformOverrideActive && request.activeTexTransformStage < 0) {
+            return DrawResult::Handled;
+        }
+
+        Submit_(request,
+                SubmitGeometry{
+                    .vertices = drawListVertices_.data() + draw.firstVertex,
+                    .vertexCount = draw.vertexCount,
+                    .indices = drawListIndices_.data() + draw.firstIndex,
+                    .indexCount = draw.indexCount,
+                    .indexed = draw.indexed,
+                },
+                draw.texTransformOverrideActive ? draw.texTransformOverride.data() : nullptr,
+                baseTexTransform,
+                options_.shadowRecoveryDepthOffset,
+                true);
+        lastDrawStats_.replayed = true;
         return DrawResult::Handled;
     }
+
+    bool ClippedTerrainDecalRenderer::IsDrawRecorded_(const void* const overlayManager, const uint32_t overlayId) const noexcept
+    {
+        const uint32_t key = NormalizeOverlayIdKey(overlayId);
+        return drawListOverlayManager_ == overlayManager &&
+               key < drawListSlots_.size() &&
+               drawListSlots_[key].generation == drawListGeneration_;
+    }
+
+    bool ClippedTerrainDecalRenderer::HasRecordedDraws(const void* const overlayManager) const noexcept
+    {
+        return !drawList_.empty() && drawListOverlayManager_ == overlayManager;
+    }
+
+    void ClippedTerrainDecalRenderer::ResetDrawList() noexcept
+    {
+        drawList_.clear();
+        drawListVertices_.clear();
+        drawListIndices_.clear();
+        drawListOverlayManager_ = nullptr;
+        if (++drawListGeneration_ == 0) {
+            // Generation 0 would match never-written slots.
+            std::fill(drawListSlots_.begin(), drawListSlots_.end(), DrawListSlot{});
+            drawListGeneration_ = 1;
+        }
+    }
 }
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
+#include "ClippedGeometryCache.h"
 #include "cRZRect.h"
+#include "FallThroughDiagnostics.h"
 #include "public/cIGZTerrainDecalService.h"
 #include "TerrainDecalSymbols.h"
+#include "TerrainDecalGeometry.h"
 
 class SC4DrawContext;
 class cISTETerrain;
@@ -14,6 +20,8 @@ class cISTETerrainView;
 
 namespace TerrainDecal
 {
+    class TerrainRevisionTracker;
+
     enum class DrawResult
     {
         FallThroughToVanilla,
@@ -34,6 +42,11 @@ namespace TerrainDecal
         int customDefaultDepthOffset = 2;
         int shadowRecoveryDepthOffset = 4;
         float shadowRecoveryOpacityScale = 0.25f;
+        // Byte budget for cached clipped triangles per overlay; 0 disables the cache.
+        size_t geometryCacheBudgetBytes = 0;
+        // Submit unique vertices plus 16-bit indices through drawPrimsIndexedRaw instead of a
+        // plain triangle list through drawPrims.
+        bool enableIndexedSubmission = false;
     };
 
     struct DrawRequest
@@ -69,6 +82,19 @@ namespace TerrainDecal
                o.uvScaleV != 1.0f || o.uvOffset != 0.0f;
     }
 
+    // Work done by the most recent Draw call.
+    struct LastDrawStats
+    {
+        uint32_t cellsVisited = 0;
+        uint32_t cellsCulled = 0;
+        uint32_t cellsFullyInside = 0;
+        uint32_t cellsClipped = 0;
+        uint32_t verticesSubmitted = 0;
+        uint32_t drawCalls = 0;
+        bool geometryCacheHit = false;
+        bool replayed = false;
+    };
+
     using OverlayOverridesResolver = bool (*)(void* overlayManager, uint32_t overlayId,
                                               TerrainDecalOverlayOverrides& overrides, void* userData);
 
@@ -86,12 +112,106 @@ namespace TerrainDecal
         [[nodiscard]] bool TryGetOverlayUvWindow(uint32_t overlayId, TerrainDecalUvWindow& uvWindow) const noexcept;
         void SetOverlayOverridesResolver(OverlayOverridesResolver resolver, void* userData) noexcept;
 
+        // Cached geometry is keyed by the highest tracker revision under its draw rect and by a hash of the
+        // heights under the rect taken on every lookup, so it is rebuilt on its next draw once the ground
+        // under it changes, whether or not the tracker has noticed yet. The tracker is optional.
+        void SetTerrainRevisionTracker(const TerrainRevisionTracker* tracker) noexcept;
+        void InvalidateOverlayGeometry(void* overlayManager, uint32_t overlayId) noexcept;
+        void ClearGeometryCache() noexcept;
+        [[nodiscard]] ClippedGeometryCacheStats GetGeometryCacheStats() const noexcept;
+
         [[nodiscard]] DrawResult Draw(const DrawRequest& request);
+        [[nodiscard]] const LastDrawStats& GetLastDrawStats() const noexcept;
+        [[nodiscard]] TerrainDecalRendererDiagnostics GetDiagnostics() const noexcept;
+
+        // Draw adds into the current frame's stats. PublishFrameStats closes the frame, making it what
+        // GetFrameStats returns, and starts the next one in the other buffer. Draw is only timed during
+        // frames that follow a GetFrameStats call, so nobody pays for the clock reads unless stats are read.
+        void PublishFrameStats() noexcept;
+        // Publishes only when the current frame drew something, for callers that cannot tell where a
+        // frame ends.
+        void PublishPendingFrameStats() noexcept;
+        [[nodiscard]] const TerrainDecalRendererFrameStats& GetFrameStats() const noexcept;
+
+        // Managed decals submitted by a Normal draw are recorded into a per-pass draw list, and a
+        // ShadowRecovery draw of the same overlay re-submits the recorded triangles instead of clipping
+        // again. A Normal draw of an overlay that is already in the list, or a recording from another
+        // overlay manager, starts a new list.
+        [[nodiscard]] bool HasRecordedDraws(const void* overlayManager) const noexcept;
+        void ResetDrawList() noexcept;
+
+    private:
+        struct SubmitGeometry
+        {
+            const PackedTerrainVertex* vertices = nullptr;
+            uint32_t vertexCount = 0;
+            const uint16_t* indices = nullptr;
+            uint32_t indexCount = 0;
+            bool indexed = false;
+        };
+
+        // Geometry lives in drawListVertices_ / drawListIndices_.
+        struct RecordedDraw
+        {
+            uint32_t firstVertex = 0;
+            uint32_t vertexCount = 0;
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            bool indexed = false;
+            bool texTransformOverrideActive = false;
+            std::array<float, 16> texTransformOverride{};
+        };
+
+        // Draw list position of an overlay, valid while generation matches drawListGeneration_.
+        struct DrawListSlot
+        {
+            uint32_t generation = 0;
+            uint32_t drawIndex = 0;
+        };
+
+        [[nodiscard]] DrawResult DrawOverlay_(const DrawRequest& request);
+        void Submit_(const DrawRequest& request,
+                     const SubmitGeometry& geometry,
+                     const float* texTransformOverride,
+                     const float* baseTexTransform,
+                     int depthOffset,
+                     bool scaleOpacity);
+        void RecordDraw_(const DrawRequest& request,
+                         uint32_t overlayId,
+                         const ClippedGeometry& geometry,
+                         const float* texTransformOverride);
+        [[nodiscard]] bool IsDrawRecorded_(const void* overlayManager, uint32_t overlayId) const noexcept;
+        [[nodiscard]] DrawResult ReplayRecordedDraw_(const DrawRequest& request,
+                                                     uint32_t overlayId,
+                                                     const float* baseTexTransform);
 
     private:
         RendererOptions options_;
         std::unordered_map<uint32_t, TerrainDecalUvWindow> overlayUvWindows_;
         OverlayOverridesResolver overlayOverridesResolver_ = nullptr;
         void* overlayOverridesResolverUserData_ = nullptr;
+        // Reused across Draw calls so steady-state decal drawing does not touch the heap.
+        ClippedGeometry geometryArena_{};
+        // Two rolling rows of transformed grid vertices for the cell sweep.
+        std::vector<ClipVertex> gridRowCache_{};
+        std::vector<uint8_t> gridRowInsideFlags_{};
+        std::vector<uint32_t> gridRowEmittedIndices_{};
+        ClippedGeometryCache geometryCache_{};
+        const TerrainRevisionTracker* terrainRevisionTracker_ = nullptr;
+        LastDrawStats lastDrawStats_{};
+        FallThroughDiagnostics diagnostics_{};
+        std::array<TerrainDecalRendererFrameStats, 2> frameStats_{};
+        uint32_t frameStatsWriteIndex_ = 0;
+        std::chrono::steady_clock::duration frameDrawTime_{};
+        uint64_t frameCount_ = 0;
+        mutable bool frameStatsPolled_ = false;
+        bool timeFrameDraws_ = false;
+        // Per-pass draw list. Cleared rather than freed so steady-state recording does not allocate.
+        const void* drawListOverlayManager_ = nullptr;
+        std::vector<RecordedDraw> drawList_{};
+        std::vector<PackedTerrainVertex> drawListVertices_{};
+        std::vector<uint16_t> drawListIndices_{};
+        std::vector<DrawListSlot> drawListSlots_{};
+        uint32_t drawListGeneration_ = 1;
     };
 }
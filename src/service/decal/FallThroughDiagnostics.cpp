@@ -0,0 +1,48 @@
+#include "FallThroughDiagnostics.h"
+
+namespace TerrainDecal
+{
+    void FallThroughDiagnostics::CountDraw() noexcept
+    {
+        draws_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool FallThroughDiagnostics::Record(const TerrainDecalFallThroughReason reason, const uint32_t overlayId) noexcept
+    {
+        const auto index = static_cast<uint32_t>(reason);
+        if (index >= kTerrainDecalFallThroughReasonCount) {
+            return false;
+        }
+
+        fallThroughs_[index].fetch_add(1, std::memory_order_relaxed);
+        return MarkReported_(index, overlayId);
+    }
+
+    bool FallThroughDiagnostics::RecordNonFiniteClipCell(const uint32_t overlayId) noexcept
+    {
+        nonFiniteClipCells_.fetch_add(1, std::memory_order_relaxed);
+        return MarkReported_(kNonFiniteClipCellBit, overlayId);
+    }
+
+    TerrainDecalRendererDiagnostics FallThroughDiagnostics::Snapshot() const noexcept
+    {
+        TerrainDecalRendererDiagnostics diagnostics{};
+        diagnostics.draws = draws_.load(std::memory_order_relaxed);
+        diagnostics.nonFiniteClipCells = nonFiniteClipCells_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < kTerrainDecalFallThroughReasonCount; ++i) {
+            diagnostics.fallThroughs[i] = fallThroughs_[i].load(std::memory_order_relaxed);
+        }
+        return diagnostics;
+    }
+
+    bool FallThroughDiagnostics::MarkReported_(const uint32_t bit, const uint32_t overlayId) noexcept
+    {
+        const auto mask = static_cast<uint16_t>(1u << bit);
+        std::atomic<uint16_t>& slot = reported_[overlayId % kReportedOverlaySlots];
+        // Overlays that keep falling through only pay the load once they have been reported.
+        if ((slot.load(std::memory_order_relaxed) & mask) != 0) {
+            return false;
+        }
+        return (slot.fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+}
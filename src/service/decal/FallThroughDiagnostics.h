@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "public/cIGZTerrainDecalService2.h"
+
+namespace TerrainDecal
+{
+    // Counters for the renderer's fall-through paths, cheap enough to bump on every draw. Each occurrence
+    // is counted; the matching log line is reported once per overlay. Reported reasons are kept in a
+    // fixed bitset indexed by overlay id modulo kReportedOverlaySlots, so overlays that share a slot also
+    // share their first report.
+    class FallThroughDiagnostics final
+    {
+    public:
+        static constexpr uint32_t kReportedOverlaySlots = 4096;
+
+        void CountDraw() noexcept;
+        // Counts one fall-through and returns true the first time overlayId hits reason.
+        [[nodiscard]] bool Record(TerrainDecalFallThroughReason reason, uint32_t overlayId) noexcept;
+        // Counts one skipped cell and returns true the first time overlayId skips one.
+        [[nodiscard]] bool RecordNonFiniteClipCell(uint32_t overlayId) noexcept;
+
+        [[nodiscard]] TerrainDecalRendererDiagnostics Snapshot() const noexcept;
+
+    private:
+        [[nodiscard]] bool MarkReported_(uint32_t bit, uint32_t overlayId) noexcept;
+
+    private:
+        // One bit per reason, then one for non-finite clip cells.
+        static constexpr uint32_t kNonFiniteClipCellBit = kTerrainDecalFallThroughReasonCount;
+        static_assert(kNonFiniteClipCellBit < 16);
+
+        std::atomic<uint64_t> draws_{0};
+        std::atomic<uint64_t> nonFiniteClipCells_{0};
+        std::array<std::atomic<uint64_t>, kTerrainDecalFallThroughReasonCount> fallThroughs_{};
+        std::array<std::atomic<uint16_t>, kReportedOverlaySlots> reported_{};
+    };
+}
@@ -0,0 +1,182 @@
+#include "FootprintUvKernel.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SC4RS_FOOTPRINT_UV_SSE2 1
+#include <emmintrin.h>
+#else
+#define SC4RS_FOOTPRINT_UV_SSE2 0
+#endif
+
+namespace TerrainDecal
+{
+    void EvaluateFootprintUv(const float* matrix, ClipVertex& vertex) noexcept
+    {
+        if (!matrix) {
+            return;
+        }
+
+        const float sourceX = vertex.vertex.x;
+        const float sourceY = vertex.vertex.y;
+        const float sourceZ = vertex.vertex.z;
+
+        const float u = sourceX * matrix[0] + sourceY * matrix[4] + sourceZ * matrix[8] + matrix[12];
+        const float v = sourceX * matrix[1] + sourceY * matrix[5] + sourceZ * matrix[9] + matrix[13];
+        const float w = sourceX * matrix[3] + sourceY * matrix[7] + sourceZ * matrix[11] + matrix[15];
+
+        if (std::fabs(w) > kClipEpsilon && std::fabs(w - 1.0f) > kClipEpsilon) {
+            vertex.clipU = u / w;
+            vertex.clipV = v / w;
+        }
+        else {
+            vertex.clipU = u;
+            vertex.clipV = v;
+        }
+    }
+
+    bool IsClipVertexInside(const ClipVertex& vertex,
+                            const bool clipU,
+                            const bool clipV,
+                            const ClipBounds& bounds) noexcept
+    {
+        if (!std::isfinite(vertex.clipU) || !std::isfinite(vertex.clipV)) {
+            return false;
+        }
+
+        const bool insideU = !clipU || (vertex.clipU >= bounds.minU - kClipEpsilon &&
+                                        vertex.clipU <= bounds.maxU + kClipEpsilon);
+        const bool insideV = !clipV || (vertex.clipV >= bounds.minV - kClipEpsilon &&
+                                        vertex.clipV <= bounds.maxV + kClipEpsilon);
+        return insideU && insideV;
+    }
+
+    void EvaluateFootprintUvBatchScalar(const float* const matrix,
+                                        const bool clipU,
+                                        const bool clipV,
+                                        const ClipBounds& bounds,
+                                        ClipVertex* const vertices,
+                                        uint8_t* const insideFlags,
+                                        const size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; ++i) {
+            EvaluateFootprintUv(matrix, vertices[i]);
+            insideFlags[i] = IsClipVertexInside(vertices[i], clipU, clipV, bounds) ? 1u : 0u;
+        }
+    }
+
+#if SC4RS_FOOTPRINT_UV_SSE2
+    void EvaluateFootprintUvBatchSse2(const float* const matrix,
+                                      const bool clipU,
+                                      const bool clipV,
+                                      const ClipBounds& bounds,
+                                      ClipVertex* const vertices,
+                                      uint8_t* const insideFlags,
+                                      const size_t count) noexcept
+    {
+        if (!matrix) {
+            EvaluateFootprintUvBatchScalar(matrix, clipU, clipV, bounds, vertices, insideFlags, count);
+            return;
+        }
+
+        const __m128 m0 = _mm_set1_ps(matrix[0]);
+        const __m128 m4 = _mm_set1_ps(matrix[4]);
+        const __m128 m8 = _mm_set1_ps(matrix[8]);
+        const __m128 m12 = _mm_set1_ps(matrix[12]);
+        const __m128 m1 = _mm_set1_ps(matrix[1]);
+        const __m128 m5 = _mm_set1_ps(matrix[5]);
+        const __m128 m9 = _mm_set1_ps(matrix[9]);
+        const __m128 m13 = _mm_set1_ps(matrix[13]);
+        const __m128 m3 = _mm_set1_ps(matrix[3]);
+        const __m128 m7 = _mm_set1_ps(matrix[7]);
+        const __m128 m11 = _mm_set1_ps(matrix[11]);
+        const __m128 m15 = _mm_set1_ps(matrix[15]);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 epsilon = _mm_set1_ps(kClipEpsilon);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 allOnes = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        // Same float expressions as IsClipVertexInside so the comparisons round identically.
+        const __m128 minU = _mm_set1_ps(bounds.minU - kClipEpsilon);
+        const __m128 maxU = _mm_set1_ps(bounds.maxU + kClipEpsilon);
+        const __m128 minV = _mm_set1_ps(bounds.minV - kClipEpsilon);
+        const __m128 maxV = _mm_set1_ps(bounds.maxV + kClipEpsilon);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            ClipVertex* const v = vertices + i;
+            const __m128 x = _mm_setr_ps(v[0].vertex.x, v[1].vertex.x, v[2].vertex.x, v[3].vertex.x);
+            const __m128 y = _mm_setr_ps(v[0].vertex.y, v[1].vertex.y, v[2].vertex.y, v[3].vertex.y);
+            const __m128 z = _mm_setr_ps(v[0].vertex.z, v[1].vertex.z, v[2].vertex.z, v[3].vertex.z);
+
+            // Keep the scalar evaluation order ((x*a + y*b) + z*c) + d for bit-identical results.
+            const __m128 u = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m0), _mm_mul_ps(y, m4)), _mm_mul_ps(z, m8)), m12);
+            const __m128 vv = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m1), _mm_mul_ps(y, m5)), _mm_mul_ps(z, m9)), m13);
+            const __m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m3), _mm_mul_ps(y, m7)), _mm_mul_ps(z, m11)), m15);
+
+            const __m128 divide = _mm_and_ps(_mm_cmpgt_ps(_mm_and_ps(w, absMask), epsilon),
+                                             _mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(w, one), absMask), epsilon));
+            const __m128 clipUValues = _mm_or_ps(_mm_and_ps(divide, _mm_div_ps(u, w)), _mm_andnot_ps(divide, u));
+            const __m128 clipVValues = _mm_or_ps(_mm_and_ps(divide, _mm_div_ps(vv, w)), _mm_andnot_ps(divide, vv));
+
+            alignas(16) float us[4];
+            alignas(16) float vs[4];
+            _mm_store_ps(us, clipUValues);
+            _mm_store_ps(vs, clipVValues);
+            for (int lane = 0; lane < 4; ++lane) {
+                v[lane].clipU = us[lane];
+                v[lane].clipV = vs[lane];
+            }
+
+            // x - x is 0 for finite x and NaN for NaN/inf.
+            const __m128 finite = _mm_and_ps(_mm_cmpeq_ps(_mm_sub_ps(clipUValues, clipUValues), zero),
+                                             _mm_cmpeq_ps(_mm_sub_ps(clipVValues, clipVValues), zero));
+            const __m128 insideU = clipU
+                                       ? _mm_and_ps(_mm_cmpge_ps(clipUValues, minU), _mm_cmple_ps(clipUValues, maxU))
+                                       : allOnes;
+            const __m128 insideV = clipV
+                                       ? _mm_and_ps(_mm_cmpge_ps(clipVValues, minV), _mm_cmple_ps(clipVValues, maxV))
+                                       : allOnes;
+            const int mask = _mm_movemask_ps(_mm_and_ps(finite, _mm_and_ps(insideU, insideV)));
+            insideFlags[i + 0] = static_cast<uint8_t>(mask & 1);
+            insideFlags[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+            insideFlags[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+            insideFlags[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+        }
+
+        EvaluateFootprintUvBatchScalar(matrix, clipU, clipV, bounds, vertices + i, insideFlags + i, count - i);
+    }
+#else
+    void EvaluateFootprintUvBatchSse2(const float* const matrix,
+                                      const bool clipU,
+                                      const bool clipV,
+                                      const ClipBounds& bounds,
+                                      ClipVertex* const vertices,
+                                      uint8_t* const insideFlags,
+                                      const size_t count) noexcept
+    {
+        EvaluateFootprintUvBatchScalar(matrix, clipU, clipV, bounds, vertices, insideFlags, count);
+    }
+#endif
+
+    void EvaluateFootprintUvBatch(const float* const matrix,
+                                  const bool clipU,
+                                  const bool clipV,
+                                  const ClipBounds& bounds,
+                                  ClipVertex* const vertices,
+                                  uint8_t* const insideFlags,
+                                  const size_t count) noexcept
+    {
+#if SC4RS_FOOTPRINT_UV_SSE2
+        EvaluateFootprintUvBatchSse2(matrix, clipU, clipV, bounds, vertices, insideFlags, count);
+#else
+        EvaluateFootprintUvBatchScalar(matrix, clipU, clipV, bounds, vertices, insideFlags, count);
+#endif
+    }
+
+    bool HasSse2FootprintUvKernel() noexcept
+    {
+        return SC4RS_FOOTPRINT_UV_SSE2 != 0;
+    }
+}
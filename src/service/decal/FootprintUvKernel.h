@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TerrainDecalGeometry.h"
+
+namespace TerrainDecal
+{
+    constexpr float kClipEpsilon = 1.0e-5f;
+
+    struct ClipBounds
+    {
+        float minU = 0.0f;
+        float maxU = 1.0f;
+        float minV = 0.0f;
+        float maxV = 1.0f;
+    };
+
+    // Reference implementation: projects one vertex through the 4x4 slot matrix into footprint UV.
+    void EvaluateFootprintUv(const float* matrix, ClipVertex& vertex) noexcept;
+
+    // True when the vertex has a finite footprint UV inside the enabled clip planes (with epsilon slack).
+    [[nodiscard]] bool IsClipVertexInside(const ClipVertex& vertex,
+                                          bool clipU,
+                                          bool clipV,
+                                          const ClipBounds& bounds) noexcept;
+
+    // Evaluates footprint UV for `count` vertices in place and writes one inside flag (0/1) per vertex.
+    // The scalar variant is the reference; the SSE2 variant processes four vertices per iteration and
+    // produces bit-identical UVs and flags. EvaluateFootprintUvBatch picks the best one for the build.
+    void EvaluateFootprintUvBatchScalar(const float* matrix,
+                                        bool clipU,
+                                        bool clipV,
+                                        const ClipBounds& bounds,
+                                        ClipVertex* vertices,
+                                        uint8_t* insideFlags,
+                                        size_t count) noexcept;
+    void EvaluateFootprintUvBatchSse2(const float* matrix,
+                                      bool clipU,
+                                      bool clipV,
+                                      const ClipBounds& bounds,
+                                      ClipVertex* vertices,
+                                      uint8_t* insideFlags,
+                                      size_t count) noexcept;
+    void EvaluateFootprintUvBatch(const float* matrix,
+                                  bool clipU,
+                                  bool clipV,
+                                  const ClipBounds& bounds,
+                                  ClipVertex* vertices,
+                                  uint8_t* insideFlags,
+                                  size_t count) noexcept;
+
+    [[nodiscard]] bool HasSse2FootprintUvKernel() noexcept;
+}
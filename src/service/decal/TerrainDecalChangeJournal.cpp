@@ -0,0 +1,65 @@
+#include "TerrainDecalChangeJournal.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+void TerrainDecalChangeJournal::Record(const TerrainDecalId id, const TerrainDecalChangeKind kind)
+{
+    if (entries_.empty()) {
+        entries_.resize(kCapacity);
+    }
+
+    ++sequence_;
+    entries_[sequence_ % kCapacity] = TerrainDecalChange{.sequence = sequence_, .id = id, .kind = kind};
+    if (sequence_ - floor_ > kCapacity) {
+        floor_ = sequence_ - kCapacity;
+    }
+}
+
+void TerrainDecalChangeJournal::Invalidate() noexcept
+{
+    ++sequence_;
+    floor_ = sequence_;
+}
+
+uint64_t TerrainDecalChangeJournal::GetSequence() const noexcept
+{
+    return sequence_;
+}
+
+TerrainDecalChangesResult TerrainDecalChangeJournal::ReadSince(const uint64_t sequence,
+                                                               TerrainDecalChange* const outChanges,
+                                                               const uint32_t capacity,
+                                                               const uint32_t changeSize,
+                                                               uint32_t& outCount,
+                                                               uint64_t& outSequence) const noexcept
+{
+    outCount = 0;
+    outSequence = sequence_;
+
+    if (sequence < floor_ || sequence > sequence_) {
+        return TerrainDecalChangesResult::ResyncRequired;
+    }
+
+    const uint64_t pending = sequence_ - sequence;
+    if (pending == 0) {
+        return TerrainDecalChangesResult::Ok;
+    }
+
+    if (!outChanges || capacity == 0 || changeSize < sizeof(TerrainDecalChange)) {
+        outSequence = sequence;
+        return TerrainDecalChangesResult::InvalidArgument;
+    }
+
+    const auto count = static_cast<uint32_t>(std::min<uint64_t>(pending, capacity));
+    auto* const bytes = reinterpret_cast<std::byte*>(outChanges);
+    for (uint32_t i = 0; i < count; ++i) {
+        const TerrainDecalChange& change = entries_[(sequence + 1 + i) % kCapacity];
+        std::memcpy(bytes + static_cast<size_t>(changeSize) * i, &change, sizeof(TerrainDecalChange));
+    }
+
+    outCount = count;
+    outSequence = sequence + count;
+    return TerrainDecalChangesResult::Ok;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "public/cIGZTerrainDecalService2.h"
+
+// Bounded ring of the most recent decal changes. Sequence numbers start at 1 and never repeat for the
+// lifetime of the journal; entry n lives at index n % kCapacity.
+class TerrainDecalChangeJournal {
+public:
+    static constexpr uint32_t kCapacity = 4096;
+
+    void Record(TerrainDecalId id, TerrainDecalChangeKind kind);
+    // Drops every entry. Readers at any earlier sequence are told to resync.
+    void Invalidate() noexcept;
+
+    [[nodiscard]] uint64_t GetSequence() const noexcept;
+
+    // Writes changes after sequence with the given element stride. outSequence receives the sequence to
+    // pass next time.
+    TerrainDecalChangesResult ReadSince(uint64_t sequence,
+                                        TerrainDecalChange* outChanges,
+                                        uint32_t capacity,
+                                        uint32_t changeSize,
+                                        uint32_t& outCount,
+                                        uint64_t& outSequence) const noexcept;
+
+private:
+    std::vector<TerrainDecalChange> entries_{};
+    uint64_t sequence_ = 0;
+    // Oldest sequence a reader can resume from; entries up to and including it are gone.
+    uint64_t floor_ = 0;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace TerrainDecal
+{
+    struct PackedTerrainVertex
+    {
+        float x;
+        float y;
+        float z;
+        uint32_t diffuse;
+        float u;
+        float v;
+        float extra0;
+        float extra1;
+    };
+
+    static_assert(sizeof(PackedTerrainVertex) == 0x20,
+                  "PackedTerrainVertex must match the game's 32-byte terrain vertex layout.");
+
+    // A terrain vertex plus its footprint UV under the overlay slot matrix.
+    struct ClipVertex
+    {
+        PackedTerrainVertex vertex{};
+        float clipU = 0.0f;
+        float clipV = 0.0f;
+    };
+
+    // Largest vertex count addressable by 16-bit indices.
+    constexpr size_t kMaxIndexedVertices = 0x10000;
+
+    // Clipped decal triangles for one overlay: either a plain triangle list, or unique vertices plus a
+    // 16-bit triangle-list index buffer.
+    struct ClippedGeometry
+    {
+        std::vector<PackedTerrainVertex> vertices{};
+        std::vector<uint16_t> indices{};
+        bool indexed = false;
+    };
+
+    // Appends the triangles described by geometry to output as a plain triangle list.
+    inline void ExpandToTriangleList(const ClippedGeometry& geometry, std::vector<PackedTerrainVertex>& output)
+    {
+        if (!geometry.indexed) {
+            output.insert(output.end(), geometry.vertices.begin(), geometry.vertices.end());
+            return;
+        }
+
+        output.reserve(output.size() + geometry.indices.size());
+        for (const uint16_t index : geometry.indices) {
+            output.push_back(geometry.vertices[index]);
+        }
+    }
+}
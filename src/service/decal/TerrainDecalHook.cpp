@@ -40,8 +40,11 @@ namespace TerrainDecal
               .enableClippedRendering = options.enableCustomRenderer,
               .customDefaultDepthOffset = options.customDefaultDepthOffset,
               .shadowRecoveryOpacityScale = options.shadowRecoveryOpacityScale,
+              .geometryCacheBudgetBytes = options.geometryCacheBudgetBytes,
+              .enableIndexedSubmission = options.enableIndexedSubmission,
           })
     {
+        renderer_.SetTerrainRevisionTracker(&terrainRevisions_);
     }
 
     TerrainDecalHook::~TerrainDecalHook()
@@ -138,6 +141,8 @@ namespace TerrainDecal
         currentTexTransformStage_ = -1;
         shadowRecoveryActive_ = false;
         renderer_.ClearOverlayUvWindows();
+        renderer_.ClearGeometryCache();
+        renderer_.ResetDrawList();
 
         if (sActiveHook_ == this) {
             sActiveHook_ = nullptr;
@@ -182,6 +187,63 @@ namespace TerrainDecal
         renderer_.SetOverlayOverridesResolver(resolver, userData);
     }
 
+    uint32_t TerrainDecalHook::UpdateTerrainRevisions(const uint32_t blockBudget)
+    {
+        if (!addresses_) {
+            return 0;
+        }
+
+        return terrainRevisions_.Update(CaptureTerrainGridView(*addresses_), blockBudget);
+    }
+
+    void TerrainDecalHook::ResetTerrainRevisions() noexcept
+    {
+        terrainRevisions_.Reset();
+    }
+
+    uint64_t TerrainDecalHook::GetTerrainRevision() const noexcept
+    {
+        return terrainRevisions_.GetRevision();
+    }
+
+    uint64_t TerrainDecalHook::GetTerrainRevisionForCells(const int xStart,
+                                                          const int zStart,
+                                                          const int xEnd,
+                                                          const int zEnd) const noexcept
+    {
+        return terrainRevisions_.GetRevisionForCells(xStart, zStart, xEnd, zEnd);
+    }
+
+    void TerrainDecalHook::InvalidateOverlayGeometry(void* const overlayManager, const uint32_t overlayId) noexcept
+    {
+        renderer_.InvalidateOverlayGeometry(overlayManager, overlayId);
+    }
+
+    void TerrainDecalHook::ClearGeometryCache() noexcept
+    {
+        renderer_.ClearGeometryCache();
+    }
+
+    ClippedGeometryCacheStats TerrainDecalHook::GetGeometryCacheStats() const noexcept
+    {
+        return renderer_.GetGeometryCacheStats();
+    }
+
+    TerrainDecalRendererDiagnostics TerrainDecalHook::GetRendererDiagnostics() const noexcept
+    {
+        return renderer_.GetDiagnostics();
+    }
+
+    const TerrainDecalRendererFrameStats& TerrainDecalHook::GetRendererFrameStats() const noexcept
+    {
+        return renderer_.GetFrameStats();
+    }
+
+    void TerrainDecalHook::PublishPendingFrameStats() noexcept
+    {
+        renderer_.PublishPendingFrameStats();
+    }
+
     void __fastcall TerrainDecalHook::DrawRectCallThunk(void* overlayManager,
                                                         void*,
                                                         SC4DrawContext* drawContext,
@@ -298,6 +360,7 @@ namespace TerrainDecal
     {
         CallOriginalOverlayPass_(patch, overlayManager, worldToScreenMatrix, drawContext, decalIds);
         ReplayManagedDecalsAfterShadows_(overlayManager, worldToScreenMatrix, drawContext, decalIds);
+        renderer_.PublishFrameStats();
     }
 
     void TerrainDecalHook::HandleSetTexTransform4Call_(SC4DrawContext* drawContext, const float* matrix, const int stage)
@@ -372,6 +435,12 @@ namespace TerrainDecal
             return;
         }
 
+        // The replay walk only re-submits managed decals the normal pass recorded, so skip it when
+        // there are none. The walk itself stays because DrawDecals binds each overlay's texture.
+        if (!renderer_.HasRecordedDraws(overlayManager)) {
+            return;
+        }
+
         currentTexTransformValid_ = false;
         currentTexTransformStage_ = -1;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -11,6 +12,7 @@
 #include "ClippedTerrainDecalRenderer.h"
 #include "RelativeCallPatch.h"
 #include "TerrainDecalSymbols.h"
+#include "TerrainRevisionTracker.h"
 
 class SC4DrawContext;
 
@@ -26,6 +28,8 @@ namespace TerrainDecal
             // Default custom-rendered decal depth offset, used when a state has depthOffset == -1.
             int customDefaultDepthOffset = 2;
             float shadowRecoveryOpacityScale = 0.25f;
+            size_t geometryCacheBudgetBytes = 0;
+            bool enableIndexedSubmission = false;
         };
 
         explicit TerrainDecalHook(Options options = {});
@@ -42,6 +46,20 @@ namespace TerrainDecal
         void ClearOverlayUvWindows() noexcept;
         [[nodiscard]] bool TryGetOverlayUvWindow(uint32_t overlayId, TerrainDecalUvWindow& uvWindow) const noexcept;
         void SetOverlayOverridesResolver(OverlayOverridesResolver resolver, void* userData) noexcept;
+        // Hashes up to blockBudget terrain blocks (0 = all) and returns how many changed height. Cached
+        // decal geometry over a changed block is rebuilt on its next draw.
+        uint32_t UpdateTerrainRevisions(uint32_t blockBudget);
+        void ResetTerrainRevisions() noexcept;
+        [[nodiscard]] uint64_t GetTerrainRevision() const noexcept;
+        [[nodiscard]] uint64_t GetTerrainRevisionForCells(int xStart, int zStart, int xEnd, int zEnd) const noexcept;
+        void InvalidateOverlayGeometry(void* overlayManager, uint32_t overlayId) noexcept;
+        void ClearGeometryCache() noexcept;
+        [[nodiscard]] ClippedGeometryCacheStats GetGeometryCacheStats() const noexcept;
+        [[nodiscard]] TerrainDecalRendererDiagnostics GetRendererDiagnostics() const noexcept;
+        [[nodiscard]] const TerrainDecalRendererFrameStats& GetRendererFrameStats() const noexcept;
+        // The shadow pass closes each frame's stats. This closes a frame that drew decals but never
+        // reached the shadow pass, e.g. with shadows turned off.
+        void PublishPendingFrameStats() noexcept;
 
     private:
         using DrawRectFn = void(__thiscall*)(void*, SC4DrawContext*, const cRZRect*);
@@ -69,6 +87,7 @@ namespace TerrainDecal
         RelativeCallPatch drawShadowsCallSitePatch_;
         RelativeCallPatch drawShadowsRoughCallSitePatch_;
         RelativeCallPatch setTexTransformCallSitePatch_;
+        TerrainRevisionTracker terrainRevisions_{};
         ClippedTerrainDecalRenderer renderer_;
         std::string lastError_{};
         std::array<float, 16> currentTexTransform_{};
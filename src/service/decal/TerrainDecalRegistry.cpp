@@ -1,41 +1,137 @@
 #include "TerrainDecalRegistry.h"
 
+#include <algorithm>
+#include <utility>
+
 void TerrainDecalRegistry::Clear() noexcept
 {
     records_.clear();
-    nextId_ = 1;
+    slots_.clear();
+    freeSlots_.clear();
+    overflowRecords_.clear();
+    nextSlot_ = 1;
+}
+
+void TerrainDecalRegistry::Reserve(const uint32_t recordCount)
+{
+    records_.reserve(recordCount);
+    slots_.reserve(std::min<size_t>(static_cast<size_t>(nextSlot_) + recordCount, static_cast<size_t>(kSlotMask) + 1));
 }
 
-TerrainDecalId TerrainDecalRegistry::AllocateId() noexcept
+TerrainDecalId TerrainDecalRegistry::AllocateId()
 {
-    return TerrainDecalId{nextId_++};
+    while (!freeSlots_.empty()) {
+        const uint32_t slotIndex = freeSlots_.back();
+        freeSlots_.pop_back();
+
+        // Loaded ids can occupy a slot that is still on the free list; skip those entries.
+        Slot& slot = slots_[slotIndex];
+        const TerrainDecalId id = MakeId(slotIndex, slot.generation);
+        if (slot.recordIndex != kVacant || id.value == 0 || overflowRecords_.contains(id.value)) {
+            continue;
+        }
+
+        slot.recordIndex = kReserved;
+        return id;
+    }
+
+    // Slot 0 is never handed out fresh so that generation 0 cannot produce id 0.
+    while (nextSlot_ <= kSlotMask) {
+        const uint32_t slotIndex = nextSlot_++;
+        EnsureSlot_(slotIndex);
+        Slot& slot = slots_[slotIndex];
+        if (slot.recordIndex != kVacant) {
+            continue;
+        }
+
+        slot.recordIndex = kReserved;
+        return MakeId(slotIndex, slot.generation);
+    }
+
+    return TerrainDecalId{};
+}
+
+void TerrainDecalRegistry::ReleaseId(const TerrainDecalId id) noexcept
+{
+    const uint32_t slotIndex = SlotIndexOf(id);
+    if (id.value == 0 || slotIndex >= slots_.size()) {
+        return;
+    }
+
+    Slot& slot = slots_[slotIndex];
+    if (slot.recordIndex == kReserved && slot.generation == GenerationOf(id)) {
+        slot.recordIndex = kVacant;
+        freeSlots_.push_back(slotIndex);
+    }
 }
 
 bool TerrainDecalRegistry::Insert(TerrainDecalRecord&& record)
 {
-    if (record.id.value == 0) {
+    if (record.id.value == 0 || FindRecordIndex_(record.id) != kVacant) {
         return false;
     }
 
-    auto [it, inserted] = records_.emplace(record.id.value, std::move(record));
-    return inserted && it != records_.end();
+    const uint32_t slotIndex = SlotIndexOf(record.id);
+    const uint32_t generation = GenerationOf(record.id);
+    const auto recordIndex = static_cast<uint32_t>(records_.size());
+    EnsureSlot_(slotIndex);
+
+    Slot& slot = slots_[slotIndex];
+    const bool slotAvailable = slot.recordIndex == kVacant ||
+                               (slot.recordIndex == kReserved && slot.generation == generation);
+    if (slotAvailable) {
+        slot.generation = generation;
+        slot.recordIndex = recordIndex;
+    }
+    else {
+        overflowRecords_.emplace(record.id.value, recordIndex);
+    }
+
+    records_.push_back(std::move(record));
+    return true;
 }
 
 bool TerrainDecalRegistry::Remove(const TerrainDecalId id)
 {
-    return records_.erase(id.value) > 0;
+    const uint32_t recordIndex = FindRecordIndex_(id);
+    if (recordIndex == kVacant) {
+        return false;
+    }
+
+    const auto overflowIt = overflowRecords_.find(id.value);
+    if (overflowIt != overflowRecords_.end()) {
+        overflowRecords_.erase(overflowIt);
+    }
+    else {
+        const uint32_t slotIndex = SlotIndexOf(id);
+        Slot& slot = slots_[slotIndex];
+        slot.recordIndex = kVacant;
+        // A slot whose generation would wrap is retired so its old ids can never come back.
+        if (slot.generation < kMaxGeneration) {
+            ++slot.generation;
+            freeSlots_.push_back(slotIndex);
+        }
+    }
+
+    const auto lastIndex = static_cast<uint32_t>(records_.size() - 1);
+    if (recordIndex != lastIndex) {
+        records_[recordIndex] = std::move(records_[lastIndex]);
+        SetRecordIndex_(records_[recordIndex].id, recordIndex);
+    }
+    records_.pop_back();
+    return true;
 }
 
 TerrainDecalRecord* TerrainDecalRegistry::Find(const TerrainDecalId id) noexcept
 {
-    const auto it = records_.find(id.value);
-    return it != records_.end() ? &it->second : nullptr;
+    const uint32_t recordIndex = FindRecordIndex_(id);
+    return recordIndex != kVacant ? &records_[recordIndex] : nullptr;
 }
 
 const TerrainDecalRecord* TerrainDecalRegistry::Find(const TerrainDecalId id) const noexcept
 {
-    const auto it = records_.find(id.value);
-    return it != records_.end() ? &it->second : nullptr;
+    const uint32_t recordIndex = FindRecordIndex_(id);
+    return recordIndex != kVacant ? &records_[recordIndex] : nullptr;
 }
 
 uint32_t TerrainDecalRegistry::GetCount() const noexcept
@@ -43,14 +139,80 @@ uint32_t TerrainDecalRegistry::GetCount() const noexcept
     return static_cast<uint32_t>(records_.size());
 }
 
-void TerrainDecalRegistry::UpdateNextIdFromLoaded(const TerrainDecalId loadedId) noexcept
+void TerrainDecalRegistry::UpdateNextIdFromLoaded(const TerrainDecalId loadedId)
 {
-    if (loadedId.value >= nextId_) {
-        nextId_ = loadedId.value + 1;
+    if (loadedId.value == 0) {
+        return;
+    }
+
+    const uint32_t slotIndex = SlotIndexOf(loadedId);
+    if (slotIndex >= nextSlot_) {
+        nextSlot_ = slotIndex + 1;
+    }
+
+    EnsureSlot_(slotIndex);
+    Slot& slot = slots_[slotIndex];
+    if (slot.recordIndex == kVacant && slot.generation < GenerationOf(loadedId)) {
+        slot.generation = GenerationOf(loadedId);
     }
 }
 
-const std::map<uint32_t, TerrainDecalRecord>& TerrainDecalRegistry::Records() const noexcept
+std::span<const TerrainDecalRecord> TerrainDecalRegistry::Records() const noexcept
 {
     return records_;
 }
+
+uint32_t TerrainDecalRegistry::SlotIndexOf(const TerrainDecalId id) noexcept
+{
+    return id.value & kSlotMask;
+}
+
+uint32_t TerrainDecalRegistry::GenerationOf(const TerrainDecalId id) noexcept
+{
+    return id.value >> kSlotBits;
+}
+
+TerrainDecalId TerrainDecalRegistry::MakeId(const uint32_t slotIndex, const uint32_t generation) noexcept
+{
+    return TerrainDecalId{(generation << kSlotBits) | slotIndex};
+}
+
+uint32_t TerrainDecalRegistry::FindRecordIndex_(const TerrainDecalId id) const noexcept
+{
+    if (id.value == 0) {
+        return kVacant;
+    }
+
+    const uint32_t slotIndex = SlotIndexOf(id);
+    if (slotIndex < slots_.size()) {
+        const Slot& slot = slots_[slotIndex];
+        if (slot.generation == GenerationOf(id) && slot.recordIndex < records_.size()) {
+            return slot.recordIndex;
+        }
+    }
+
+    if (overflowRecords_.empty()) {
+        return kVacant;
+    }
+
+    const auto it = overflowRecords_.find(id.value);
+    return it != overflowRecords_.end() ? it->second : kVacant;
+}
+
+void TerrainDecalRegistry::EnsureSlot_(const uint32_t slotIndex)
+{
+    if (slotIndex >= slots_.size()) {
+        slots_.resize(static_cast<size_t>(slotIndex) + 1);
+    }
+}
+
+void TerrainDecalRegistry::SetRecordIndex_(const TerrainDecalId id, const uint32_t recordIndex) noexcept
+{
+    const auto overflowIt = overflowRecords_.find(id.value);
+    if (overflowIt != overflowRecords_.end()) {
+        overflowIt->second = recordIndex;
+        return;
+    }
+
+    slots_[SlotIndexOf(id)].recordIndex = recordIndex;
+}
@@ -1,13 +1,17 @@
 #pragma once
 
-#include <map>
 #include <optional>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 #include "public/cIGZTerrainDecalService.h"
 
+class cISTEOverlayManager;
+
 struct TerrainDecalRuntimeAttachment {
     std::optional<uint32_t> overlayId;
+    cISTEOverlayManager* overlayManager = nullptr;
 };
 
 struct TerrainDecalRecord {
@@ -16,11 +20,23 @@ struct TerrainDecalRecord {
     TerrainDecalRuntimeAttachment runtime{};
 };
 
+// Generational slot map. A TerrainDecalId packs a slot index in its low kSlotBits bits and the slot
+// generation above them, so sequential ids from older saves decode to generation 0. Records live in
+// one contiguous array; removal swaps the last record into the hole, so record pointers are only
+// valid until the next Insert or Remove.
 class TerrainDecalRegistry {
 public:
+    static constexpr uint32_t kSlotBits = 20;
+    static constexpr uint32_t kSlotMask = (1u << kSlotBits) - 1u;
+    static constexpr uint32_t kMaxGeneration = 0xFFFFFFFFu >> kSlotBits;
+
     void Clear() noexcept;
+    void Reserve(uint32_t recordCount);
 
-    [[nodiscard]] TerrainDecalId AllocateId() noexcept;
+    // Reserves a slot and returns its id, or id 0 once every slot is in use. Hand the reservation back
+    // with ReleaseId if the record is never inserted.
+    [[nodiscard]] TerrainDecalId AllocateId();
+    void ReleaseId(TerrainDecalId id) noexcept;
     bool Insert(TerrainDecalRecord&& record);
     bool Remove(TerrainDecalId id);
 
@@ -29,11 +45,33 @@ public:
 
     [[nodiscard]] uint32_t GetCount() const noexcept;
 
-    void UpdateNextIdFromLoaded(TerrainDecalId loadedId) noexcept;
+    // Keeps freshly allocated ids clear of an id restored from a save.
+    void UpdateNextIdFromLoaded(TerrainDecalId loadedId);
 
-    [[nodiscard]] const std::map<uint32_t, TerrainDecalRecord>& Records() const noexcept;
+    [[nodiscard]] std::span<const TerrainDecalRecord> Records() const noexcept;
 
 private:
-    std::map<uint32_t, TerrainDecalRecord> records_{};
-    uint32_t nextId_ = 1;
+    static constexpr uint32_t kVacant = 0xFFFFFFFFu;
+    static constexpr uint32_t kReserved = 0xFFFFFFFEu;
+
+    struct Slot {
+        uint32_t generation = 0;
+        // Index into records_, or kVacant/kReserved.
+        uint32_t recordIndex = kVacant;
+    };
+
+    [[nodiscard]] static uint32_t SlotIndexOf(TerrainDecalId id) noexcept;
+    [[nodiscard]] static uint32_t GenerationOf(TerrainDecalId id) noexcept;
+    [[nodiscard]] static TerrainDecalId MakeId(uint32_t slotIndex, uint32_t generation) noexcept;
+    [[nodiscard]] uint32_t FindRecordIndex_(TerrainDecalId id) const noexcept;
+    void EnsureSlot_(uint32_t slotIndex);
+    void SetRecordIndex_(TerrainDecalId id, uint32_t recordIndex) noexcept;
+
+    std::vector<TerrainDecalRecord> records_{};
+    std::vector<Slot> slots_{};
+    std::vector<uint32_t> freeSlots_{};
+    // Loaded ids whose slot is already held by another generation. Only old saves that wrapped the
+    // 20-bit slot range can produce these.
+    std::unordered_map<uint32_t, uint32_t> overflowRecords_{};
+    uint32_t nextSlot_ = 1;
 };
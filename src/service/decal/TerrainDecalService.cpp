@@ -1,8 +1,11 @@
 #include "TerrainDecalService.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <limits>
 #include "GZServPtrs.h"
 #include "cIGZMessage2.h"
 #include "cIGZMessage2Standard.h"
@@ -15,6 +18,7 @@
 #include "cISTEOverlayManager.h"
 #include "cISTETerrain.h"
 #include "cISTETerrainView.h"
+#include "public/cIGZS3DCameraService.h"
 #include "utils/Logger.h"
 #include "TerrainDecalSidecarCodec.h"
 
@@ -25,6 +29,13 @@ namespace
     constexpr uint32_t kSC4MessageLoad = 0x26C63341;
     constexpr uint32_t kSC4MessageSave = 0x26C63344;
     constexpr uint32_t kInvalidOverlayId = 0xFFFFFFFFu;
+    // The rebind loop reads the clock once per this many decals.
+    constexpr uint32_t kRebindClockStride = 8;
+    // Stand-in for terrain height when projecting the view ray onto the ground: SC4's default sea level.
+    constexpr float kViewFocusGroundHeight = 250.0f;
+    // A 1024-cell city has 4096 terrain revision blocks, so every block is rehashed within 16 ticks.
+    constexpr uint32_t kTerrainRevisionBlocksPerTick = 256;
+    constexpr float kTerrainCellSize = 16.0f;
 
     [[nodiscard]] uint32_t NormalizeOverlayIdKey(const uint32_t overlayId) noexcept
     {
@@ -47,6 +58,82 @@ namespace
         return state;
     }
 
+    [[nodiscard]] bool RequiresRuntimeRecreate(const TerrainDecalState& current, const TerrainDecalState& next) noexcept
+    {
+        return current.overlayType != next.overlayType ||
+               current.textureKey.type != next.textureKey.type ||
+               current.textureKey.group != next.textureKey.group ||
+               current.textureKey.instance != next.textureKey.instance;
+    }
+
+    [[nodiscard]] uint32_t DiffDecalStates(const TerrainDecalState& current, const TerrainDecalState& next) noexcept
+    {
+        uint32_t changed = 0;
+        if (std::memcmp(&current.decalInfo.center, &next.decalInfo.center, sizeof(next.decalInfo.center)) != 0) {
+            changed |= kTerrainDecalFieldCenter;
+        }
+
+        // Compare everything but the center so a drag stays a MoveDecal.
+        auto currentInfo = current.decalInfo;
+        currentInfo.center = next.decalInfo.center;
+        if (std::memcmp(&currentInfo, &next.decalInfo, sizeof(currentInfo)) != 0) {
+            changed |= kTerrainDecalFieldDecalInfo;
+        }
+
+        if (current.opacity != next.opacity) {
+            changed |= kTerrainDecalFieldOpacity;
+        }
+        if (current.enabled != next.enabled) {
+            changed |= kTerrainDecalFieldEnabled;
+        }
+        if (std::memcmp(&current.color, &next.color, sizeof(next.color)) != 0) {
+            changed |= kTerrainDecalFieldColor;
+        }
+        if (current.drawMode != next.drawMode) {
+            changed |= kTerrainDecalFieldDrawMode;
+        }
+        if (current.hasUvWindow != next.hasUvWindow ||
+            (next.hasUvWindow &&
+             (current.uvWindow.u1 != next.uvWindow.u1 || current.uvWindow.v1 != next.uvWindow.v1 ||
+              current.uvWindow.u2 != next.uvWindow.u2 || current.uvWindow.v2 != next.uvWindow.v2 ||
+              current.uvWindow.mode != next.uvWindow.mode))) {
+            changed |= kTerrainDecalFieldUvWindow;
+        }
+        if (current.depthOffset != next.depthOffset) {
+            changed |= kTerrainDecalFieldDepthOffset;
+        }
+        return changed;
+    }
+
+    void MergeMaskedFields(TerrainDecalState& target, const TerrainDecalState& source, const uint32_t fieldMask) noexcept
+    {
+        if ((fieldMask & kTerrainDecalFieldDecalInfo) != 0) {
+            target.decalInfo = source.decalInfo;
+        }
+        else if ((fieldMask & kTerrainDecalFieldCenter) != 0) {
+            target.decalInfo.center = source.decalInfo.center;
+        }
+        if ((fieldMask & kTerrainDecalFieldOpacity) != 0) {
+            target.opacity = source.opacity;
+        }
+        if ((fieldMask & kTerrainDecalFieldEnabled) != 0) {
+            target.enabled = source.enabled;
+        }
+        if ((fieldMask & kTerrainDecalFieldColor) != 0) {
+            target.color = source.color;
+        }
+        if ((fieldMask & kTerrainDecalFieldDrawMode) != 0) {
+            target.drawMode = source.drawMode;
+        }
+        if ((fieldMask & kTerrainDecalFieldUvWindow) != 0) {
+            target.hasUvWindow = source.hasUvWindow;
+            target.uvWindow = source.uvWindow;
+        }
+        if ((fieldMask & kTerrainDecalFieldDepthOffset) != 0) {
+            target.depthOffset = source.depthOffset;
+        }
+    }
+
     bool CopySnapshotToCaller(const TerrainDecalSnapshot& snapshot,
                               TerrainDecalSnapshot* const destination,
                               const uint32_t destinationSize) noexcept
@@ -89,6 +176,12 @@ bool TerrainDecalService::QueryInterface(const uint32_t riid, void** ppvObj)
         return true;
     }
 
+    if (riid == GZIID_cIGZTerrainDecalService2) {
+        *ppvObj = static_cast<cIGZTerrainDecalService2*>(this);
+        AddRef();
+        return true;
+    }
+
     return cRZBaseSystemService::QueryInterface(riid, ppvObj);
 }
 
@@ -122,8 +215,24 @@ bool TerrainDecalService::CreateDecal(const TerrainDecalState* const initialStat
         return false;
     }
 
+    RuntimeContext context{};
+    if (!TryBeginRuntimeContext_(context)) {
+        LOG_WARN("TerrainDecalService: no active city for decal creation");
+        return false;
+    }
+
     const TerrainDecalId id = registry_.AllocateId();
-    if (!CreateRuntimeDecal_(id, state, false)) {
+    if (id.value == 0) {
+        LOG_WARN("TerrainDecalService: CreateDecal failed, decal id space exhausted");
+        return false;
+    }
+
+    const TerrainDecalBatchResult result = CreateRuntimeDecal_(context, id, state, false);
+    if (result != TerrainDecalBatchResult::Ok) {
+        if (result == TerrainDecalBatchResult::NoOverlayManager) {
+            LOG_WARN("TerrainDecalService: no active overlay manager for decal creation");
+        }
+        registry_.ReleaseId(id);
         return false;
     }
 
@@ -137,7 +246,9 @@ bool TerrainDecalService::RemoveDecal(const TerrainDecalId id)
         return false;
     }
 
-    return RemoveRuntimeDecal_(id, true);
+    RuntimeContext context{};
+    (void)TryBeginRuntimeContext_(context);
+    return RemoveRuntimeDecal_(context, id, true);
 }
 
 bool TerrainDecalService::GetDecal(const TerrainDecalId id,
@@ -178,7 +289,12 @@ bool TerrainDecalService::ReplaceDecal(const TerrainDecalId id,
         return false;
     }
 
-    return ApplyStateToRuntime_(*record, validated);
+    RuntimeContext context{};
+    if (!TryBeginRuntimeContext_(context)) {
+        return false;
+    }
+
+    return ApplyStateToRuntime_(context, *record, validated) == TerrainDecalBatchResult::Ok;
 }
 
 uint32_t TerrainDecalService::GetDecalCount() const
@@ -196,13 +312,13 @@ uint32_t TerrainDecalService::CopyDecals(TerrainDecalSnapshot* const buffer,
 
     uint32_t count = 0;
     auto* const bytes = reinterpret_cast<std::byte*>(buffer);
-    for (const auto& [id, record] : registry_.Records()) {
+    for (const TerrainDecalRecord& record : registry_.Records()) {
         if (count >= capacity) {
             break;
         }
 
         auto* const destination = reinterpret_cast<TerrainDecalSnapshot*>(bytes + (snapshotSize * count));
-        if (!CopySnapshotToCaller(TerrainDecalSnapshot{.id = TerrainDecalId{id}, .state = record.state},
+        if (!CopySnapshotToCaller(TerrainDecalSnapshot{.id = record.id, .state = record.state},
                                   destination,
                                   snapshotSize)) {
             break;
@@ -213,14 +329,312 @@ uint32_t TerrainDecalService::CopyDecals(TerrainDecalSnapshot* const buffer,
     return count;
 }
 
+uint32_t TerrainDecalService::CreateDecals(const TerrainDecalState* const initialStates,
+                                           const uint32_t count,
+                                           const uint32_t stateSize,
+                                           TerrainDecalId* const outIds,
+                                           TerrainDecalBatchResult* const outResults)
+{
+    if (!initialStates || !outIds || count == 0 || stateSize < kTerrainDecalStateSize) {
+        return 0;
+    }
+
+    const auto setResult = [outResults](const uint32_t index, const TerrainDecalBatchResult result) {
+        if (outResults) {
+            outResults[index] = result;
+        }
+    };
+
+    RuntimeContext context{};
+    const bool hasCity = TryBeginRuntimeContext_(context);
+    if (hasCity) {
+        registry_.Reserve(registry_.GetCount() + count);
+        overlayIndex_.reserve(overlayIndex_.size() + count);
+    }
+
+    const auto* const bytes = reinterpret_cast<const std::byte*>(initialStates);
+    std::string error;
+    uint32_t created = 0;
+    uint32_t validationFailures = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        outIds[i] = TerrainDecalId{};
+        if (!hasCity) {
+            setResult(i, TerrainDecalBatchResult::NoCity);
+            continue;
+        }
+
+        TerrainDecalState state = CopyStateFromCaller(
+            reinterpret_cast<const TerrainDecalState*>(bytes + static_cast<size_t>(stateSize) * i),
+            stateSize);
+        if (!ValidateState_(state, error)) {
+            ++validationFailures;
+            setResult(i, TerrainDecalBatchResult::ValidationFailed);
+            continue;
+        }
+
+        const TerrainDecalId id = registry_.AllocateId();
+        if (id.value == 0) {
+            setResult(i, TerrainDecalBatchResult::RuntimeFailed);
+            continue;
+        }
+
+        const TerrainDecalBatchResult result = CreateRuntimeDecal_(context, id, state, false);
+        if (result != TerrainDecalBatchResult::Ok) {
+            registry_.ReleaseId(id);
+            setResult(i, result);
+            continue;
+        }
+
+        outIds[i] = id;
+        setResult(i, TerrainDecalBatchResult::Ok);
+        ++created;
+    }
+
+    if (!hasCity) {
+        LOG_WARN("TerrainDecalService: no active city for batch creation of {} decals", count);
+    }
+    else if (created != count) {
+        LOG_WARN("TerrainDecalService: CreateDecals created {} of {} decals ({} failed validation, last error: {})",
+                 created,
+                 count,
+                 validationFailures,
+                 validationFailures > 0 ? error : std::string("none"));
+    }
+    return created;
+}
+
+uint32_t TerrainDecalService::RemoveDecals(const TerrainDecalId* const ids,
+                                           const uint32_t count,
+                                           TerrainDecalBatchResult* const outResults)
+{
+    if (!ids || count == 0) {
+        return 0;
+    }
+
+    RuntimeContext context{};
+    (void)TryBeginRuntimeContext_(context);
+
+    uint32_t removed = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const bool ok = ids[i].value != 0 && RemoveRuntimeDecal_(context, ids[i], true);
+        if (outResults) {
+            outResults[i] = ok ? TerrainDecalBatchResult::Ok : TerrainDecalBatchResult::NotFound;
+        }
+        removed += ok ? 1u : 0u;
+    }
+
+    return removed;
+}
+
+uint32_t TerrainDecalService::ReplaceDecals(const TerrainDecalId* const ids,
+                                            const TerrainDecalState* const newStates,
+                                            const uint32_t count,
+                                            const uint32_t stateSize,
+                                            TerrainDecalBatchResult* const outResults)
+{
+    if (!ids || !newStates || count == 0 || stateSize < kTerrainDecalStateSize) {
+        return 0;
+    }
+
+    const auto setResult = [outResults](const uint32_t index, const TerrainDecalBatchResult result) {
+        if (outResults) {
+            outResults[index] = result;
+        }
+    };
+
+    RuntimeContext context{};
+    const bool hasCity = TryBeginRuntimeContext_(context);
+
+    const auto* const bytes = reinterpret_cast<const std::byte*>(newStates);
+    std::string error;
+    uint32_t replaced = 0;
+    uint32_t validationFailures = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        TerrainDecalRecord* const record = ids[i].value != 0 ? registry_.Find(ids[i]) : nullptr;
+        if (!record) {
+            setResult(i, TerrainDecalBatchResult::NotFound);
+            continue;
+        }
+
+        if (!hasCity) {
+            setResult(i, TerrainDecalBatchResult::NoCity);
+            continue;
+        }
+
+        TerrainDecalState validated = CopyStateFromCaller(
+            reinterpret_cast<const TerrainDecalState*>(bytes + static_cast<size_t>(stateSize) * i),
+            stateSize);
+        if (!ValidateState_(validated, error)) {
+            ++validationFailures;
+            setResult(i, TerrainDecalBatchResult::ValidationFailed);
+            continue;
+        }
+
+        const TerrainDecalBatchResult result = ApplyStateToRuntime_(context, *record, validated);
+        setResult(i, result);
+        replaced += result == TerrainDecalBatchResult::Ok ? 1u : 0u;
+    }
+
+    if (validationFailures > 0) {
+        LOG_WARN("TerrainDecalService: ReplaceDecals rejected {} of {} states, last error: {}",
+                 validationFailures,
+                 count,
+                 error);
+    }
+    return replaced;
+}
+
+bool TerrainDecalService::UpdateDecal(const TerrainDecalId id,
+                                      const TerrainDecalState* const newState,
+                                      const uint32_t stateSize,
+                                      const uint32_t fieldMask)
+{
+    if (!newState || id.value == 0 || stateSize < kTerrainDecalStateSize) {
+        return false;
+    }
+
+    TerrainDecalRecord* const record = registry_.Find(id);
+    if (!record) {
+        return false;
+    }
+
+    TerrainDecalState merged = record->state;
+    MergeMaskedFields(merged, CopyStateFromCaller(newState, stateSize), fieldMask);
+    std::string error;
+    if (!ValidateState_(merged, error)) {
+        LOG_WARN("TerrainDecalService: UpdateDecal validation failed for {}: {}", id.value, error);
+        return false;
+    }
+
+    RuntimeContext context{};
+    if (!TryBeginRuntimeContext_(context)) {
+        return false;
+    }
+
+    return ApplyStateToRuntime_(context, *record, merged) == TerrainDecalBatchResult::Ok;
+}
+
+uint32_t TerrainDecalService::QueryDecalsInRect(const float minX,
+                                                const float minZ,
+                                                const float maxX,
+                                                const float maxZ,
+                                                TerrainDecalId* const outIds,
+                                                const uint32_t capacity) const
+{
+    return spatialIndex_.QueryRect(minX, minZ, maxX, maxZ, outIds, capacity);
+}
+
+uint32_t TerrainDecalService::QueryDecalsAtPoint(const float x,
+                                                 const float z,
+                                                 TerrainDecalId* const outIds,
+                                                 const uint32_t capacity) const
+{
+    return spatialIndex_.QueryPoint(x, z, outIds, capacity);
+}
+
+bool TerrainDecalService::QueryNearestDecal(const float x,
+                                            const float z,
+                                            const float maxDistance,
+                                            TerrainDecalId* const outId) const
+{
+    return outId && spatialIndex_.QueryNearest(x, z, maxDistance, *outId);
+}
+
+uint64_t TerrainDecalService::GetChangeSequence() const
+{
+    return changeJournal_.GetSequence();
+}
+
+TerrainDecalChangesResult TerrainDecalService::GetChangesSince(const uint64_t sequence,
+                                                               TerrainDecalChange* const outChanges,
+                                                               const uint32_t capacity,
+                                                               const uint32_t changeSize,
+                                                               uint32_t* const outCount,
+                                                               uint64_t* const outSequence) const
+{
+    if (!outCount || !outSequence) {
+        return TerrainDecalChangesResult::InvalidArgument;
+    }
+
+    return changeJournal_.ReadSince(sequence, outChanges, capacity, changeSize, *outCount, *outSequence);
+}
+
+bool TerrainDecalService::GetRebindProgress(TerrainDecalRebindProgress* const outProgress,
+                                            const uint32_t progressSize) const
+{
+    if (!outProgress || progressSize == 0) {
+        return false;
+    }
+
+    std::memcpy(outProgress, &rebindProgress_, std::min<size_t>(progressSize, sizeof(TerrainDecalRebindProgress)));
+    return true;
+}
+
+uint64_t TerrainDecalService::GetTerrainRevision() const
+{
+    return renderHook_ ? renderHook_->GetTerrainRevision() : 0;
+}
+
+uint64_t TerrainDecalService::GetTerrainRevisionInRect(const float minX,
+                                                       const float minZ,
+                                                       const float maxX,
+                                                       const float maxZ) const
+{
+    if (!renderHook_) {
+        return 0;
+    }
+    if (!(minX <= maxX) || !(minZ <= maxZ)) {
+        return renderHook_->GetTerrainRevision();
+    }
+
+    const auto toCell = [](const float world) {
+        return static_cast<int>(std::clamp(std::floor(world / kTerrainCellSize), -1.0e6f, 1.0e6f));
+    };
+    return renderHook_->GetTerrainRevisionForCells(toCell(minX), toCell(minZ), toCell(maxX) + 1, toCell(maxZ) + 1);
+}
+
+bool TerrainDecalService::GetRendererDiagnostics(TerrainDecalRendererDiagnostics* const outDiagnostics,
+                                                 const uint32_t diagnosticsSize) const
+{
+    if (!outDiagnostics || diagnosticsSize == 0 || !renderHook_) {
+        return false;
+    }
+
+    const TerrainDecalRendererDiagnostics diagnostics = renderHook_->GetRendererDiagnostics();
+    std::memcpy(outDiagnostics,
+                &diagnostics,
+                std::min<size_t>(diagnosticsSize, sizeof(TerrainDecalRendererDiagnostics)));
+    return true;
+}
+
+bool TerrainDecalService::GetRendererFrameStats(TerrainDecalRendererFrameStats* const outStats,
+                                                const uint32_t statsSize) const
+{
+    if (!outStats || statsSize == 0 || !renderHook_) {
+        return false;
+    }
+
+    const TerrainDecalRendererFrameStats& stats = renderHook_->GetRendererFrameStats();
+    std::memcpy(outStats, &stats, std::min<size_t>(statsSize, sizeof(TerrainDecalRendererFrameStats)));
+    return true;
+}
+
 bool TerrainDecalService::OnTick(const uint32_t unknown1)
 {
     (void)unknown1;
 
-    if (cityLoaded_ && !pendingLoadedDecals_.empty()) {
+    if (cityLoaded_ && HasPendingLoadedDecals_()) {
         RebindLoadedDecals_();
     }
 
+    if (cityLoaded_ && renderHook_) {
+        renderHook_->UpdateTerrainRevisions(kTerrainRevisionBlocksPerTick);
+    }
+
+    if (renderHook_) {
+        renderHook_->PublishPendingFrameStats();
+    }
+
     return true;
 }
 
@@ -239,6 +653,32 @@ void TerrainDecalService::SetShadowRecoveryOpacityScale(const float shadowRecove
     shadowRecoveryOpacityScale_ = shadowRecoveryOpacityScale;
 }
 
+void TerrainDecalService::SetGeometryCacheBudgetKB(const int geometryCacheBudgetKB) noexcept
+{
+    geometryCacheBudgetKB_ = std::max(geometryCacheBudgetKB, 0);
+}
+
+void TerrainDecalService::SetIndexedSubmission(const bool indexedSubmission) noexcept
+{
+    indexedSubmission_ = indexedSubmission;
+}
+
+void TerrainDecalService::SetCompactSidecar(const bool compactSidecar) noexcept
+{
+    compactSidecar_ = compactSidecar;
+}
+
+void TerrainDecalService::SetRebindBudget(const int budgetMs, const int budgetCount) noexcept
+{
+    rebindBudgetMs_ = std::max(budgetMs, 0);
+    rebindBudgetCount_ = std::max(budgetCount, 0);
+}
+
+void TerrainDecalService::SetCameraService(cIGZS3DCameraService* const cameraService) noexcept
+{
+    cameraService_ = cameraService;
+}
+
 bool TerrainDecalService::Init()
 {
     if (versionTag_ != 641) {
@@ -251,6 +691,8 @@ bool TerrainDecalService::Init()
         .enableCustomRenderer = enableCustomRenderer_,
         .customDefaultDepthOffset = customDefaultDepthOffset_,
         .shadowRecoveryOpacityScale = shadowRecoveryOpacityScale_,
+        .geometryCacheBudgetBytes = static_cast<size_t>(geometryCacheBudgetKB_) * 1024u,
+        .enableIndexedSubmission = indexedSubmission_,
     });
 
     if (!renderHook_->Install()) {
@@ -266,7 +708,7 @@ bool TerrainDecalService::Init()
 bool TerrainDecalService::Shutdown()
 {
     ClearRuntimeState_(false);
-    pendingLoadedDecals_.clear();
+    ResetPendingLoadedDecals_();
 
     if (renderHook_) {
         renderHook_->Uninstall();
@@ -302,18 +744,18 @@ bool TerrainDecalService::HandleMessage(cIGZMessage2* const message)
     }
 }
 
-bool TerrainDecalService::CreateRuntimeDecal_(const TerrainDecalId id, const TerrainDecalState& state, const bool updateNextId)
+TerrainDecalBatchResult TerrainDecalService::CreateRuntimeDecal_(RuntimeContext& context,
+                                                                 const TerrainDecalId id,
+                                                                 const TerrainDecalState& state,
+                                                                 const bool updateNextId)
 {
-    cISC4City* city = nullptr;
-    if (!TryGetCurrentCity_(city) || !city) {
-        LOG_WARN("TerrainDecalService: no active city for decal creation");
-        return false;
+    if (!context.city) {
+        return TerrainDecalBatchResult::NoCity;
     }
 
-    cISTEOverlayManager* const overlayManager = ResolveOverlayManager_(city, state.overlayType);
+    cISTEOverlayManager* const overlayManager = ResolveOverlayManager_(context, state.overlayType);
     if (!overlayManager) {
-        LOG_WARN("TerrainDecalService: no active overlay manager for decal creation");
-        return false;
+        return TerrainDecalBatchResult::NoOverlayManager;
     }
 
     const uint32_t overlayId = overlayManager->AddDecal(
@@ -327,7 +769,7 @@ bool TerrainDecalService::CreateRuntimeDecal_(const TerrainDecalId id, const Ter
                  state.textureKey.type,
                  state.textureKey.group,
                  state.textureKey.instance);
-        return false;
+        return TerrainDecalBatchResult::RuntimeFailed;
     }
 
     overlayManager->UpdateDecalInfo(overlayId, state.decalInfo);
@@ -344,6 +786,7 @@ bool TerrainDecalService::CreateRuntimeDecal_(const TerrainDecalId id, const Ter
     record.id = id;
     record.state = state;
     record.runtime.overlayId = overlayId;
+    record.runtime.overlayManager = overlayManager;
 
     if (updateNextId) {
         registry_.UpdateNextIdFromLoaded(id);
@@ -351,31 +794,108 @@ bool TerrainDecalService::CreateRuntimeDecal_(const TerrainDecalId id, const Ter
 
     if (!registry_.Insert(std::move(record))) {
         overlayManager->RemoveOverlay(overlayId);
-        return false;
+        return TerrainDecalBatchResult::RuntimeFailed;
+    }
+
+    if (const TerrainDecalRecord* const inserted = registry_.Find(id)) {
+        IndexOverlay_(*inserted);
+    }
+    spatialIndex_.Update(id, state.decalInfo);
+    changeJournal_.Record(id, TerrainDecalChangeKind::Created);
+    // A rebound loaded decal is saved exactly as it was loaded, so its region stays clean.
+    if (!updateNextId) {
+        sidecarCache_.MarkDirty(state.decalInfo.center);
     }
 
     if (renderHook_ && state.hasUvWindow) {
         renderHook_->SetOverlayUvWindow(overlayId, state.uvWindow);
     }
 
-    return true;
+    return TerrainDecalBatchResult::Ok;
 }
 
-bool TerrainDecalService::ApplyStateToRuntime_(TerrainDecalRecord& record, const TerrainDecalState& state)
+TerrainDecalBatchResult TerrainDecalService::ApplyStateToRuntime_(RuntimeContext& context,
+                                                                  TerrainDecalRecord& record,
+                                                                  const TerrainDecalState& state)
 {
     if (!record.runtime.overlayId.has_value()) {
-        return false;
+        return TerrainDecalBatchResult::RuntimeFailed;
     }
 
-    cISC4City* city = nullptr;
-    if (!TryGetCurrentCity_(city) || !city) {
-        return false;
+    if (!context.city) {
+        return TerrainDecalBatchResult::NoCity;
+    }
+
+    // Only a new texture or overlay manager needs a fresh overlay; everything else has a setter.
+    if (RequiresRuntimeRecreate(record.state, state)) {
+        return RecreateRuntimeDecal_(context, record, state);
     }
 
-    cISTEOverlayManager* const oldOverlayManager = ResolveOverlayManager_(city, record.state.overlayType);
-    cISTEOverlayManager* const newOverlayManager = ResolveOverlayManager_(city, state.overlayType);
+    return UpdateRuntimeDecalInPlace_(context, record, state, DiffDecalStates(record.state, state));
+}
+
+TerrainDecalBatchResult TerrainDecalService::UpdateRuntimeDecalInPlace_(RuntimeContext& context,
+                                                                        TerrainDecalRecord& record,
+                                                                        const TerrainDecalState& state,
+                                                                        const uint32_t changedFields)
+{
+    cISTEOverlayManager* const overlayManager = ResolveOverlayManager_(context, record.state.overlayType);
+    if (!overlayManager) {
+        return TerrainDecalBatchResult::NoOverlayManager;
+    }
+
+    const uint32_t overlayId = *record.runtime.overlayId;
+    if ((changedFields & kTerrainDecalFieldDecalInfo) != 0) {
+        overlayManager->UpdateDecalInfo(overlayId, state.decalInfo);
+        overlayManager->MoveDecal(overlayId, state.decalInfo.center);
+    }
+    else if ((changedFields & kTerrainDecalFieldCenter) != 0) {
+        overlayManager->MoveDecal(overlayId, state.decalInfo.center);
+    }
+    if ((changedFields & kTerrainDecalFieldOpacity) != 0) {
+        overlayManager->SetOverlayAlpha(overlayId, state.opacity);
+    }
+    if ((changedFields & kTerrainDecalFieldEnabled) != 0) {
+        overlayManager->SetOverlayEnabled(overlayId, state.enabled);
+    }
+    if ((changedFields & kTerrainDecalFieldColor) != 0) {
+        overlayManager->SetOverlayColor(overlayId, state.color);
+    }
+    if ((changedFields & kTerrainDecalFieldDrawMode) != 0) {
+        overlayManager->SetOverlayDrawMode(overlayId, state.drawMode);
+    }
+
+    if (renderHook_ && (changedFields & kTerrainDecalFieldUvWindow) != 0) {
+        if (state.hasUvWindow) {
+            renderHook_->SetOverlayUvWindow(overlayId, state.uvWindow);
+        }
+        else {
+            (void)renderHook_->RemoveOverlayUvWindow(overlayId);
+        }
+    }
+
+    if ((changedFields & (kTerrainDecalFieldCenter | kTerrainDecalFieldDecalInfo)) != 0) {
+        spatialIndex_.Update(record.id, state.decalInfo);
+    }
+    if (changedFields != 0) {
+        changeJournal_.Record(record.id, TerrainDecalChangeKind::Replaced);
+        sidecarCache_.MarkDirty(record.state.decalInfo.center);
+        sidecarCache_.MarkDirty(state.decalInfo.center);
+    }
+
+    // depthOffset and the decalInfo modifiers are read from record.state by the override resolver.
+    record.state = state;
+    return TerrainDecalBatchResult::Ok;
+}
+
+TerrainDecalBatchResult TerrainDecalService::RecreateRuntimeDecal_(RuntimeContext& context,
+                                                                   TerrainDecalRecord& record,
+                                                                   const TerrainDecalState& state)
+{
+    cISTEOverlayManager* const oldOverlayManager = ResolveOverlayManager_(context, record.state.overlayType);
+    cISTEOverlayManager* const newOverlayManager = ResolveOverlayManager_(context, state.overlayType);
     if (!oldOverlayManager || !newOverlayManager) {
-        return false;
+        return TerrainDecalBatchResult::NoOverlayManager;
     }
 
     const uint32_t replacementOverlayId = newOverlayManager->AddDecal(
@@ -390,7 +910,7 @@ bool TerrainDecalService::ApplyStateToRuntime_(TerrainDecalRecord& record, const
                  state.textureKey.type,
                  state.textureKey.group,
                  state.textureKey.instance);
-        return false;
+        return TerrainDecalBatchResult::RuntimeFailed;
     }
 
     const uint32_t overlayId = *record.runtime.overlayId;
@@ -406,8 +926,15 @@ bool TerrainDecalService::ApplyStateToRuntime_(TerrainDecalRecord& record, const
 
     oldOverlayManager->RemoveOverlay(overlayId);
 
+    UnindexOverlay_(record);
+    sidecarCache_.MarkDirty(record.state.decalInfo.center);
+    sidecarCache_.MarkDirty(state.decalInfo.center);
     record.state = state;
     record.runtime.overlayId = replacementOverlayId;
+    record.runtime.overlayManager = newOverlayManager;
+    IndexOverlay_(record);
+    spatialIndex_.Update(record.id, state.decalInfo);
+    changeJournal_.Record(record.id, TerrainDecalChangeKind::Replaced);
 
     if (renderHook_) {
         (void)renderHook_->RemoveOverlayUvWindow(overlayId);
@@ -419,49 +946,71 @@ bool TerrainDecalService::ApplyStateToRuntime_(TerrainDecalRecord& record, const
         }
     }
 
-    return true;
+    return TerrainDecalBatchResult::Ok;
 }
 
-bool TerrainDecalService::RemoveRuntimeDecal_(const TerrainDecalId id, const bool removeRuntimeObject)
+bool TerrainDecalService::RemoveRuntimeDecal_(RuntimeContext& context,
+                                              const TerrainDecalId id,
+                                              const bool removeRuntimeObject)
 {
     TerrainDecalRecord* const record = registry_.Find(id);
     if (!record) {
         return false;
     }
 
+    UnindexOverlay_(*record);
+    spatialIndex_.Remove(id);
     if (renderHook_ && record->runtime.overlayId.has_value()) {
         (void)renderHook_->RemoveOverlayUvWindow(*record->runtime.overlayId);
     }
 
-    if (removeRuntimeObject && record->runtime.overlayId.has_value()) {
-        cISC4City* city = nullptr;
-        if (TryGetCurrentCity_(city) && city) {
-            cISTEOverlayManager* const overlayManager = ResolveOverlayManager_(city, record->state.overlayType);
-            if (overlayManager) {
-                overlayManager->RemoveOverlay(*record->runtime.overlayId);
+    if (removeRuntimeObject && record->runtime.overlayId.has_value() && context.city) {
+        cISTEOverlayManager* const overlayManager = ResolveOverlayManager_(context, record->state.overlayType);
+        if (overlayManager) {
+            overlayManager->RemoveOverlay(*record->runtime.overlayId);
+            if (renderHook_) {
+                renderHook_->InvalidateOverlayGeometry(overlayManager, *record->runtime.overlayId);
             }
         }
     }
 
-    return registry_.Remove(id);
+    const cS3DVector2 center = record->state.decalInfo.center;
+    if (!registry_.Remove(id)) {
+        return false;
+    }
+
+    changeJournal_.Record(id, TerrainDecalChangeKind::Removed);
+    sidecarCache_.MarkDirty(center);
+    return true;
 }
 
 void TerrainDecalService::ClearRuntimeState_(const bool removeRuntimeObjects)
 {
     std::vector<TerrainDecalId> ids;
     ids.reserve(registry_.GetCount());
-    for (const auto& [idValue, record] : registry_.Records()) {
-        (void)record;
-        ids.push_back(TerrainDecalId{idValue});
+    for (const TerrainDecalRecord& record : registry_.Records()) {
+        ids.push_back(record.id);
+    }
+
+    RuntimeContext context{};
+    if (removeRuntimeObjects) {
+        (void)TryBeginRuntimeContext_(context);
     }
 
+    // Invalidated first so the removals below do not mark regions one at a time.
+    sidecarCache_.Invalidate();
+
     for (const TerrainDecalId id : ids) {
-        RemoveRuntimeDecal_(id, removeRuntimeObjects);
+        RemoveRuntimeDecal_(context, id, removeRuntimeObjects);
     }
 
     registry_.Clear();
+    overlayIndex_.clear();
+    spatialIndex_.Clear();
+    changeJournal_.Invalidate();
     if (renderHook_) {
         renderHook_->ClearOverlayUvWindows();
+        renderHook_->ClearGeometryCache();
     }
 }
 
@@ -477,12 +1026,15 @@ void TerrainDecalService::OnPreCityShutdown_(cIGZMessage2Standard* msg)
     (void)msg;
     cityLoaded_ = false;
     ClearRuntimeState_(false);
-    pendingLoadedDecals_.clear();
+    ResetPendingLoadedDecals_();
+    if (renderHook_) {
+        renderHook_->ResetTerrainRevisions();
+    }
 }
 
 void TerrainDecalService::OnLoad_(cIGZMessage2Standard* const msg)
 {
-    pendingLoadedDecals_.clear();
+    ResetPendingLoadedDecals_();
     ClearRuntimeState_(false);
 
     cISC4DBSegment* const segment = QuerySegmentFromMessage_(msg);
@@ -506,6 +1058,13 @@ void TerrainDecalService::OnLoad_(cIGZMessage2Standard* const msg)
     }
 
     pendingLoadedDecals_ = result.decals;
+    rebindProgress_.loaded = static_cast<uint32_t>(pendingLoadedDecals_.size());
+    rebindProgress_.pending = rebindProgress_.loaded;
+
+    // Rebinding spans several ticks; keep decals created meanwhile from taking a loaded id.
+    for (const TerrainDecalSnapshot& snapshot : pendingLoadedDecals_) {
+        registry_.UpdateNextIdFromLoaded(snapshot.id);
+    }
 }
 
 void TerrainDecalService::OnSave_(cIGZMessage2Standard* const msg)
@@ -517,13 +1076,21 @@ void TerrainDecalService::OnSave_(cIGZMessage2Standard* const msg)
 
     cIGZPersistDBSegment* const dbSegment = segment->AsIGZPersistDBSegment();
 
+    // Format 1.1 re-encodes every decal on each save. Format 2.0 goes through the region cache, where only
+    // decals in regions changed since the last save are collected and re-encoded.
     std::vector<TerrainDecalSnapshot> snapshots;
-    snapshots.reserve(registry_.GetCount());
-    for (const auto& [id, record] : registry_.Records()) {
-        snapshots.push_back(TerrainDecalSnapshot{.id = TerrainDecalId{id}, .state = record.state});
+    if (!compactSidecar_) {
+        snapshots = CollectSaveSnapshots_(false);
+    }
+    else if (sidecarCache_.HasDirtyRegions()) {
+        const TerrainDecalSidecarCache::SaveStats stats = sidecarCache_.Rebuild(CollectSaveSnapshots_(true));
+        LOG_DEBUG("TerrainDecalService: re-encoded {} decals in {} of {} sidecar regions",
+                  stats.encodedDecals,
+                  stats.encodedRegions,
+                  stats.regions);
     }
 
-    if (snapshots.empty()) {
+    if (compactSidecar_ ? sidecarCache_.IsEmpty() : snapshots.empty()) {
         TerrainDecalSidecar::DeleteRecord(dbSegment);
         segment->Release();
         return;
@@ -535,7 +1102,7 @@ void TerrainDecalService::OnSave_(cIGZMessage2Standard* const msg)
         return;
     }
 
-    const bool ok = TerrainDecalSidecar::Write(*stream, snapshots);
+    const bool ok = compactSidecar_ ? sidecarCache_.Write(*stream) : TerrainDecalSidecar::WriteLegacy(*stream, snapshots);
     segment->CloseOStream(stream);
     segment->Release();
 
@@ -544,6 +1111,34 @@ void TerrainDecalService::OnSave_(cIGZMessage2Standard* const msg)
     }
 }
 
+std::vector<TerrainDecalSnapshot> TerrainDecalService::CollectSaveSnapshots_(const bool dirtyRegionsOnly) const
+{
+    std::vector<TerrainDecalSnapshot> snapshots;
+    if (!dirtyRegionsOnly) {
+        snapshots.reserve(registry_.GetCount());
+    }
+
+    for (const TerrainDecalRecord& record : registry_.Records()) {
+        if (!dirtyRegionsOnly || sidecarCache_.IsDirty(record.state.decalInfo.center)) {
+            snapshots.push_back(TerrainDecalSnapshot{.id = record.id, .state = record.state});
+        }
+    }
+
+    // Loaded decals that are not rebound yet still belong to the city.
+    const auto collectPending = [&](const TerrainDecalSnapshot& snapshot) {
+        if (!dirtyRegionsOnly || sidecarCache_.IsDirty(snapshot.state.decalInfo.center)) {
+            snapshots.push_back(snapshot);
+        }
+    };
+    if (pendingLoadedCursor_ < pendingLoadedDecals_.size()) {
+        std::for_each(pendingLoadedDecals_.begin() + static_cast<std::ptrdiff_t>(pendingLoadedCursor_),
+                      pendingLoadedDecals_.end(),
+                      collectPending);
+    }
+    std::ranges::for_each(retryLoadedDecals_, collectPending);
+    return snapshots;
+}
+
 bool TerrainDecalService::TryGetCurrentCity_(cISC4City*& city) const
 {
     const cISC4AppPtr app;
@@ -563,6 +1158,40 @@ cISTEOverlayManager* TerrainDecalService::ResolveOverlayManager_(cISC4City* cons
     return terrainView ? terrainView->GetOverlayManager(overlayType) : nullptr;
 }
 
+bool TerrainDecalService::TryBeginRuntimeContext_(RuntimeContext& context) const
+{
+    context = RuntimeContext{};
+    return TryGetCurrentCity_(context.city) && context.city;
+}
+
+cISTEOverlayManager* TerrainDecalService::ResolveOverlayManager_(RuntimeContext& context,
+                                                                 const cISTETerrainView::tOverlayManagerType overlayType) const
+{
+    size_t slot = 0;
+    switch (overlayType) {
+    case cISTETerrainView::tOverlayManagerType::StaticLand:
+        slot = 0;
+        break;
+    case cISTETerrainView::tOverlayManagerType::StaticWater:
+        slot = 1;
+        break;
+    case cISTETerrainView::tOverlayManagerType::DynamicLand:
+        slot = 2;
+        break;
+    case cISTETerrainView::tOverlayManagerType::DynamicWater:
+        slot = 3;
+        break;
+    default:
+        return ResolveOverlayManager_(context.city, overlayType);
+    }
+
+    if (!context.overlayManagersResolved[slot]) {
+        context.overlayManagers[slot] = ResolveOverlayManager_(context.city, overlayType);
+        context.overlayManagersResolved[slot] = true;
+    }
+    return context.overlayManagers[slot];
+}
+
 bool TerrainDecalService::CaptureLiveState_(const TerrainDecalRecord& record, TerrainDecalState& state) const
 {
     if (!record.runtime.overlayId.has_value()) {
@@ -638,41 +1267,169 @@ bool TerrainDecalService::ValidateState_(TerrainDecalState& state, std::string&
 
 void TerrainDecalService::RebindLoadedDecals_()
 {
-    if (pendingLoadedDecals_.empty()) {
+    if (!HasPendingLoadedDecals_()) {
         return;
     }
 
-    cISC4City* city = nullptr;
-    if (!TryGetCurrentCity_(city) || !city) {
+    RuntimeContext context{};
+    if (!TryBeginRuntimeContext_(context)) {
         return;
     }
 
-    std::vector<TerrainDecalSnapshot> pending = std::move(pendingLoadedDecals_);
-    std::vector<TerrainDecalSnapshot> remaining;
-    remaining.reserve(pending.size());
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(rebindBudgetMs_);
+
+    if (!pendingLoadedOrdered_) {
+        OrderPendingLoadedDecals_();
+        pendingLoadedOrdered_ = true;
+    }
+
+    // Failed decals are retried once per pass, not in the same tick they failed.
+    if (pendingLoadedCursor_ >= pendingLoadedDecals_.size()) {
+        pendingLoadedDecals_ = std::move(retryLoadedDecals_);
+        retryLoadedDecals_.clear();
+        pendingLoadedCursor_ = 0;
+    }
+
+    uint32_t attempted = 0;
+    while (pendingLoadedCursor_ < pendingLoadedDecals_.size()) {
+        if (rebindBudgetCount_ > 0 && attempted >= static_cast<uint32_t>(rebindBudgetCount_)) {
+            break;
+        }
+        if (rebindBudgetMs_ > 0 && attempted > 0 && attempted % kRebindClockStride == 0 &&
+            std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+
+        const TerrainDecalSnapshot& snapshot = pendingLoadedDecals_[pendingLoadedCursor_++];
+        ++attempted;
 
-    for (const TerrainDecalSnapshot& snapshot : pending) {
         if (snapshot.id.value == 0) {
+            sidecarCache_.MarkDirty(snapshot.state.decalInfo.center);
             continue;
         }
 
         if (registry_.Find(snapshot.id)) {
             LOG_WARN("TerrainDecalService: duplicate loaded decal id {}", snapshot.id.value);
+            sidecarCache_.MarkDirty(snapshot.state.decalInfo.center);
             continue;
         }
 
-        if (!ResolveOverlayManager_(city, snapshot.state.overlayType)) {
-            remaining.push_back(snapshot);
+        if (!ResolveOverlayManager_(context, snapshot.state.overlayType)) {
+            retryLoadedDecals_.push_back(snapshot);
+            ++rebindProgress_.retries;
             continue;
         }
 
-        if (!CreateRuntimeDecal_(snapshot.id, snapshot.state, true)) {
+        if (CreateRuntimeDecal_(context, snapshot.id, snapshot.state, true) != TerrainDecalBatchResult::Ok) {
             LOG_WARN("TerrainDecalService: failed to recreate decal {}", snapshot.id.value);
-            remaining.push_back(snapshot);
+            retryLoadedDecals_.push_back(snapshot);
+            ++rebindProgress_.retries;
+            continue;
         }
+
+        ++rebindProgress_.rebound;
+    }
+
+    ++rebindProgress_.ticks;
+    rebindProgress_.elapsedMs +=
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    rebindProgress_.pending = static_cast<uint32_t>(pendingLoadedDecals_.size() - pendingLoadedCursor_ +
+                                                    retryLoadedDecals_.size());
+
+    if (pendingLoadedCursor_ >= pendingLoadedDecals_.size() && retryLoadedDecals_.empty()) {
+        LOG_INFO("TerrainDecalService: rebound {} of {} loaded decals over {} ticks ({:.1f} ms)",
+                 rebindProgress_.rebound,
+                 rebindProgress_.loaded,
+                 rebindProgress_.ticks,
+                 rebindProgress_.elapsedMs);
+        // Keep the progress readable until the next load or shutdown.
+        ClearLoadedDecalQueue_();
     }
+}
+
+void TerrainDecalService::ResetPendingLoadedDecals_() noexcept
+{
+    ClearLoadedDecalQueue_();
+    rebindProgress_ = {};
+}
+
+void TerrainDecalService::ClearLoadedDecalQueue_() noexcept
+{
+    pendingLoadedDecals_.clear();
+    retryLoadedDecals_.clear();
+    pendingLoadedCursor_ = 0;
+    pendingLoadedOrdered_ = false;
+}
 
-    pendingLoadedDecals_ = std::move(remaining);
+bool TerrainDecalService::HasPendingLoadedDecals_() const noexcept
+{
+    return pendingLoadedCursor_ < pendingLoadedDecals_.size() || !retryLoadedDecals_.empty();
+}
+
+void TerrainDecalService::OrderPendingLoadedDecals_()
+{
+    float focusX = 0.0f;
+    float focusZ = 0.0f;
+    if (pendingLoadedDecals_.size() - pendingLoadedCursor_ < 2 || !TryGetViewFocus_(focusX, focusZ)) {
+        return;
+    }
+
+    // Sort small keys and permute once; the snapshots themselves are large.
+    struct OrderKey {
+        float distanceSq;
+        uint32_t index;
+    };
+
+    std::vector<OrderKey> keys;
+    keys.reserve(pendingLoadedDecals_.size() - pendingLoadedCursor_);
+    for (size_t i = pendingLoadedCursor_; i < pendingLoadedDecals_.size(); ++i) {
+        const cS3DVector2& center = pendingLoadedDecals_[i].state.decalInfo.center;
+        const float dx = center.fX - focusX;
+        const float dz = center.fY - focusZ;
+        const float distanceSq = dx * dx + dz * dz;
+        keys.push_back(OrderKey{std::isfinite(distanceSq) ? distanceSq : std::numeric_limits<float>::max(), static_cast<uint32_t>(i)});
+    }
+
+    std::ranges::sort(keys, [](const OrderKey& lhs, const OrderKey& rhs) {
+        return lhs.distanceSq != rhs.distanceSq ? lhs.distanceSq < rhs.distanceSq : lhs.index < rhs.index;
+    });
+
+    std::vector<TerrainDecalSnapshot> ordered;
+    ordered.reserve(keys.size());
+    for (const OrderKey& key : keys) {
+        ordered.push_back(pendingLoadedDecals_[key.index]);
+    }
+
+    pendingLoadedDecals_ = std::move(ordered);
+    pendingLoadedCursor_ = 0;
+}
+
+bool TerrainDecalService::TryGetViewFocus_(float& x, float& z) const
+{
+    if (!cameraService_) {
+        return false;
+    }
+
+    const S3DCameraHandle camera = cameraService_->WrapActiveRendererCamera();
+    if (!camera.ptr) {
+        return false;
+    }
+
+    cS3DVector3 position{};
+    cS3DVector3 lookAt{};
+    cameraService_->GetPosition(camera, position);
+    cameraService_->GetLookAt(camera, lookAt);
+
+    // Follow the view direction down to the ground; a level view falls back to the camera position.
+    float distance = 0.0f;
+    if (lookAt.fY < -1.0e-3f) {
+        distance = std::max((position.fY - kViewFocusGroundHeight) / -lookAt.fY, 0.0f);
+    }
+
+    x = position.fX + lookAt.fX * distance;
+    z = position.fZ + lookAt.fZ * distance;
+    return std::isfinite(x) && std::isfinite(z);
 }
 
 bool TerrainDecalService::ResolveOverlayOverrides_(void* const overlayManager,
@@ -709,11 +1466,6 @@ bool TerrainDecalService::ResolveOverlayOverridesImpl_(cISTEOverlayManager* cons
         return false;
     }
 
-    cISC4City* city = nullptr;
-    if (!TryGetCurrentCity_(city) || !city) {
-        return false;
-    }
-
     TerrainDecalRecord* const record = FindRecordByOverlayId_(overlayManager, overlayId);
     if (!record) {
         return false;
@@ -723,23 +1475,48 @@ bool TerrainDecalService::ResolveOverlayOverridesImpl_(cISTEOverlayManager* cons
     return true;
 }
 
+size_t TerrainDecalService::OverlayIndexKeyHash::operator()(const OverlayIndexKey& key) const noexcept
+{
+    const auto managerBits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key.overlayManager));
+    return static_cast<size_t>((managerBits * 0x100000001B3ull) ^ key.overlayId);
+}
+
 TerrainDecalRecord* TerrainDecalService::FindRecordByOverlayId_(cISTEOverlayManager* const overlayManager,
                                                                 const uint32_t overlayId) noexcept
 {
-    const uint32_t normalizedOverlayId = NormalizeOverlayIdKey(overlayId);
-    for (const auto& [idValue, recordConst] : registry_.Records()) {
-        auto* const record = registry_.Find(TerrainDecalId{idValue});
-        if (record && record->runtime.overlayId.has_value() &&
-            NormalizeOverlayIdKey(*record->runtime.overlayId) == normalizedOverlayId) {
-            cISC4City* city = nullptr;
-            if (!TryGetCurrentCity_(city) || !city) {
-                continue;
-            }
-            if (overlayManager != ResolveOverlayManager_(city, record->state.overlayType)) {
-                continue;
-            }
-            return record;
-        }
+    // Runs for every decal the game draws, so this must stay a hash lookup rather than a registry scan.
+    const auto it = overlayIndex_.find(OverlayIndexKey{
+        .overlayManager = overlayManager,
+        .overlayId = NormalizeOverlayIdKey(overlayId),
+    });
+    return it != overlayIndex_.end() ? registry_.Find(it->second) : nullptr;
+}
+
+void TerrainDecalService::IndexOverlay_(const TerrainDecalRecord& record)
+{
+    if (!record.runtime.overlayId.has_value() || !record.runtime.overlayManager) {
+        return;
+    }
+
+    overlayIndex_.insert_or_assign(OverlayIndexKey{
+                                       .overlayManager = record.runtime.overlayManager,
+                                       .overlayId = NormalizeOverlayIdKey(*record.runtime.overlayId),
+                                   },
+                                   record.id);
+}
+
+void TerrainDecalService::UnindexOverlay_(const TerrainDecalRecord& record) noexcept
+{
+    if (!record.runtime.overlayId.has_value() || !record.runtime.overlayManager) {
+        return;
+    }
+
+    const auto it = overlayIndex_.find(OverlayIndexKey{
+        .overlayManager = record.runtime.overlayManager,
+        .overlayId = NormalizeOverlayIdKey(*record.runtime.overlayId),
+    });
+    // A newer decal may already own the slot the game recycled; only drop our own entry.
+    if (it != overlayIndex_.end() && it->second.value == record.id.value) {
+        overlayIndex_.erase(it);
     }
-    return nullptr;
 }
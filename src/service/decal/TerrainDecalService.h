@@ -1,23 +1,30 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cRZBaseSystemService.h"
-#include "public/cIGZTerrainDecalService.h"
+#include "public/cIGZTerrainDecalService2.h"
 #include "public/TerrainDecalServiceIds.h"
 #include "utils/VersionDetection.h"
+#include "TerrainDecalChangeJournal.h"
 #include "TerrainDecalHook.h"
 #include "TerrainDecalRegistry.h"
+#include "TerrainDecalSidecarCache.h"
+#include "TerrainDecalSpatialIndex.h"
 
 class cIGZMessage2;
+class cIGZS3DCameraService;
 class cIGZMessage2Standard;
 class cISC4DBSegment;
 class cISC4City;
 class cISTEOverlayManager;
 
-class TerrainDecalService final : public cRZBaseSystemService, public cIGZTerrainDecalService {
+class TerrainDecalService final : public cRZBaseSystemService, public cIGZTerrainDecalService2 {
 public:
     TerrainDecalService();
     ~TerrainDecalService() = default;
@@ -35,24 +42,101 @@ public:
     bool ReplaceDecal(TerrainDecalId id, const TerrainDecalState* newState, uint32_t stateSize) override;
     uint32_t GetDecalCount() const override;
     uint32_t CopyDecals(TerrainDecalSnapshot* buffer, uint32_t capacity, uint32_t snapshotSize) const override;
+    uint32_t CreateDecals(const TerrainDecalState* initialStates,
+                          uint32_t count,
+                          uint32_t stateSize,
+                          TerrainDecalId* outIds,
+                          TerrainDecalBatchResult* outResults) override;
+    uint32_t RemoveDecals(const TerrainDecalId* ids, uint32_t count, TerrainDecalBatchResult* outResults) override;
+    uint32_t ReplaceDecals(const TerrainDecalId* ids,
+                           const TerrainDecalState* newStates,
+                           uint32_t count,
+                           uint32_t stateSize,
+                           TerrainDecalBatchResult* outResults) override;
+    bool UpdateDecal(TerrainDecalId id, const TerrainDecalState* newState, uint32_t stateSize, uint32_t fieldMask) override;
+    uint32_t QueryDecalsInRect(float minX,
+                               float minZ,
+                               float maxX,
+                               float maxZ,
+                               TerrainDecalId* outIds,
+                               uint32_t capacity) const override;
+    uint32_t QueryDecalsAtPoint(float x, float z, TerrainDecalId* outIds, uint32_t capacity) const override;
+    bool QueryNearestDecal(float x, float z, float maxDistance, TerrainDecalId* outId) const override;
+    uint64_t GetChangeSequence() const override;
+    TerrainDecalChangesResult GetChangesSince(uint64_t sequence,
+                                              TerrainDecalChange* outChanges,
+                                              uint32_t capacity,
+                                              uint32_t changeSize,
+                                              uint32_t* outCount,
+                                              uint64_t* outSequence) const override;
+    bool GetRebindProgress(TerrainDecalRebindProgress* outProgress, uint32_t progressSize) const override;
+    uint64_t GetTerrainRevision() const override;
+    uint64_t GetTerrainRevisionInRect(float minX, float minZ, float maxX, float maxZ) const override;
+    bool GetRendererDiagnostics(TerrainDecalRendererDiagnostics* outDiagnostics,
+                                uint32_t diagnosticsSize) const override;
+    bool GetRendererFrameStats(TerrainDecalRendererFrameStats* outStats, uint32_t statsSize) const override;
     bool OnTick(uint32_t unknown1) override;
 
     void SetEnableCustomRenderer(bool enableCustomRenderer) noexcept;
     void SetCustomDefaultDepthOffset(int customDefaultDepthOffset) noexcept;
     void SetShadowRecoveryOpacityScale(float shadowRecoveryOpacityScale) noexcept;
+    void SetGeometryCacheBudgetKB(int geometryCacheBudgetKB) noexcept;
+    void SetIndexedSubmission(bool indexedSubmission) noexcept;
+    // Saves sidecar format 2.0 through the per-region cache instead of format 1.1.
+    void SetCompactSidecar(bool compactSidecar) noexcept;
+    // 0 removes the corresponding limit.
+    void SetRebindBudget(int budgetMs, int budgetCount) noexcept;
+    // Used to rebind loaded decals nearest the view first; may be null.
+    void SetCameraService(cIGZS3DCameraService* cameraService) noexcept;
     bool Init() override;
     bool Shutdown();
     bool HandleMessage(cIGZMessage2* message);
 
 private:
-    bool CreateRuntimeDecal_(TerrainDecalId id, const TerrainDecalState& state, bool updateNextId);
-    bool ApplyStateToRuntime_(TerrainDecalRecord& record, const TerrainDecalState& state);
-    bool RemoveRuntimeDecal_(TerrainDecalId id, bool removeRuntimeOverlay);
+    struct OverlayIndexKey {
+        cISTEOverlayManager* overlayManager = nullptr;
+        uint32_t overlayId = 0;
+
+        bool operator==(const OverlayIndexKey& other) const noexcept = default;
+    };
+
+    struct OverlayIndexKeyHash {
+        size_t operator()(const OverlayIndexKey& key) const noexcept;
+    };
+
+    // City and overlay managers, resolved once per public call or batch.
+    struct RuntimeContext {
+        cISC4City* city = nullptr;
+        std::array<cISTEOverlayManager*, 4> overlayManagers{};
+        std::array<bool, 4> overlayManagersResolved{};
+    };
+
+    bool TryBeginRuntimeContext_(RuntimeContext& context) const;
+    cISTEOverlayManager* ResolveOverlayManager_(RuntimeContext& context,
+                                               cISTETerrainView::tOverlayManagerType overlayType) const;
+    TerrainDecalBatchResult CreateRuntimeDecal_(RuntimeContext& context,
+                                                TerrainDecalId id,
+                                                const TerrainDecalState& state,
+                                                bool updateNextId);
+    TerrainDecalBatchResult ApplyStateToRuntime_(RuntimeContext& context,
+                                                 TerrainDecalRecord& record,
+                                                 const TerrainDecalState& state);
+    TerrainDecalBatchResult RecreateRuntimeDecal_(RuntimeContext& context,
+                                                  TerrainDecalRecord& record,
+                                                  const TerrainDecalState& state);
+    TerrainDecalBatchResult UpdateRuntimeDecalInPlace_(RuntimeContext& context,
+                                                       TerrainDecalRecord& record,
+                                                       const TerrainDecalState& state,
+                                                       uint32_t changedFields);
+    bool RemoveRuntimeDecal_(RuntimeContext& context, TerrainDecalId id, bool removeRuntimeOverlay);
     void ClearRuntimeState_(bool removeRuntimeOverlays);
     void OnPostCityInit_(cIGZMessage2Standard* msg);
     void OnPreCityShutdown_(cIGZMessage2Standard* msg);
     void OnLoad_(cIGZMessage2Standard* msg);
     void OnSave_(cIGZMessage2Standard* msg);
+    // Registry records plus loaded decals still waiting to be rebound, optionally only those in dirty
+    // sidecar regions.
+    [[nodiscard]] std::vector<TerrainDecalSnapshot> CollectSaveSnapshots_(bool dirtyRegionsOnly) const;
     bool TryGetCurrentCity_(cISC4City*& city) const;
     cISTEOverlayManager* ResolveOverlayManager_(cISC4City* city,
                                                cISTETerrainView::tOverlayManagerType overlayType) const;
@@ -60,19 +144,44 @@ private:
     bool CaptureLiveState_(const TerrainDecalRecord& record, TerrainDecalState& state) const;
     bool ValidateState_(TerrainDecalState& state, std::string& error) const;
     void RebindLoadedDecals_();
+    // Drops the loaded decals still waiting to be rebound and zeroes rebindProgress_.
+    void ResetPendingLoadedDecals_() noexcept;
+    void ClearLoadedDecalQueue_() noexcept;
+    [[nodiscard]] bool HasPendingLoadedDecals_() const noexcept;
+    void OrderPendingLoadedDecals_();
+    bool TryGetViewFocus_(float& x, float& z) const;
     static bool ResolveOverlayOverrides_(void* overlayManager, uint32_t overlayId,
                                          TerrainDecal::TerrainDecalOverlayOverrides& overrides, void* userData);
     bool ResolveOverlayOverridesImpl_(cISTEOverlayManager* overlayManager, uint32_t overlayId,
                                       TerrainDecal::TerrainDecalOverlayOverrides& overrides);
     TerrainDecalRecord* FindRecordByOverlayId_(cISTEOverlayManager* overlayManager, uint32_t overlayId) noexcept;
+    void IndexOverlay_(const TerrainDecalRecord& record);
+    void UnindexOverlay_(const TerrainDecalRecord& record) noexcept;
 
 private:
     uint16_t versionTag_{};
     TerrainDecalRegistry registry_{};
+    // (overlay manager, normalized overlay id) -> owning decal, for per-draw override lookups.
+    std::unordered_map<OverlayIndexKey, TerrainDecalId, OverlayIndexKeyHash> overlayIndex_{};
+    TerrainDecalSpatialIndex spatialIndex_{};
+    TerrainDecalChangeJournal changeJournal_{};
+    TerrainDecalSidecarCache sidecarCache_{};
     std::unique_ptr<TerrainDecal::TerrainDecalHook> renderHook_{};
+    // Loaded decals waiting for a runtime overlay. Entries before the cursor have been attempted; failed
+    // ones wait in retryLoadedDecals_ for the next pass.
     std::vector<TerrainDecalSnapshot> pendingLoadedDecals_{};
+    size_t pendingLoadedCursor_ = 0;
+    std::vector<TerrainDecalSnapshot> retryLoadedDecals_{};
+    bool pendingLoadedOrdered_ = false;
+    TerrainDecalRebindProgress rebindProgress_{};
+    int rebindBudgetMs_ = 4;
+    int rebindBudgetCount_ = 0;
+    cIGZS3DCameraService* cameraService_ = nullptr;
     bool enableCustomRenderer_ = true;
     int customDefaultDepthOffset_ = 2;
     float shadowRecoveryOpacityScale_ = 0.25f;
+    int geometryCacheBudgetKB_ = 4096;
+    bool indexedSubmission_ = false;
+    bool compactSidecar_ = false;
     bool cityLoaded_ = false;
 };
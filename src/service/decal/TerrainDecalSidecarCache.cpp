@@ -0,0 +1,119 @@
+#include "TerrainDecalSidecarCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Keeps region math well inside int32 for garbage coordinates.
+    constexpr float kMaxCoordinate = 1.0e7f;
+
+    [[nodiscard]] int32_t RegionCoordinate(const float value) noexcept
+    {
+        const float clamped = std::isfinite(value) ? std::clamp(value, -kMaxCoordinate, kMaxCoordinate) : 0.0f;
+        return static_cast<int32_t>(std::floor(clamped / TerrainDecalSidecarCache::kRegionSize));
+    }
+}
+
+void TerrainDecalSidecarCache::MarkDirty(const cS3DVector2& center)
+{
+    if (!allDirty_) {
+        dirty_.insert(RegionKey(center));
+    }
+}
+
+void TerrainDecalSidecarCache::Invalidate() noexcept
+{
+    regions_.clear();
+    dirty_.clear();
+    allDirty_ = true;
+    textures_.Clear();
+}
+
+bool TerrainDecalSidecarCache::HasDirtyRegions() const noexcept
+{
+    return allDirty_ || !dirty_.empty();
+}
+
+bool TerrainDecalSidecarCache::IsDirty(const cS3DVector2& center) const
+{
+    return allDirty_ || dirty_.contains(RegionKey(center));
+}
+
+bool TerrainDecalSidecarCache::IsEmpty() const noexcept
+{
+    return regions_.empty();
+}
+
+TerrainDecalSidecarCache::SaveStats TerrainDecalSidecarCache::Rebuild(const std::vector<TerrainDecalSnapshot>& snapshots)
+{
+    // Group the dirty regions' decals by region, then by id so deltas stay small and output is stable.
+    struct Entry {
+        uint64_t region;
+        uint32_t id;
+        uint32_t index;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(snapshots.size());
+    for (uint32_t i = 0; i < snapshots.size(); ++i) {
+        const cS3DVector2& center = snapshots[i].state.decalInfo.center;
+        if (IsDirty(center)) {
+            entries.push_back(Entry{.region = RegionKey(center), .id = snapshots[i].id.value, .index = i});
+        }
+    }
+    std::ranges::sort(entries, [](const Entry& a, const Entry& b) {
+        return a.region != b.region ? a.region < b.region : a.id < b.id;
+    });
+
+    if (allDirty_) {
+        regions_.clear();
+        textures_.Clear();
+    }
+    else {
+        for (const uint64_t region : dirty_) {
+            regions_.erase(region);
+        }
+    }
+
+    SaveStats stats{};
+    std::vector<TerrainDecalSnapshot> group;
+    for (size_t first = 0; first < entries.size();) {
+        const uint64_t region = entries[first].region;
+        group.clear();
+        size_t last = first;
+        for (; last < entries.size() && entries[last].region == region; ++last) {
+            group.push_back(snapshots[entries[last].index]);
+        }
+
+        Region& cached = regions_[region];
+        TerrainDecalSidecar::EncodeCompactRecords(group.data(), group.size(), textures_, {}, cached.payload);
+        // The encoder sizes its buffer for the worst case; cached chunks live until the next save.
+        cached.payload.shrink_to_fit();
+        cached.decalCount = static_cast<uint32_t>(group.size());
+        ++stats.encodedRegions;
+        stats.encodedDecals += cached.decalCount;
+        first = last;
+    }
+
+    dirty_.clear();
+    allDirty_ = false;
+    stats.regions = static_cast<uint32_t>(regions_.size());
+    return stats;
+}
+
+bool TerrainDecalSidecarCache::Write(cIGZOStream& out) const
+{
+    std::vector<const std::vector<uint8_t>*> payloads;
+    payloads.reserve(regions_.size());
+    for (const auto& [key, region] : regions_) {
+        payloads.push_back(&region.payload);
+    }
+    return TerrainDecalSidecar::WriteCompact(out, textures_, payloads);
+}
+
+uint64_t TerrainDecalSidecarCache::RegionKey(const cS3DVector2& center) noexcept
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(RegionCoordinate(center.fX))) << 32 |
+           static_cast<uint32_t>(RegionCoordinate(center.fY));
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "public/cIGZTerrainDecalService.h"
+#include "TerrainDecalSidecarCodec.h"
+
+class cIGZOStream;
+
+// Encoded sidecar chunks kept between saves, one TDC2 chunk per kRegionTiles x kRegionTiles tile region.
+// A decal belongs to the region holding its center. Regions touched since the last save are re-encoded;
+// every other chunk is written from its cached bytes.
+class TerrainDecalSidecarCache {
+public:
+    static constexpr int32_t kRegionTiles = 64;
+    static constexpr float kRegionSize = 16.0f * kRegionTiles;
+
+    struct SaveStats {
+        uint32_t regions = 0;
+        uint32_t encodedRegions = 0;
+        uint32_t encodedDecals = 0;
+    };
+
+    // Marks the region holding center as changed.
+    void MarkDirty(const cS3DVector2& center);
+    // Drops every cached chunk; the next Rebuild encodes everything it is given.
+    void Invalidate() noexcept;
+
+    [[nodiscard]] bool HasDirtyRegions() const noexcept;
+    [[nodiscard]] bool IsDirty(const cS3DVector2& center) const;
+    [[nodiscard]] bool IsEmpty() const noexcept;
+
+    // Re-encodes the dirty regions. snapshots must hold every decal whose center lies in a dirty region;
+    // decals in clean regions are ignored.
+    SaveStats Rebuild(const std::vector<TerrainDecalSnapshot>& snapshots);
+    bool Write(cIGZOStream& out) const;
+
+private:
+    struct Region {
+        std::vector<uint8_t> payload{};
+        uint32_t decalCount = 0;
+    };
+
+    [[nodiscard]] static uint64_t RegionKey(const cS3DVector2& center) noexcept;
+
+    // Ordered so a sidecar's chunks come out in the same order on every save.
+    std::map<uint64_t, Region> regions_{};
+    std::unordered_set<uint64_t> dirty_{};
+    bool allDirty_ = true;
+    TerrainDecalSidecar::TextureKeyTable textures_{};
+};
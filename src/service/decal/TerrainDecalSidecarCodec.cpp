@@ -1,9 +1,34 @@
 #include "TerrainDecalSidecarCodec.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <system_error>
+#include <thread>
+
 #include "cIGZIStream.h"
 #include "cIGZOStream.h"
 
 namespace {
+    // Record layout before depthOffset was added (sidecar 1.0).
+    constexpr uint32_t kRecordSizeWithoutDepthOffset = offsetof(TerrainDecalSidecar::PersistedTerrainDecal, depthOffset);
+
+    // The field-wise stream calls write each value little-endian with no padding, so on a little-endian
+    // host a record is byte-identical to PersistedTerrainDecal and the whole array can move as one block.
+    constexpr bool kBlockTransferSupported = std::endian::native == std::endian::little;
+    // Records moved per GetVoid/SetVoid call; keeps the staging buffer around 64 KB.
+    constexpr uint32_t kBlockRecords = 600;
+
+    bool CanReadRecordsAsBlock(const uint32_t recordSize) noexcept {
+        return kBlockTransferSupported &&
+               (recordSize == kRecordSizeWithoutDepthOffset ||
+                recordSize >= sizeof(TerrainDecalSidecar::PersistedTerrainDecal));
+    }
+
     TerrainDecalSnapshot DecodeSnapshot(const TerrainDecalSidecar::PersistedTerrainDecal& persisted) {
         TerrainDecalSnapshot snapshot{};
         snapshot.id = TerrainDecalId{persisted.decalId};
@@ -76,10 +101,551 @@ namespace {
         persisted.depthOffset = snapshot.state.depthOffset;
         return persisted;
     }
+
+    // Records one decode task converts in the 1.x parallel path.
+    constexpr size_t kDecodeTaskRecords = 4096;
+
+    // Upper bound on a single v2 chunk; keeps a corrupt length from turning into a huge allocation.
+    constexpr uint32_t kMaxCompactChunkBytes = 256u * 1024u * 1024u;
+    // Magnitudes below 2^22 scale to integers that fit comfortably in a zigzag varint of int32 range.
+    constexpr float kMaxFixedPointMagnitude = 4194304.0f;
+
+    constexpr TerrainDecalSidecar::PersistedTerrainDecal kPersistedDefaults{};
+
+    bool SameBits(const float a, const float b) noexcept {
+        return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+    }
+
+    constexpr size_t kMaxVarint32Bytes = 5;
+    constexpr size_t kMaxVarint64Bytes = 10;
+
+    // Largest TDC2 record, with every optional field present. The id delta is the zigzag of a 33-bit value
+    // and the mask has 16 bits, so both fit the varint32 bound.
+    constexpr size_t kMaxCompactRecordBytes = 4 * kMaxVarint32Bytes      // id delta, mask, texture, overlay type
+                                            + 3 * kMaxVarint32Bytes      // centre and size as zigzag int32
+                                            + 4 + 4 + 3 * 4              // rotation, opacity, colour
+                                            + kMaxVarint32Bytes          // depth offset
+                                            + 4 * 4 + kMaxVarint32Bytes  // UV window and mode
+                                            + 5 * 4                      // aspect, UV scale, UV offset, unknown8
+                                            + 2 * kMaxVarint32Bytes;     // overlay flags and draw mode
+
+    // Appends to a byte vector through a raw cursor. The constructor grows the vector by the caller's worst
+    // case once, so no put checks capacity; Finish trims the vector to the bytes actually written.
+    class ByteWriter {
+    public:
+        ByteWriter(std::vector<uint8_t>& bytes, const size_t maxBytes) : bytes_(bytes) {
+            const size_t start = bytes_.size();
+            bytes_.resize(start + maxBytes);
+            cursor_ = bytes_.data() + start;
+        }
+
+        void Finish() {
+            bytes_.resize(static_cast<size_t>(cursor_ - bytes_.data()));
+        }
+
+        void PutVarint(uint64_t value) {
+            while (value >= 0x80) {
+                Put(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            Put(static_cast<uint8_t>(value));
+        }
+
+        void PutZigzag(const int64_t value) {
+            PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void PutUint32(const uint32_t value) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                Put(static_cast<uint8_t>(value >> shift));
+            }
+        }
+
+        void PutFloat(const float value) {
+            PutUint32(std::bit_cast<uint32_t>(value));
+        }
+
+    private:
+        void Put(const uint8_t byte) {
+            *cursor_++ = byte;
+        }
+
+        std::vector<uint8_t>& bytes_;
+        uint8_t* cursor_ = nullptr;
+    };
+
+    // Bounds-checked cursor over a chunk payload. Every getter fails once the payload is exhausted.
+    class ByteReader {
+    public:
+        ByteReader(const uint8_t* const data, const size_t size) : cursor_(data), end_(data + size) {}
+
+        bool GetVarint(uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (cursor_ == end_) {
+                    return false;
+                }
+                const uint8_t byte = *cursor_++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool GetVarint32(uint32_t& value) {
+            uint64_t wide = 0;
+            if (!GetVarint(wide) || wide > UINT32_MAX) {
+                return false;
+            }
+            value = static_cast<uint32_t>(wide);
+            return true;
+        }
+
+        bool GetZigzag(int64_t& value) {
+            uint64_t encoded = 0;
+            if (!GetVarint(encoded)) {
+                return false;
+            }
+            value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+            return true;
+        }
+
+        bool GetUint32(uint32_t& value) {
+            if (end_ - cursor_ < 4) {
+                return false;
+            }
+            value = static_cast<uint32_t>(cursor_[0])
+                  | (static_cast<uint32_t>(cursor_[1]) << 8)
+                  | (static_cast<uint32_t>(cursor_[2]) << 16)
+                  | (static_cast<uint32_t>(cursor_[3]) << 24);
+            cursor_ += 4;
+            return true;
+        }
+
+        bool GetFloat(float& value) {
+            uint32_t bits = 0;
+            if (!GetUint32(bits)) {
+                return false;
+            }
+            value = std::bit_cast<float>(bits);
+            return true;
+        }
+
+        [[nodiscard]] bool AtEnd() const noexcept {
+            return cursor_ == end_;
+        }
+
+    private:
+        const uint8_t* cursor_;
+        const uint8_t* end_;
+    };
+
+    bool TryFixedPoint(const float value, const bool quantize, int32_t& fixed) {
+        if (!(std::fabs(value) < kMaxFixedPointMagnitude)) {
+            return false;
+        }
+
+        const float scaled = std::nearbyint(value * TerrainDecalSidecar::kCompactFixedPointScale);
+        fixed = static_cast<int32_t>(scaled);
+        // Power-of-two scaling is exact, so the only loss is the rounding above (and the sign of -0).
+        return quantize || SameBits(static_cast<float>(fixed) / TerrainDecalSidecar::kCompactFixedPointScale, value);
+    }
+
+    void PutCoordinate(ByteWriter& writer, const float value, const bool fixedPoint, const int32_t fixed) {
+        if (fixedPoint) {
+            writer.PutZigzag(fixed);
+        }
+        else {
+            writer.PutFloat(value);
+        }
+    }
+
+    bool GetCoordinate(ByteReader& reader, const bool fixedPoint, float& value) {
+        if (!fixedPoint) {
+            return reader.GetFloat(value);
+        }
+
+        int64_t fixed = 0;
+        if (!reader.GetZigzag(fixed) || fixed < INT32_MIN || fixed > INT32_MAX) {
+            return false;
+        }
+        value = static_cast<float>(fixed) / TerrainDecalSidecar::kCompactFixedPointScale;
+        return true;
+    }
+
+    using TextureKeyTuple = TerrainDecalSidecar::TextureKeyTable::Key;
+
+    // TTEX payload: varint count, then type/group/instance per key. TDC2 records index into it.
+    void EncodeTextureKeys(const std::vector<TextureKeyTuple>& keys, std::vector<uint8_t>& bytes) {
+        ByteWriter writer(bytes, kMaxVarint64Bytes + keys.size() * 12);
+        writer.PutVarint(keys.size());
+        for (const auto& [type, group, instance] : keys) {
+            writer.PutUint32(type);
+            writer.PutUint32(group);
+            writer.PutUint32(instance);
+        }
+        writer.Finish();
+    }
+
+    bool DecodeTextureKeys(const std::vector<uint8_t>& bytes, std::vector<TextureKeyTuple>& keys) {
+        ByteReader reader(bytes.data(), bytes.size());
+        uint64_t count = 0;
+        if (!reader.GetVarint(count) || count > bytes.size() / 12) {
+            return false;
+        }
+
+        keys.reserve(keys.size() + static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            uint32_t type = 0;
+            uint32_t group = 0;
+            uint32_t instance = 0;
+            if (!reader.GetUint32(type) || !reader.GetUint32(group) || !reader.GetUint32(instance)) {
+                return false;
+            }
+            keys.emplace_back(type, group, instance);
+        }
+        return reader.AtEnd();
+    }
+
+    bool DecodeCompactRecord(ByteReader& reader,
+                             const std::span<const TextureKeyTuple> textureKeys,
+                             uint32_t& previousId,
+                             TerrainDecalSidecar::PersistedTerrainDecal& p) {
+        using namespace TerrainDecalSidecar;
+
+        int64_t idDelta = 0;
+        uint32_t fields = 0;
+        uint32_t textureIndex = 0;
+        if (!reader.GetZigzag(idDelta) ||
+            !reader.GetVarint32(fields) ||
+            !reader.GetVarint32(textureIndex) ||
+            !reader.GetVarint32(p.overlayType)) {
+            return false;
+        }
+
+        const int64_t id = static_cast<int64_t>(previousId) + idDelta;
+        if (id < 0 || id > UINT32_MAX || (fields & ~kCompactKnownFields) != 0 || textureIndex >= textureKeys.size()) {
+            return false;
+        }
+        p.decalId = static_cast<uint32_t>(id);
+        previousId = p.decalId;
+        std::tie(p.textureType, p.textureGroup, p.textureInstance) = textureKeys[textureIndex];
+
+        if (!GetCoordinate(reader, (fields & kCompactCenterFixed) != 0, p.centerX) ||
+            !GetCoordinate(reader, (fields & kCompactCenterFixed) != 0, p.centerZ) ||
+            !GetCoordinate(reader, (fields & kCompactSizeFixed) != 0, p.baseSize)) {
+            return false;
+        }
+
+        if ((fields & kCompactRotation) && !reader.GetFloat(p.rotationTurns)) {
+            return false;
+        }
+        if ((fields & kCompactOpacity) && !reader.GetFloat(p.opacity)) {
+            return false;
+        }
+        if ((fields & kCompactColor) &&
+            (!reader.GetFloat(p.colorX) || !reader.GetFloat(p.colorY) || !reader.GetFloat(p.colorZ))) {
+            return false;
+        }
+        if (fields & kCompactDepthOffset) {
+            int64_t depthOffset = 0;
+            if (!reader.GetZigzag(depthOffset) || depthOffset < INT32_MIN || depthOffset > INT32_MAX) {
+                return false;
+            }
+            p.depthOffset = static_cast<int32_t>(depthOffset);
+        }
+        if ((fields & kCompactUvWindow) &&
+            (!reader.GetFloat(p.u1) || !reader.GetFloat(p.v1) ||
+             !reader.GetFloat(p.u2) || !reader.GetFloat(p.v2) ||
+             !reader.GetVarint32(p.uvMode))) {
+            return false;
+        }
+        if ((fields & kCompactAspect) && !reader.GetFloat(p.aspectMultiplier)) {
+            return false;
+        }
+        if ((fields & kCompactUvScaleU) && !reader.GetFloat(p.uvScaleU)) {
+            return false;
+        }
+        if ((fields & kCompactUvScaleV) && !reader.GetFloat(p.uvScaleV)) {
+            return false;
+        }
+        if ((fields & kCompactUvOffset) && !reader.GetFloat(p.uvOffset)) {
+            return false;
+        }
+        if ((fields & kCompactUnknown8) && !reader.GetFloat(p.unknown8)) {
+            return false;
+        }
+        if ((fields & kCompactOverlayFlags) && !reader.GetVarint32(p.overlayFlags)) {
+            return false;
+        }
+        if ((fields & kCompactDrawMode) && !reader.GetVarint32(p.overlayDrawMode)) {
+            return false;
+        }
+
+        p.stateFlags = 0;
+        if ((fields & kCompactDisabled) == 0) {
+            p.stateFlags |= kEnabled;
+        }
+        if (fields & kCompactHasUvWindow) {
+            p.stateFlags |= kHasUvWindow;
+        }
+        return true;
+    }
+
+    // Leading record count of a TDC2 payload. Every record takes at least seven bytes (id, mask, texture,
+    // overlay, three fixed-point values), which bounds the count a corrupt payload can claim.
+    bool ReadCompactRecordCount(ByteReader& reader, const size_t payloadBytes, uint64_t& count) {
+        return reader.GetVarint(count) && count <= payloadBytes / 7;
+    }
+
+    bool DecodeCompactRecords(const std::vector<uint8_t>& bytes,
+                              const std::span<const TextureKeyTuple> textureKeys,
+                              TerrainDecalSnapshot* const decals,
+                              const size_t count) {
+        ByteReader reader(bytes.data(), bytes.size());
+        uint64_t storedCount = 0;
+        if (!ReadCompactRecordCount(reader, bytes.size(), storedCount) || storedCount != count) {
+            return false;
+        }
+
+        uint32_t previousId = 0;
+        for (size_t i = 0; i < count; ++i) {
+            TerrainDecalSidecar::PersistedTerrainDecal persisted{};
+            if (!DecodeCompactRecord(reader, textureKeys, previousId, persisted)) {
+                return false;
+            }
+            decals[i] = DecodeSnapshot(persisted);
+        }
+        return reader.AtEnd();
+    }
+
+    [[nodiscard]] uint32_t ResolveDecodeThreads(const TerrainDecalSidecar::ReadOptions& options, const size_t records) {
+        using namespace TerrainDecalSidecar;
+
+        const uint32_t requested = options.decodeThreads != 0
+                                       ? options.decodeThreads
+                                       : std::clamp(std::thread::hardware_concurrency(), 1u, kMaxDecodeThreads);
+        const size_t useful = std::max<size_t>(1, records / kMinRecordsPerDecodeThread);
+        return static_cast<uint32_t>(std::min<size_t>({requested, kMaxDecodeThreads, useful}));
+    }
+
+    // Runs task(i) for every i in [0, taskCount) on up to threads threads, the caller included. Tasks are
+    // handed out through a shared counter and each writes only its own output, so scheduling cannot change
+    // the result. If a helper thread cannot be started, the threads already running absorb its share.
+    template <typename Task>
+    void ParallelFor(const size_t taskCount, const uint32_t threads, const Task& task) {
+        std::atomic<size_t> next{0};
+        const auto drain = [&] {
+            for (size_t i = next.fetch_add(1); i < taskCount; i = next.fetch_add(1)) {
+                task(i);
+            }
+        };
+
+        const size_t helperCount = std::min<size_t>(threads, taskCount) - std::min<size_t>(1, taskCount);
+        std::vector<std::jthread> helpers;
+        helpers.reserve(helperCount);
+        for (size_t i = 0; i < helperCount; ++i) {
+            try {
+                helpers.emplace_back(drain);
+            }
+            catch (const std::system_error&) {
+                break;
+            }
+        }
+        drain();
+    }
+
+    // Reads the whole record array with block transfers, then converts fixed slices of it in parallel.
+    bool ReadRecordsAsBlockParallel(cIGZIStream& in,
+                                    const TerrainDecalSidecar::TerrainDecalChunkHeader& chunk,
+                                    const uint32_t threads,
+                                    std::vector<TerrainDecalSnapshot>& decals) {
+        using namespace TerrainDecalSidecar;
+
+        // Grown a block at a time so a corrupt record count fails on the stream, not on one huge allocation.
+        std::vector<std::byte> payload;
+        for (uint32_t first = 0; first < chunk.recordCount; first += kBlockRecords) {
+            const uint32_t count = std::min(kBlockRecords, chunk.recordCount - first);
+            const size_t offset = payload.size();
+            payload.resize(offset + static_cast<size_t>(count) * chunk.recordSize);
+            if (!in.GetVoid(payload.data() + offset, count * chunk.recordSize)) {
+                return false;
+            }
+        }
+
+        const size_t bytesToCopy = std::min<size_t>(chunk.recordSize, sizeof(PersistedTerrainDecal));
+        const size_t recordCount = chunk.recordCount;
+        decals.resize(recordCount);
+        ParallelFor((recordCount + kDecodeTaskRecords - 1) / kDecodeTaskRecords, threads, [&](const size_t task) {
+            const size_t last = std::min(recordCount, (task + 1) * kDecodeTaskRecords);
+            for (size_t i = task * kDecodeTaskRecords; i < last; ++i) {
+                PersistedTerrainDecal persisted{};
+                std::memcpy(&persisted, payload.data() + i * chunk.recordSize, bytesToCopy);
+                decals[i] = DecodeSnapshot(persisted);
+            }
+        });
+        return true;
+    }
+
+    bool ReadLegacyChunk(cIGZIStream& in,
+                         const TerrainDecalSidecar::TerrainDecalSidecarHeader& header,
+                         const TerrainDecalSidecar::ReadOptions& options,
+                         TerrainDecalSidecar::ReadResult& result) {
+        using namespace TerrainDecalSidecar;
+
+        if (header.chunkCount != 1) {
+            result.error = "unexpected terrain decal sidecar chunk count";
+            return false;
+        }
+
+        TerrainDecalChunkHeader chunk{};
+        if (!in.GetUint32(chunk.tag) ||
+            !in.GetUint32(chunk.payloadBytes) ||
+            !in.GetUint32(chunk.recordSize) ||
+            !in.GetUint32(chunk.recordCount)) {
+            result.error = "truncated terrain decal chunk header";
+            return false;
+        }
+
+        if (chunk.tag != kChunkTagTerrainDecals) {
+            result.error = "unexpected terrain decal chunk tag";
+            return false;
+        }
+
+        if (chunk.payloadBytes != static_cast<uint64_t>(chunk.recordCount) * chunk.recordSize) {
+            result.error = "terrain decal chunk payload size mismatch";
+            return false;
+        }
+
+        if (CanReadRecordsAsBlock(chunk.recordSize)) {
+            const uint32_t threads = ResolveDecodeThreads(options, chunk.recordCount);
+            bool read = false;
+            if (threads > 1) {
+                read = ReadRecordsAsBlockParallel(in, chunk, threads, result.decals);
+            }
+            else {
+                result.decals.reserve(chunk.recordCount);
+                read = ReadRecordsAsBlock(in, chunk, result.decals);
+            }
+            if (!read) {
+                result.error = "truncated terrain decal record";
+                result.decals.clear();
+                return false;
+            }
+            return true;
+        }
+
+        result.decals.reserve(chunk.recordCount);
+        return ReadRecordsFieldwise(in, chunk, result);
+    }
+
+    // A TDC2 payload read ahead of decoding, with the number of texture keys defined before it.
+    struct PendingCompactChunk {
+        std::vector<uint8_t> payload{};
+        size_t textureKeyCount = 0;
+        size_t firstDecal = 0;
+        size_t decalCount = 0;
+    };
+
+    // Reads every chunk on the calling thread, then decodes the TDC2 chunks in parallel. Records in a chunk
+    // only see the texture keys that precede the chunk, as they would when decoding chunk by chunk.
+    bool ReadCompactChunks(cIGZIStream& in,
+                           const TerrainDecalSidecar::TerrainDecalSidecarHeader& header,
+                           const TerrainDecalSidecar::ReadOptions& options,
+                           TerrainDecalSidecar::ReadResult& result) {
+        using namespace TerrainDecalSidecar;
+
+        std::vector<TextureKeyTuple> textureKeys;
+        std::vector<PendingCompactChunk> pending;
+        size_t decalCount = 0;
+        const char* readError = nullptr;
+        for (uint32_t i = 0; i < header.chunkCount && !readError; ++i) {
+            TerrainDecalCompactChunkHeader chunk{};
+            if (!in.GetUint32(chunk.tag) || !in.GetUint32(chunk.payloadBytes)) {
+                readError = "truncated terrain decal chunk header";
+                break;
+            }
+
+            if (chunk.payloadBytes > kMaxCompactChunkBytes) {
+                readError = "terrain decal chunk payload too large";
+                break;
+            }
+
+            std::vector<uint8_t> payload(chunk.payloadBytes);
+            if (chunk.payloadBytes != 0 && !in.GetVoid(payload.data(), chunk.payloadBytes)) {
+                readError = "truncated terrain decal chunk";
+                break;
+            }
+
+            // Unknown chunks belong to newer minor versions and are skipped whole.
+            if (chunk.tag == kChunkTagTextureKeys) {
+                if (!DecodeTextureKeys(payload, textureKeys)) {
+                    readError = "malformed terrain decal texture table";
+                }
+            }
+            else if (chunk.tag == kChunkTagCompactDecals) {
+                ByteReader reader(payload.data(), payload.size());
+                uint64_t count = 0;
+                if (!ReadCompactRecordCount(reader, payload.size(), count)) {
+                    readError = "malformed terrain decal record";
+                    break;
+                }
+                pending.push_back(PendingCompactChunk{
+                    .payload = std::move(payload),
+                    .textureKeyCount = textureKeys.size(),
+                    .firstDecal = decalCount,
+                    .decalCount = static_cast<size_t>(count),
+                });
+                decalCount += static_cast<size_t>(count);
+            }
+        }
+
+        result.decals.resize(decalCount);
+        std::vector<uint8_t> decoded(pending.size(), 0);
+        ParallelFor(pending.size(), ResolveDecodeThreads(options, decalCount), [&](const size_t i) {
+            const PendingCompactChunk& chunk = pending[i];
+            decoded[i] = DecodeCompactRecords(chunk.payload,
+                                              std::span(textureKeys.data(), chunk.textureKeyCount),
+                                              result.decals.data() + chunk.firstDecal,
+                                              chunk.decalCount);
+        });
+
+        // Every pending chunk precedes the one that stopped the read, so a bad record wins over readError.
+        if (std::ranges::find(decoded, uint8_t{0}) != decoded.end()) {
+            readError = "malformed terrain decal record";
+        }
+        if (readError) {
+            result.error = readError;
+            result.decals.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool WriteSidecarHeader(cIGZOStream& out, const TerrainDecalSidecar::TerrainDecalSidecarHeader& header) {
+        return out.SetUint32(header.magic) &&
+               out.SetUint16(header.versionMajor) &&
+               out.SetUint16(header.versionMinor) &&
+               out.SetUint32(header.flags) &&
+               out.SetUint32(header.chunkCount);
+    }
+
+    bool WriteCompactChunk(cIGZOStream& out, const uint32_t tag, const std::vector<uint8_t>& payload) {
+        if (payload.size() > kMaxCompactChunkBytes) {
+            return false;
+        }
+
+        const auto payloadBytes = static_cast<uint32_t>(payload.size());
+        return out.SetUint32(tag) &&
+               out.SetUint32(payloadBytes) &&
+               (payloadBytes == 0 || out.SetVoid(payload.data(), payloadBytes));
+    }
 }
 
 namespace TerrainDecalSidecar {
-    ReadResult Read(cIGZIStream& in) {
+    ReadResult Read(cIGZIStream& in, const ReadOptions& options) {
         ReadResult result{};
 
         TerrainDecalSidecarHeader header{};
@@ -97,38 +663,51 @@ namespace TerrainDecalSidecar {
             return result;
         }
 
-        if (header.versionMajor != kVersionMajor) {
+        bool read = false;
+        if (header.versionMajor == kLegacyVersionMajor) {
+            read = ReadLegacyChunk(in, header, options, result);
+        }
+        else if (header.versionMajor == kVersionMajor) {
+            read = ReadCompactChunks(in, header, options, result);
+        }
+        else {
             result.error = "unsupported terrain decal sidecar major version";
-            return result;
         }
 
-        if (header.chunkCount != 1) {
-            result.error = "unexpected terrain decal sidecar chunk count";
+        if (!read) {
             return result;
         }
 
-        TerrainDecalChunkHeader chunk{};
-        if (!in.GetUint32(chunk.tag) ||
-            !in.GetUint32(chunk.payloadBytes) ||
-            !in.GetUint32(chunk.recordSize) ||
-            !in.GetUint32(chunk.recordCount)) {
-            result.error = "truncated terrain decal chunk header";
-            return result;
+        result.ok = in.GetError() == 0;
+        if (!result.ok && result.error.empty()) {
+            result.error = "stream read error";
         }
+        return result;
+    }
 
-        if (chunk.tag != kChunkTagTerrainDecals) {
-            result.error = "unexpected terrain decal chunk tag";
-            return result;
-        }
+    bool ReadRecordsAsBlock(cIGZIStream& in, const TerrainDecalChunkHeader& chunk, std::vector<TerrainDecalSnapshot>& decals) {
+        const uint32_t blockRecords = std::max<uint32_t>(1, std::min(kBlockRecords, chunk.recordCount));
+        std::vector<std::byte> staging(static_cast<size_t>(blockRecords) * chunk.recordSize);
 
-        const bool hasDepthOffsetField = chunk.recordSize >= sizeof(PersistedTerrainDecal);
+        // Bytes past the known fields belong to newer minor versions and are skipped by the stride.
+        const size_t bytesToCopy = std::min<size_t>(chunk.recordSize, sizeof(PersistedTerrainDecal));
+        for (uint32_t first = 0; first < chunk.recordCount; first += blockRecords) {
+            const uint32_t count = std::min(blockRecords, chunk.recordCount - first);
+            if (!in.GetVoid(staging.data(), count * chunk.recordSize)) {
+                return false;
+            }
 
-        if (chunk.payloadBytes != chunk.recordCount * chunk.recordSize) {
-            result.error = "terrain decal chunk payload size mismatch";
-            return result;
+            for (uint32_t i = 0; i < count; ++i) {
+                PersistedTerrainDecal persisted{};
+                std::memcpy(&persisted, staging.data() + static_cast<size_t>(i) * chunk.recordSize, bytesToCopy);
+                decals.push_back(DecodeSnapshot(persisted));
+            }
         }
+        return true;
+    }
 
-        result.decals.reserve(chunk.recordCount);
+    bool ReadRecordsFieldwise(cIGZIStream& in, const TerrainDecalChunkHeader& chunk, ReadResult& result) {
+        const bool hasDepthOffsetField = chunk.recordSize >= sizeof(PersistedTerrainDecal);
         for (uint32_t i = 0; i < chunk.recordCount; ++i) {
             PersistedTerrainDecal persisted{};
             if (!in.GetUint32(persisted.decalId) ||
@@ -159,7 +738,7 @@ namespace TerrainDecalSidecar {
                 !in.GetUint32(persisted.uvMode)) {
                 result.error = "truncated terrain decal record";
                 result.decals.clear();
-                return result;
+                return false;
             }
 
             if (hasDepthOffsetField) {
@@ -167,7 +746,7 @@ namespace TerrainDecalSidecar {
                 if (!in.GetUint32(depthOffsetBits)) {
                     result.error = "truncated terrain decal record";
                     result.decals.clear();
-                    return result;
+                    return false;
                 }
                 persisted.depthOffset = static_cast<int32_t>(depthOffsetBits);
             }
@@ -176,15 +755,207 @@ namespace TerrainDecalSidecar {
             result.decals.push_back(DecodeSnapshot(persisted));
         }
 
-        result.ok = in.GetError() == 0;
-        if (!result.ok && result.error.empty()) {
-            result.error = "stream read error";
+        return true;
+    }
+
+    uint32_t TextureKeyTable::Intern(const cGZPersistResourceKey& key) {
+        const Key tuple{key.type, key.group, key.instance};
+        if ((keys_.size() + 1) * 2 > slots_.size()) {
+            Grow();
         }
-        return result;
+
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = Hash(tuple) & mask;; slot = (slot + 1) & mask) {
+            const uint32_t entry = slots_[slot];
+            if (entry == 0) {
+                const auto index = static_cast<uint32_t>(keys_.size());
+                keys_.push_back(tuple);
+                slots_[slot] = index + 1;
+                return index;
+            }
+            if (keys_[entry - 1] == tuple) {
+                return entry - 1;
+            }
+        }
+    }
+
+    void TextureKeyTable::Clear() noexcept {
+        keys_.clear();
+        slots_.clear();
+    }
+
+    const std::vector<TextureKeyTable::Key>& TextureKeyTable::Keys() const noexcept {
+        return keys_;
+    }
+
+    size_t TextureKeyTable::Hash(const Key& key) noexcept {
+        const auto& [type, group, instance] = key;
+        uint64_t hash = (static_cast<uint64_t>(type) << 32 | group) * 0x9E3779B97F4A7C15ull;
+        hash ^= instance + 0x7F4A7C15ull + (hash << 6) + (hash >> 2);
+        // The table masks off the low bits; fold the well-mixed high half into them.
+        hash ^= hash >> 32;
+        return static_cast<size_t>(hash);
+    }
+
+    void TextureKeyTable::Grow() {
+        slots_.assign(std::max<size_t>(16, slots_.size() * 2), 0);
+        const size_t mask = slots_.size() - 1;
+        for (size_t index = 0; index < keys_.size(); ++index) {
+            size_t slot = Hash(keys_[index]) & mask;
+            while (slots_[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots_[slot] = static_cast<uint32_t>(index + 1);
+        }
+    }
+
+    bool Write(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots, const WriteOptions& options) {
+        TextureKeyTable textures;
+        std::vector<uint8_t> records;
+        EncodeCompactRecords(snapshots.data(), snapshots.size(), textures, options, records);
+        return WriteCompact(out, textures, {&records});
+    }
+
+    bool WriteCompact(cIGZOStream& out,
+                      const TextureKeyTable& textures,
+                      const std::vector<const std::vector<uint8_t>*>& payloads) {
+        std::vector<uint8_t> textureBytes;
+        EncodeTextureKeys(textures.Keys(), textureBytes);
+
+        TerrainDecalSidecarHeader header{};
+        header.chunkCount = static_cast<uint32_t>(payloads.size() + 1);
+        if (!WriteSidecarHeader(out, header) || !WriteCompactChunk(out, kChunkTagTextureKeys, textureBytes)) {
+            return false;
+        }
+
+        for (const std::vector<uint8_t>* const payload : payloads) {
+            if (!WriteCompactChunk(out, kChunkTagCompactDecals, *payload)) {
+                return false;
+            }
+        }
+        return out.GetError() == 0;
     }
 
-    bool Write(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots) {
-        const TerrainDecalSidecarHeader header{};
+    // TDC2 payload: varint record count, then per record a zigzag id delta from the previous record,
+    // the presence mask, the texture index and overlay type, centre and size, and the optional fields
+    // named by the mask in bit order.
+    void EncodeCompactRecords(const TerrainDecalSnapshot* const snapshots,
+                              const size_t count,
+                              TextureKeyTable& textures,
+                              const WriteOptions& options,
+                              std::vector<uint8_t>& payload) {
+        ByteWriter writer(payload, kMaxVarint64Bytes + count * kMaxCompactRecordBytes);
+        writer.PutVarint(count);
+
+        uint32_t previousId = 0;
+        // Neighbouring decals usually share a texture; only a change of key goes through the table.
+        const cGZPersistResourceKey* previousKey = nullptr;
+        uint32_t textureIndex = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const PersistedTerrainDecal p = EncodeSnapshot(snapshots[i]);
+            const PersistedTerrainDecal& d = kPersistedDefaults;
+            const cGZPersistResourceKey& textureKey = snapshots[i].state.textureKey;
+            if (!previousKey || textureKey.type != previousKey->type || textureKey.group != previousKey->group ||
+                textureKey.instance != previousKey->instance) {
+                textureIndex = textures.Intern(textureKey);
+                previousKey = &textureKey;
+            }
+
+            int32_t centerXFixed = 0;
+            int32_t centerZFixed = 0;
+            int32_t sizeFixed = 0;
+            const bool quantize = options.quantizeCenterAndSize;
+            const bool centerFixed = TryFixedPoint(p.centerX, quantize, centerXFixed) &&
+                                     TryFixedPoint(p.centerZ, quantize, centerZFixed);
+            const bool baseSizeFixed = TryFixedPoint(p.baseSize, quantize, sizeFixed);
+            const bool uvWindowValues = !SameBits(p.u1, d.u1) || !SameBits(p.v1, d.v1) ||
+                                        !SameBits(p.u2, d.u2) || !SameBits(p.v2, d.v2) ||
+                                        p.uvMode != d.uvMode;
+
+            uint32_t fields = 0;
+            const auto mark = [&fields](const bool present, const uint32_t bit) {
+                if (present) {
+                    fields |= bit;
+                }
+            };
+            mark(centerFixed, kCompactCenterFixed);
+            mark(baseSizeFixed, kCompactSizeFixed);
+            mark(!SameBits(p.rotationTurns, d.rotationTurns), kCompactRotation);
+            mark(!SameBits(p.opacity, d.opacity), kCompactOpacity);
+            mark(!SameBits(p.colorX, d.colorX) || !SameBits(p.colorY, d.colorY) || !SameBits(p.colorZ, d.colorZ),
+                 kCompactColor);
+            mark(p.depthOffset != d.depthOffset, kCompactDepthOffset);
+            mark((p.stateFlags & kHasUvWindow) != 0, kCompactHasUvWindow);
+            mark(uvWindowValues, kCompactUvWindow);
+            mark((p.stateFlags & kEnabled) == 0, kCompactDisabled);
+            mark(!SameBits(p.aspectMultiplier, d.aspectMultiplier), kCompactAspect);
+            mark(!SameBits(p.uvScaleU, d.uvScaleU), kCompactUvScaleU);
+            mark(!SameBits(p.uvScaleV, d.uvScaleV), kCompactUvScaleV);
+            mark(!SameBits(p.uvOffset, d.uvOffset), kCompactUvOffset);
+            mark(!SameBits(p.unknown8, d.unknown8), kCompactUnknown8);
+            mark(p.overlayFlags != d.overlayFlags, kCompactOverlayFlags);
+            mark(p.overlayDrawMode != d.overlayDrawMode, kCompactDrawMode);
+
+            writer.PutZigzag(static_cast<int64_t>(p.decalId) - static_cast<int64_t>(previousId));
+            previousId = p.decalId;
+            writer.PutVarint(fields);
+            writer.PutVarint(textureIndex);
+            writer.PutVarint(p.overlayType);
+            PutCoordinate(writer, p.centerX, centerFixed, centerXFixed);
+            PutCoordinate(writer, p.centerZ, centerFixed, centerZFixed);
+            PutCoordinate(writer, p.baseSize, baseSizeFixed, sizeFixed);
+
+            if (fields & kCompactRotation) {
+                writer.PutFloat(p.rotationTurns);
+            }
+            if (fields & kCompactOpacity) {
+                writer.PutFloat(p.opacity);
+            }
+            if (fields & kCompactColor) {
+                writer.PutFloat(p.colorX);
+                writer.PutFloat(p.colorY);
+                writer.PutFloat(p.colorZ);
+            }
+            if (fields & kCompactDepthOffset) {
+                writer.PutZigzag(p.depthOffset);
+            }
+            if (fields & kCompactUvWindow) {
+                writer.PutFloat(p.u1);
+                writer.PutFloat(p.v1);
+                writer.PutFloat(p.u2);
+                writer.PutFloat(p.v2);
+                writer.PutVarint(p.uvMode);
+            }
+            if (fields & kCompactAspect) {
+                writer.PutFloat(p.aspectMultiplier);
+            }
+            if (fields & kCompactUvScaleU) {
+                writer.PutFloat(p.uvScaleU);
+            }
+            if (fields & kCompactUvScaleV) {
+                writer.PutFloat(p.uvScaleV);
+            }
+            if (fields & kCompactUvOffset) {
+                writer.PutFloat(p.uvOffset);
+            }
+            if (fields & kCompactUnknown8) {
+                writer.PutFloat(p.unknown8);
+            }
+            if (fields & kCompactOverlayFlags) {
+                writer.PutVarint(p.overlayFlags);
+            }
+            if (fields & kCompactDrawMode) {
+                writer.PutVarint(p.overlayDrawMode);
+            }
+        }
+        writer.Finish();
+    }
+
+    bool WriteLegacy(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots) {
+        const TerrainDecalSidecarHeader header{
+            .versionMajor = kLegacyVersionMajor,
+            .versionMinor = kLegacyVersionMinor,
+        };
         const TerrainDecalChunkHeader chunk{
             .tag = kChunkTagTerrainDecals,
             .payloadBytes = static_cast<uint32_t>(snapshots.size() * sizeof(PersistedTerrainDecal)),
@@ -192,11 +963,7 @@ namespace TerrainDecalSidecar {
             .recordCount = static_cast<uint32_t>(snapshots.size()),
         };
 
-        if (!out.SetUint32(header.magic) ||
-            !out.SetUint16(header.versionMajor) ||
-            !out.SetUint16(header.versionMinor) ||
-            !out.SetUint32(header.flags) ||
-            !out.SetUint32(header.chunkCount) ||
+        if (!WriteSidecarHeader(out, header) ||
             !out.SetUint32(chunk.tag) ||
             !out.SetUint32(chunk.payloadBytes) ||
             !out.SetUint32(chunk.recordSize) ||
@@ -204,6 +971,31 @@ namespace TerrainDecalSidecar {
             return false;
         }
 
+        if constexpr (kBlockTransferSupported) {
+            return WriteRecordsAsBlock(out, snapshots) && out.GetError() == 0;
+        }
+
+        return WriteRecordsFieldwise(out, snapshots) && out.GetError() == 0;
+    }
+
+    bool WriteRecordsAsBlock(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots) {
+        std::vector<PersistedTerrainDecal> staging;
+        staging.reserve(std::min<size_t>(kBlockRecords, snapshots.size()));
+        for (size_t first = 0; first < snapshots.size(); first += kBlockRecords) {
+            const size_t last = std::min<size_t>(first + kBlockRecords, snapshots.size());
+            staging.clear();
+            for (size_t i = first; i < last; ++i) {
+                staging.push_back(EncodeSnapshot(snapshots[i]));
+            }
+
+            if (!out.SetVoid(staging.data(), static_cast<uint32_t>(staging.size() * sizeof(PersistedTerrainDecal)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool WriteRecordsFieldwise(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots) {
         for (const TerrainDecalSnapshot& snapshot : snapshots) {
             const PersistedTerrainDecal persisted = EncodeSnapshot(snapshot);
             if (!out.SetUint32(persisted.decalId) ||
@@ -237,7 +1029,7 @@ namespace TerrainDecalSidecar {
             }
         }
 
-        return out.GetError() == 0;
+        return true;
     }
 
     bool DeleteRecord(cIGZPersistDBSegment* const dbSegment) {
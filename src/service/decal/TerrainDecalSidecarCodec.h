@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "cGZPersistResourceKey.h"
@@ -22,9 +23,14 @@ namespace TerrainDecalSidecar
     }
 
     constexpr uint32_t kMagic = FourCC('T', 'D', 'C', 'S');
-    constexpr uint16_t kVersionMajor = 1;
-    constexpr uint16_t kVersionMinor = 1;
+    constexpr uint16_t kVersionMajor = 2;
+    constexpr uint16_t kVersionMinor = 0;
+    // Fixed-size record format every plugin build reads; the default save format, written by WriteLegacy.
+    constexpr uint16_t kLegacyVersionMajor = 1;
+    constexpr uint16_t kLegacyVersionMinor = 1;
     constexpr uint32_t kChunkTagTerrainDecals = FourCC('T', 'D', 'E', 'C');
+    constexpr uint32_t kChunkTagTextureKeys = FourCC('T', 'T', 'E', 'X');
+    constexpr uint32_t kChunkTagCompactDecals = FourCC('T', 'D', 'C', '2');
 
     constexpr uint32_t kSidecarType = 0xE5C2B9A8u;
     constexpr uint32_t kSidecarGroup = FourCC('T', 'D', 'C', 'S');
@@ -47,6 +53,12 @@ namespace TerrainDecalSidecar
         uint32_t recordCount = 0;
     };
 
+    // v2 chunks carry a byte payload instead of a fixed record stride.
+    struct TerrainDecalCompactChunkHeader {
+        uint32_t tag = kChunkTagCompactDecals;
+        uint32_t payloadBytes = 0;
+    };
+
     struct PersistedTerrainDecal {
         uint32_t decalId = 0;
         uint32_t textureType = 0;
@@ -90,7 +102,91 @@ namespace TerrainDecalSidecar
         std::vector<TerrainDecalSnapshot> decals{};
     };
 
-    [[nodiscard]] ReadResult Read(cIGZIStream& in);
-    bool Write(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots);
+    // Bits of the per-record presence mask in a v2 TDC2 chunk. Fields whose bit is clear hold their
+    // PersistedTerrainDecal default; the common ones sit in the low seven bits so the mask stays one byte.
+    enum CompactRecordFields : uint32_t {
+        kCompactCenterFixed = 1u << 0,
+        kCompactSizeFixed = 1u << 1,
+        kCompactRotation = 1u << 2,
+        kCompactOpacity = 1u << 3,
+        kCompactColor = 1u << 4,
+        kCompactDepthOffset = 1u << 5,
+        kCompactHasUvWindow = 1u << 6,
+        kCompactUvWindow = 1u << 7,
+        kCompactDisabled = 1u << 8,
+        kCompactAspect = 1u << 9,
+        kCompactUvScaleU = 1u << 10,
+        kCompactUvScaleV = 1u << 11,
+        kCompactUvOffset = 1u << 12,
+        kCompactUnknown8 = 1u << 13,
+        kCompactOverlayFlags = 1u << 14,
+        kCompactDrawMode = 1u << 15,
+        kCompactKnownFields = (1u << 16) - 1,
+    };
+
+    // Centre and size are stored as fixed point in 1/kCompactFixedPointScale units whenever that is exact.
+    constexpr float kCompactFixedPointScale = 256.0f;
+
+    struct WriteOptions {
+        // Snap centre and size to the fixed-point grid so every record takes the short form. Lossy by up
+        // to half a grid step; off by default so saves round-trip bit for bit.
+        bool quantizeCenterAndSize = false;
+    };
+
+    // Texture keys referenced by the TDC2 chunks of one sidecar, written as its TTEX chunk. Indices never
+    // change once assigned, so an encoded chunk stays valid for as long as its table lives.
+    class TextureKeyTable {
+    public:
+        using Key = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+        uint32_t Intern(const cGZPersistResourceKey& key);
+        void Clear() noexcept;
+
+        [[nodiscard]] const std::vector<Key>& Keys() const noexcept;
+
+    private:
+        [[nodiscard]] static size_t Hash(const Key& key) noexcept;
+        void Grow();
+
+        std::vector<Key> keys_{};
+        // Open-addressed index into keys_, probed linearly. A slot holds index + 1, or 0 when empty, and the
+        // table is kept at most half full. Unlike a node-based map, interning a new key does not allocate.
+        std::vector<uint32_t> slots_{};
+    };
+
+    // Decoding runs on up to kMaxDecodeThreads threads, the caller's included, once a sidecar holds at
+    // least kMinRecordsPerDecodeThread records per extra thread. Each thread decodes whole 1.x record
+    // slices or 2.0 chunks into its own part of ReadResult::decals, so the result and any error are the
+    // same for every thread count.
+    constexpr uint32_t kMaxDecodeThreads = 4;
+    constexpr uint32_t kMinRecordsPerDecodeThread = 8192;
+
+    struct ReadOptions {
+        // 0 picks from std::thread::hardware_concurrency; 1 decodes on the calling thread only.
+        uint32_t decodeThreads = 0;
+    };
+
+    [[nodiscard]] ReadResult Read(cIGZIStream& in, const ReadOptions& options = {});
+    bool Write(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots, const WriteOptions& options = {});
+    bool WriteLegacy(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots);
+
+    // Building blocks for writers that keep encoded chunks between saves. EncodeCompactRecords appends one
+    // TDC2 payload to payload; WriteCompact writes a 2.0 sidecar from the table and previously encoded
+    // payloads, in order.
+    void EncodeCompactRecords(const TerrainDecalSnapshot* snapshots,
+                              size_t count,
+                              TextureKeyTable& textures,
+                              const WriteOptions& options,
+                              std::vector<uint8_t>& payload);
+    bool WriteCompact(cIGZOStream& out,
+                      const TextureKeyTable& textures,
+                      const std::vector<const std::vector<uint8_t>*>& payloads);
+
+    // Record array transfer. The block variants move the whole array with one GetVoid/SetVoid call; the
+    // field-wise ones issue one stream call per field and handle every recordSize Read accepts.
+    bool ReadRecordsAsBlock(cIGZIStream& in, const TerrainDecalChunkHeader& chunk, std::vector<TerrainDecalSnapshot>& decals);
+    bool ReadRecordsFieldwise(cIGZIStream& in, const TerrainDecalChunkHeader& chunk, ReadResult& result);
+    bool WriteRecordsAsBlock(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots);
+    bool WriteRecordsFieldwise(cIGZOStream& out, const std::vector<TerrainDecalSnapshot>& snapshots);
     bool DeleteRecord(cIGZPersistDBSegment* dbSegment);
 }
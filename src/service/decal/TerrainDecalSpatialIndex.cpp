@@ -0,0 +1,340 @@
+#include "TerrainDecalSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace
+{
+    // Keeps tile math well inside int32 for garbage coordinates.
+    constexpr float kMaxCoordinate = 1.0e7f;
+
+    [[nodiscard]] float ClampCoordinate(const float value) noexcept
+    {
+        return std::isfinite(value) ? std::clamp(value, -kMaxCoordinate, kMaxCoordinate) : 0.0f;
+    }
+
+    [[nodiscard]] int32_t TileCoordinate(const float value) noexcept
+    {
+        return static_cast<int32_t>(std::floor(ClampCoordinate(value) / TerrainDecalSpatialIndex::kTileSize));
+    }
+
+    void AppendResult(const uint32_t idValue, TerrainDecalId* const outIds, const uint32_t capacity, uint32_t& count) noexcept
+    {
+        if (outIds && count < capacity) {
+            outIds[count] = TerrainDecalId{idValue};
+        }
+        ++count;
+    }
+}
+
+void TerrainDecalSpatialIndex::Clear() noexcept
+{
+    entries_.clear();
+    tiles_.clear();
+    oversized_.clear();
+    occupiedTiles_ = {};
+}
+
+void TerrainDecalSpatialIndex::Update(const TerrainDecalId id, const cISTEOverlayManager::cDecalInfo& decalInfo)
+{
+    if (id.value == 0) {
+        return;
+    }
+
+    Footprint footprint{};
+    footprint.idValue = id.value;
+    footprint.centerX = ClampCoordinate(decalInfo.center.fX);
+    footprint.centerZ = ClampCoordinate(decalInfo.center.fY);
+    footprint.halfSize = std::isfinite(decalInfo.baseSize)
+                             ? std::clamp(decalInfo.baseSize, 0.0f, kMaxCoordinate) * 0.5f
+                             : 0.0f;
+    const float angle = std::isfinite(decalInfo.rotationTurns)
+                            ? decalInfo.rotationTurns * 2.0f * std::numbers::pi_v<float>
+                            : 0.0f;
+    footprint.cosAngle = std::cos(angle);
+    footprint.sinAngle = std::sin(angle);
+
+    const float extent = footprint.halfSize * (std::abs(footprint.cosAngle) + std::abs(footprint.sinAngle));
+    footprint.minX = footprint.centerX - extent;
+    footprint.minZ = footprint.centerZ - extent;
+    footprint.maxX = footprint.centerX + extent;
+    footprint.maxZ = footprint.centerZ + extent;
+    footprint.tiles = TilesFor(footprint.minX, footprint.minZ, footprint.maxX, footprint.maxZ);
+
+    const auto existing = entries_.find(id.value);
+    if (existing != entries_.end()) {
+        Unlink_(existing->second);
+        existing->second = footprint;
+    }
+    else {
+        entries_.emplace(id.value, footprint);
+    }
+    Link_(footprint);
+}
+
+void TerrainDecalSpatialIndex::Remove(const TerrainDecalId id) noexcept
+{
+    const auto it = entries_.find(id.value);
+    if (it == entries_.end()) {
+        return;
+    }
+
+    Unlink_(it->second);
+    entries_.erase(it);
+}
+
+uint32_t TerrainDecalSpatialIndex::GetCount() const noexcept
+{
+    return static_cast<uint32_t>(entries_.size());
+}
+
+uint32_t TerrainDecalSpatialIndex::QueryRect(const float minX,
+                                             const float minZ,
+                                             const float maxX,
+                                             const float maxZ,
+                                             TerrainDecalId* const outIds,
+                                             const uint32_t capacity) const
+{
+    if (!(minX <= maxX) || !(minZ <= maxZ)) {
+        return 0;
+    }
+
+    const auto overlaps = [&](const Footprint& footprint) {
+        return footprint.minX <= maxX && footprint.maxX >= minX && footprint.minZ <= maxZ && footprint.maxZ >= minZ;
+    };
+
+    uint32_t count = 0;
+    for (const Footprint& footprint : oversized_) {
+        if (overlaps(footprint)) {
+            AppendResult(footprint.idValue, outIds, capacity, count);
+        }
+    }
+
+    if (occupiedTiles_.maxX < occupiedTiles_.minX) {
+        return count;
+    }
+
+    TileRange range = TilesFor(minX, minZ, maxX, maxZ);
+    range.minX = std::max(range.minX, occupiedTiles_.minX);
+    range.minZ = std::max(range.minZ, occupiedTiles_.minZ);
+    range.maxX = std::min(range.maxX, occupiedTiles_.maxX);
+    range.maxZ = std::min(range.maxZ, occupiedTiles_.maxZ);
+
+    for (int32_t tileZ = range.minZ; tileZ <= range.maxZ; ++tileZ) {
+        for (int32_t tileX = range.minX; tileX <= range.maxX; ++tileX) {
+            const auto tile = tiles_.find(TileKey(tileX, tileZ));
+            if (tile == tiles_.end()) {
+                continue;
+            }
+
+            for (const Footprint& footprint : tile->second) {
+                // A decal filed under several scanned tiles is reported from the first one only.
+                const bool firstScannedTile = tileX == std::max(range.minX, footprint.tiles.minX) &&
+                                              tileZ == std::max(range.minZ, footprint.tiles.minZ);
+                if (firstScannedTile && overlaps(footprint)) {
+                    AppendResult(footprint.idValue, outIds, capacity, count);
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+uint32_t TerrainDecalSpatialIndex::QueryPoint(const float x,
+                                              const float z,
+                                              TerrainDecalId* const outIds,
+                                              const uint32_t capacity) const
+{
+    if (!std::isfinite(x) || !std::isfinite(z)) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    for (const Footprint& footprint : oversized_) {
+        if (ContainsPoint(footprint, x, z)) {
+            AppendResult(footprint.idValue, outIds, capacity, count);
+        }
+    }
+
+    // Every decal covering the point is filed under the point's tile, so one bucket is enough.
+    const auto tile = tiles_.find(TileKey(TileCoordinate(x), TileCoordinate(z)));
+    if (tile != tiles_.end()) {
+        for (const Footprint& footprint : tile->second) {
+            if (ContainsPoint(footprint, x, z)) {
+                AppendResult(footprint.idValue, outIds, capacity, count);
+            }
+        }
+    }
+
+    return count;
+}
+
+bool TerrainDecalSpatialIndex::QueryNearest(const float x, const float z, const float maxDistance, TerrainDecalId& outId) const
+{
+    if (!std::isfinite(x) || !std::isfinite(z) || !(maxDistance >= 0.0f)) {
+        return false;
+    }
+
+    float bestDistanceSq = maxDistance * maxDistance;
+    uint32_t bestId = 0;
+    const auto consider = [&](const Footprint& footprint) {
+        const float dx = footprint.centerX - x;
+        const float dz = footprint.centerZ - z;
+        const float distanceSq = dx * dx + dz * dz;
+        if (distanceSq < bestDistanceSq ||
+            (distanceSq == bestDistanceSq && (bestId == 0 || footprint.idValue < bestId))) {
+            bestDistanceSq = distanceSq;
+            bestId = footprint.idValue;
+        }
+    };
+
+    for (const Footprint& footprint : oversized_) {
+        consider(footprint);
+    }
+
+    if (occupiedTiles_.maxX >= occupiedTiles_.minX) {
+        // A decal's center tile is always one of its tiles, so walking rings of tiles around the query
+        // point finds every center. After ring r, any unseen center is at least r tiles away.
+        const int32_t originX = TileCoordinate(x);
+        const int32_t originZ = TileCoordinate(z);
+        const int32_t occupiedReach = std::max({
+            std::abs(originX - occupiedTiles_.minX),
+            std::abs(originX - occupiedTiles_.maxX),
+            std::abs(originZ - occupiedTiles_.minZ),
+            std::abs(originZ - occupiedTiles_.maxZ),
+        });
+        const float distanceReach = std::min(maxDistance / kTileSize, static_cast<float>(occupiedReach)) + 1.0f;
+        const int32_t maxRing = std::min(occupiedReach, static_cast<int32_t>(distanceReach));
+
+        const auto visitTile = [&](const int32_t tileX, const int32_t tileZ) {
+            const auto tile = tiles_.find(TileKey(tileX, tileZ));
+            if (tile == tiles_.end()) {
+                return;
+            }
+            for (const Footprint& footprint : tile->second) {
+                consider(footprint);
+            }
+        };
+
+        for (int32_t ring = 0; ring <= maxRing; ++ring) {
+            if (ring == 0) {
+                visitTile(originX, originZ);
+            }
+            else {
+                for (int32_t offset = -ring; offset <= ring; ++offset) {
+                    visitTile(originX + offset, originZ - ring);
+                    visitTile(originX + offset, originZ + ring);
+                }
+                for (int32_t offset = -ring + 1; offset <= ring - 1; ++offset) {
+                    visitTile(originX - ring, originZ + offset);
+                    visitTile(originX + ring, originZ + offset);
+                }
+            }
+
+            const float ringDistance = static_cast<float>(ring) * kTileSize;
+            if (bestId != 0 && bestDistanceSq <= ringDistance * ringDistance) {
+                break;
+            }
+        }
+    }
+
+    if (bestId == 0) {
+        return false;
+    }
+
+    outId = TerrainDecalId{bestId};
+    return true;
+}
+
+uint64_t TerrainDecalSpatialIndex::TileKey(const int32_t tileX, const int32_t tileZ) noexcept
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(tileX)) << 32) | static_cast<uint32_t>(tileZ);
+}
+
+TerrainDecalSpatialIndex::TileRange TerrainDecalSpatialIndex::TilesFor(const float minX,
+                                                                       const float minZ,
+                                                                       const float maxX,
+                                                                       const float maxZ) noexcept
+{
+    return TileRange{
+        .minX = TileCoordinate(minX),
+        .minZ = TileCoordinate(minZ),
+        .maxX = TileCoordinate(maxX),
+        .maxZ = TileCoordinate(maxZ),
+    };
+}
+
+bool TerrainDecalSpatialIndex::IsOversized(const TileRange& tiles) noexcept
+{
+    const uint64_t tileCount = static_cast<uint64_t>(tiles.maxX - tiles.minX + 1) *
+                               static_cast<uint64_t>(tiles.maxZ - tiles.minZ + 1);
+    return tileCount > kMaxTilesPerDecal;
+}
+
+bool TerrainDecalSpatialIndex::ContainsPoint(const Footprint& footprint, const float x, const float z) noexcept
+{
+    const float dx = x - footprint.centerX;
+    const float dz = z - footprint.centerZ;
+    const float u = dx * footprint.cosAngle + dz * footprint.sinAngle;
+    const float v = dz * footprint.cosAngle - dx * footprint.sinAngle;
+    return std::abs(u) <= footprint.halfSize && std::abs(v) <= footprint.halfSize;
+}
+
+void TerrainDecalSpatialIndex::Link_(const Footprint& footprint)
+{
+    if (IsOversized(footprint.tiles)) {
+        oversized_.push_back(footprint);
+        return;
+    }
+
+    const TileRange& tiles = footprint.tiles;
+    for (int32_t tileZ = tiles.minZ; tileZ <= tiles.maxZ; ++tileZ) {
+        for (int32_t tileX = tiles.minX; tileX <= tiles.maxX; ++tileX) {
+            tiles_[TileKey(tileX, tileZ)].push_back(footprint);
+        }
+    }
+
+    if (occupiedTiles_.maxX < occupiedTiles_.minX) {
+        occupiedTiles_ = tiles;
+    }
+    else {
+        occupiedTiles_.minX = std::min(occupiedTiles_.minX, tiles.minX);
+        occupiedTiles_.minZ = std::min(occupiedTiles_.minZ, tiles.minZ);
+        occupiedTiles_.maxX = std::max(occupiedTiles_.maxX, tiles.maxX);
+        occupiedTiles_.maxZ = std::max(occupiedTiles_.maxZ, tiles.maxZ);
+    }
+}
+
+void TerrainDecalSpatialIndex::Unlink_(const Footprint& footprint) noexcept
+{
+    const auto eraseFrom = [idValue = footprint.idValue](std::vector<Footprint>& bucket) {
+        const auto it = std::find_if(bucket.begin(), bucket.end(), [idValue](const Footprint& candidate) {
+            return candidate.idValue == idValue;
+        });
+        if (it != bucket.end()) {
+            *it = bucket.back();
+            bucket.pop_back();
+        }
+    };
+
+    if (IsOversized(footprint.tiles)) {
+        eraseFrom(oversized_);
+        return;
+    }
+
+    const TileRange& tiles = footprint.tiles;
+    for (int32_t tileZ = tiles.minZ; tileZ <= tiles.maxZ; ++tileZ) {
+        for (int32_t tileX = tiles.minX; tileX <= tiles.maxX; ++tileX) {
+            const auto tile = tiles_.find(TileKey(tileX, tileZ));
+            if (tile == tiles_.end()) {
+                continue;
+            }
+            eraseFrom(tile->second);
+            if (tile->second.empty()) {
+                tiles_.erase(tile);
+            }
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "public/cIGZTerrainDecalService.h"
+
+// Uniform grid over 16 m SC4 tiles. Each decal is filed under every tile its footprint bounds touch, so
+// queries only visit tiles they overlap. The footprint is the decal's base square (center, baseSize,
+// rotationTurns); UV modifiers are not taken into account.
+class TerrainDecalSpatialIndex {
+public:
+    static constexpr float kTileSize = 16.0f;
+    // Decals spanning more tiles than this are kept in a side list that every query scans.
+    static constexpr uint32_t kMaxTilesPerDecal = 256;
+
+    void Clear() noexcept;
+
+    // Inserts or moves a decal.
+    void Update(TerrainDecalId id, const cISTEOverlayManager::cDecalInfo& decalInfo);
+    void Remove(TerrainDecalId id) noexcept;
+
+    [[nodiscard]] uint32_t GetCount() const noexcept;
+
+    // Each query returns the total number of matches and writes up to capacity ids, in no particular order.
+    // Rect queries test the footprint's axis-aligned bounds.
+    uint32_t QueryRect(float minX, float minZ, float maxX, float maxZ, TerrainDecalId* outIds, uint32_t capacity) const;
+    uint32_t QueryPoint(float x, float z, TerrainDecalId* outIds, uint32_t capacity) const;
+    // Nearest footprint center within maxDistance.
+    [[nodiscard]] bool QueryNearest(float x, float z, float maxDistance, TerrainDecalId& outId) const;
+
+private:
+    struct TileRange {
+        int32_t minX = 0;
+        int32_t minZ = 0;
+        int32_t maxX = -1;
+        int32_t maxZ = -1;
+    };
+
+    // Copied into every tile bucket so queries never leave the bucket they are scanning.
+    struct Footprint {
+        uint32_t idValue = 0;
+        float centerX = 0.0f;
+        float centerZ = 0.0f;
+        float halfSize = 0.0f;
+        float cosAngle = 1.0f;
+        float sinAngle = 0.0f;
+        float minX = 0.0f;
+        float minZ = 0.0f;
+        float maxX = 0.0f;
+        float maxZ = 0.0f;
+        TileRange tiles{};
+    };
+
+    [[nodiscard]] static uint64_t TileKey(int32_t tileX, int32_t tileZ) noexcept;
+    [[nodiscard]] static TileRange TilesFor(float minX, float minZ, float maxX, float maxZ) noexcept;
+    [[nodiscard]] static bool IsOversized(const TileRange& tiles) noexcept;
+    [[nodiscard]] static bool ContainsPoint(const Footprint& footprint, float x, float z) noexcept;
+    void Link_(const Footprint& footprint);
+    void Unlink_(const Footprint& footprint) noexcept;
+
+    std::unordered_map<uint32_t, Footprint> entries_{};
+    std::unordered_map<uint64_t, std::vector<Footprint>> tiles_{};
+    std::vector<Footprint> oversized_{};
+    TileRange occupiedTiles_{};
+};
@@ -0,0 +1,79 @@
+#include "TerrainGridView.h"
+
+namespace TerrainDecal
+{
+    namespace
+    {
+        [[nodiscard]] const RowTableEntry* ReadRowTable(const uintptr_t globalAddress) noexcept
+        {
+            if (globalAddress == 0) {
+                return nullptr;
+            }
+
+            return *reinterpret_cast<const RowTableEntry* const*>(globalAddress);
+        }
+
+        [[nodiscard]] const PackedTerrainVertex* GetTerrainVertexArray(const uintptr_t globalAddress) noexcept
+        {
+            if (globalAddress == 0) {
+                return nullptr;
+            }
+
+            return *reinterpret_cast<const PackedTerrainVertex* const*>(globalAddress);
+        }
+
+        [[nodiscard]] const uint16_t* ReadAllLevelCellIndices(const uintptr_t globalAddress) noexcept
+        {
+            if (globalAddress == 0) {
+                return nullptr;
+            }
+
+            return reinterpret_cast<const uint16_t*>(*reinterpret_cast<const void* const*>(globalAddress));
+        }
+    }
+
+    TerrainGridDimensions ReadTerrainGridDimensions(const HookAddresses& addresses) noexcept
+    {
+        TerrainGridDimensions result{};
+        if (addresses.terrainCellCountXPtr != 0) {
+            result.cellCountX = *reinterpret_cast<const int*>(addresses.terrainCellCountXPtr);
+        }
+
+        if (addresses.terrainCellCountZPtr != 0) {
+            result.cellCountZ = *reinterpret_cast<const int*>(addresses.terrainCellCountZPtr);
+        }
+
+        if (addresses.terrainVertexCountXPtr != 0) {
+            result.vertexCountX = *reinterpret_cast<const int*>(addresses.terrainVertexCountXPtr);
+        }
+
+        if (addresses.terrainVertexCountZPtr != 0) {
+            result.vertexCountZ = *reinterpret_cast<const int*>(addresses.terrainVertexCountZPtr);
+        }
+
+        if (addresses.terrainVertexCountPtr != 0) {
+            result.vertexCount = *reinterpret_cast<const int*>(addresses.terrainVertexCountPtr);
+        }
+
+        if (result.vertexCountZ <= 0 && result.vertexCountX > 0 && result.vertexCount > 0) {
+            result.vertexCountZ = result.vertexCount / result.vertexCountX;
+        }
+
+        return result;
+    }
+
+    TerrainGridView CaptureTerrainGridView(const HookAddresses& addresses) noexcept
+    {
+        TerrainGridView view{};
+        view.dimensions = ReadTerrainGridDimensions(addresses);
+        view.vertices = GetTerrainVertexArray(addresses.terrainGridVerticesPtr);
+        view.rows = ReadRowTable(addresses.terrainCellInfoRowsPtr);
+        view.allLevelCellIndices = ReadAllLevelCellIndices(addresses.allLevelCellIndicesPtr);
+
+        const TerrainGridDimensions& dimensions = view.dimensions;
+        view.valid = dimensions.cellCountX > 0 && dimensions.cellCountZ > 0 &&
+                     dimensions.vertexCountX > 0 && dimensions.vertexCountZ > 0 && dimensions.vertexCount > 0 &&
+                     view.vertices && view.rows && view.allLevelCellIndices;
+        return view;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TerrainDecalGeometry.h"
+#include "TerrainDecalSymbols.h"
+
+namespace TerrainDecal
+{
+    struct TerrainGridDimensions
+    {
+        int cellCountX = 0;
+        int cellCountZ = 0;
+        int vertexCountX = 0;
+        int vertexCountZ = 0;
+        int vertexCount = 0;
+    };
+
+    // Leveled cell entry in a row of sLevelCellInfos.
+    struct CellInfoEntry
+    {
+        int vertexIndex;
+        uint32_t flatYBits;
+    };
+
+    struct RowTableEntry
+    {
+        const std::byte* data;
+        uint32_t unknown1;
+        uint32_t unknown2;
+    };
+
+    // The terrain globals behind HookAddresses, read once so per-cell code only indexes arrays.
+    struct TerrainGridView
+    {
+        TerrainGridDimensions dimensions{};
+        const PackedTerrainVertex* vertices = nullptr;
+        const RowTableEntry* rows = nullptr;
+        const uint16_t* allLevelCellIndices = nullptr;
+        // Every count is positive and every array is present.
+        bool valid = false;
+    };
+
+    [[nodiscard]] TerrainGridDimensions ReadTerrainGridDimensions(const HookAddresses& addresses) noexcept;
+    [[nodiscard]] TerrainGridView CaptureTerrainGridView(const HookAddresses& addresses) noexcept;
+
+    [[nodiscard]] inline const CellInfoEntry* GetCellInfoRow(const RowTableEntry* const rows, const int row) noexcept
+    {
+        if (!rows || row < 0) {
+            return nullptr;
+        }
+
+        return reinterpret_cast<const CellInfoEntry*>(rows[row].data);
+    }
+
+    // sAllLevelCellIndices maps a cell to an optional leveled entry in its row; grid must be valid.
+    [[nodiscard]] inline bool IsLeveledTerrainCell(const TerrainGridView& grid, const int cellX, const int cellZ) noexcept
+    {
+        const int levelIndexBase = (grid.dimensions.cellCountX + 1) * cellZ;
+        return grid.allLevelCellIndices[levelIndexBase + cellX] < grid.allLevelCellIndices[levelIndexBase + cellX + 1];
+    }
+}
@@ -0,0 +1,196 @@
+#include "TerrainRevisionTracker.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace TerrainDecal
+{
+    namespace
+    {
+        constexpr uint64_t kFnvOffsetBasis = 0xCBF29CE484222325ull;
+        constexpr uint64_t kFnvPrime = 0x100000001B3ull;
+
+        // FNV-1a over whole 32-bit words; heights are compared bit for bit, not by value.
+        void HashWord(uint64_t& hash, const uint32_t word) noexcept
+        {
+            hash ^= word;
+            hash *= kFnvPrime;
+        }
+
+        [[nodiscard]] bool SameDimensions(const TerrainGridDimensions& a, const TerrainGridDimensions& b) noexcept
+        {
+            return a.cellCountX == b.cellCountX &&
+                   a.cellCountZ == b.cellCountZ &&
+                   a.vertexCountX == b.vertexCountX &&
+                   a.vertexCountZ == b.vertexCountZ &&
+                   a.vertexCount == b.vertexCount;
+        }
+    }
+
+    uint32_t TerrainRevisionTracker::Update(const TerrainGridView& grid, const uint32_t blockBudget)
+    {
+        if (!grid.valid) {
+            if (vertices_) {
+                Reset();
+            }
+            return 0;
+        }
+
+        if (grid.vertices != vertices_ || !SameDimensions(grid.dimensions, dimensions_)) {
+            Rebaseline_(grid);
+            return static_cast<uint32_t>(blockHashes_.size());
+        }
+
+        const size_t blockCount = blockHashes_.size();
+        const size_t blocksToHash = blockBudget == 0 ? blockCount : std::min<size_t>(blockBudget, blockCount);
+        uint32_t changedBlocks = 0;
+        for (size_t i = 0; i < blocksToHash; ++i) {
+            const size_t block = cursor_;
+            cursor_ = cursor_ + 1 < blockCount ? cursor_ + 1 : 0;
+
+            const int blockX = static_cast<int>(block % static_cast<size_t>(blockCountX_));
+            const int blockZ = static_cast<int>(block / static_cast<size_t>(blockCountX_));
+            const uint64_t hash = HashBlock_(grid, blockX, blockZ);
+            if (hash != blockHashes_[block]) {
+                if (changedBlocks == 0) {
+                    ++revision_;
+                }
+                blockHashes_[block] = hash;
+                blockRevisions_[block] = revision_;
+                ++changedBlocks;
+            }
+        }
+
+        return changedBlocks;
+    }
+
+    void TerrainRevisionTracker::Reset() noexcept
+    {
+        vertices_ = nullptr;
+        dimensions_ = {};
+        blockCountX_ = 0;
+        blockCountZ_ = 0;
+        blockHashes_.clear();
+        blockRevisions_.clear();
+        cursor_ = 0;
+    }
+
+    uint64_t TerrainRevisionTracker::GetRevision() const noexcept
+    {
+        return revision_;
+    }
+
+    uint64_t TerrainRevisionTracker::GetRevisionForCells(const int xStart,
+                                                         const int zStart,
+                                                         const int xEnd,
+                                                         const int zEnd) const noexcept
+    {
+        if (blockRevisions_.empty()) {
+            return revision_;
+        }
+
+        const int firstBlockX = std::max(xStart, 0) / kBlockCells;
+        const int firstBlockZ = std::max(zStart, 0) / kBlockCells;
+        const int lastBlockX = std::min((std::max(xEnd, 1) - 1) / kBlockCells, blockCountX_ - 1);
+        const int lastBlockZ = std::min((std::max(zEnd, 1) - 1) / kBlockCells, blockCountZ_ - 1);
+        if (firstBlockX > lastBlockX || firstBlockZ > lastBlockZ) {
+            return revision_;
+        }
+
+        uint64_t result = 0;
+        for (int blockZ = firstBlockZ; blockZ <= lastBlockZ; ++blockZ) {
+            const uint64_t* const row = blockRevisions_.data() + static_cast<size_t>(blockZ) * blockCountX_;
+            for (int blockX = firstBlockX; blockX <= lastBlockX; ++blockX) {
+                result = std::max(result, row[blockX]);
+            }
+        }
+        return result;
+    }
+
+    int TerrainRevisionTracker::GetBlockCountX() const noexcept
+    {
+        return blockCountX_;
+    }
+
+    int TerrainRevisionTracker::GetBlockCountZ() const noexcept
+    {
+        return blockCountZ_;
+    }
+
+    uint64_t TerrainRevisionTracker::HashCells(const TerrainGridView& grid,
+                                               const int xStart,
+                                               const int zStart,
+                                               const int xEnd,
+                                               const int zEnd) noexcept
+    {
+        const TerrainGridDimensions& dimensions = grid.dimensions;
+        const int cellXStart = std::max(xStart, 0);
+        const int cellZStart = std::max(zStart, 0);
+        const int cellXEnd = std::min(xEnd, dimensions.cellCountX);
+        const int cellZEnd = std::min(zEnd, dimensions.cellCountZ);
+
+        // Corner vertices are shared with the neighbouring rects, so an edge edit changes both sides.
+        uint64_t hash = kFnvOffsetBasis;
+        if (cellXStart >= cellXEnd || cellZStart >= cellZEnd) {
+            return hash;
+        }
+        const int vertexXEnd = std::min(cellXEnd, dimensions.vertexCountX - 1);
+        const int vertexZEnd = std::min(cellZEnd, dimensions.vertexCountZ - 1);
+        for (int z = cellZStart; z <= vertexZEnd; ++z) {
+            const int rowBase = z * dimensions.vertexCountX;
+            for (int x = cellXStart; x <= vertexXEnd; ++x) {
+                const int index = rowBase + x;
+                if (index >= dimensions.vertexCount) {
+                    break;
+                }
+                HashWord(hash, std::bit_cast<uint32_t>(grid.vertices[index].y));
+            }
+        }
+
+        for (int cellZ = cellZStart; cellZ < cellZEnd; ++cellZ) {
+            const int levelIndexBase = (dimensions.cellCountX + 1) * cellZ;
+            const uint16_t entryStart = grid.allLevelCellIndices[levelIndexBase + cellXStart];
+            const uint16_t entryEnd = grid.allLevelCellIndices[levelIndexBase + cellXEnd];
+            if (entryStart >= entryEnd) {
+                continue;
+            }
+
+            const CellInfoEntry* const row = GetCellInfoRow(grid.rows, cellZ);
+            if (!row) {
+                continue;
+            }
+            for (uint16_t entry = entryStart; entry < entryEnd; ++entry) {
+                HashWord(hash, static_cast<uint32_t>(row[entry].vertexIndex));
+                HashWord(hash, row[entry].flatYBits);
+            }
+        }
+
+        return hash;
+    }
+
+    uint64_t TerrainRevisionTracker::HashBlock_(const TerrainGridView& grid, const int blockX, const int blockZ) const noexcept
+    {
+        const int cellXStart = blockX * kBlockCells;
+        const int cellZStart = blockZ * kBlockCells;
+        return HashCells(grid, cellXStart, cellZStart, cellXStart + kBlockCells, cellZStart + kBlockCells);
+    }
+
+    void TerrainRevisionTracker::Rebaseline_(const TerrainGridView& grid)
+    {
+        vertices_ = grid.vertices;
+        dimensions_ = grid.dimensions;
+        blockCountX_ = (dimensions_.cellCountX + kBlockCells - 1) / kBlockCells;
+        blockCountZ_ = (dimensions_.cellCountZ + kBlockCells - 1) / kBlockCells;
+        cursor_ = 0;
+        ++revision_;
+
+        const size_t blockCount = static_cast<size_t>(blockCountX_) * blockCountZ_;
+        blockHashes_.resize(blockCount);
+        blockRevisions_.assign(blockCount, revision_);
+        for (int blockZ = 0; blockZ < blockCountZ_; ++blockZ) {
+            for (int blockX = 0; blockX < blockCountX_; ++blockX) {
+                blockHashes_[static_cast<size_t>(blockZ) * blockCountX_ + blockX] = HashBlock_(grid, blockX, blockZ);
+            }
+        }
+    }
+}
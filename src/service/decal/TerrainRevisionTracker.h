@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TerrainGridView.h"
+
+namespace TerrainDecal
+{
+    // Tracks which parts of the terrain grid changed height. The grid is split into blocks of
+    // kBlockCells x kBlockCells cells, and each block hashes its vertex heights plus the flattened
+    // heights of its leveled cells. A block whose hash changes takes the next revision number.
+    // Revisions only grow, so the highest revision under some geometry changes exactly when the
+    // ground under it does.
+    class TerrainRevisionTracker final
+    {
+    public:
+        static constexpr int kBlockCells = 16;
+
+        // Hashes at most blockBudget blocks, continuing round-robin from the previous call; 0 hashes
+        // every block. The first update after Reset, or after the grid changes size or moves, hashes
+        // every block and moves all of them to a new revision. Returns the number of blocks whose
+        // heights changed.
+        uint32_t Update(const TerrainGridView& grid, uint32_t blockBudget);
+        // Forgets the grid. Revision numbers keep growing across resets.
+        void Reset() noexcept;
+
+        // Bumped whenever any block changes.
+        [[nodiscard]] uint64_t GetRevision() const noexcept;
+        // Highest block revision over cells [xStart, xEnd) x [zStart, zEnd), clamped to the grid. Before
+        // the first update, or for a rect outside the grid, this is GetRevision().
+        [[nodiscard]] uint64_t GetRevisionForCells(int xStart, int zStart, int xEnd, int zEnd) const noexcept;
+        [[nodiscard]] int GetBlockCountX() const noexcept;
+        [[nodiscard]] int GetBlockCountZ() const noexcept;
+
+        // Hash of the heights a block hash covers, limited to cells [xStart, xEnd) x [zStart, zEnd) and
+        // clamped to the grid. Costs one load per vertex and leveled entry under the rect, without
+        // touching the tracker, so callers can check small rects every frame.
+        [[nodiscard]] static uint64_t HashCells(const TerrainGridView& grid, int xStart, int zStart, int xEnd, int zEnd) noexcept;
+
+    private:
+        [[nodiscard]] uint64_t HashBlock_(const TerrainGridView& grid, int blockX, int blockZ) const noexcept;
+        void Rebaseline_(const TerrainGridView& grid);
+
+    private:
+        const PackedTerrainVertex* vertices_ = nullptr;
+        TerrainGridDimensions dimensions_{};
+        int blockCountX_ = 0;
+        int blockCountZ_ = 0;
+        std::vector<uint64_t> blockHashes_{};
+        std::vector<uint64_t> blockRevisions_{};
+        size_t cursor_ = 0;
+        uint64_t revision_ = 0;
+    };
+}
@@ -35,6 +35,17 @@ namespace {
     constexpr float kDefaultTerrainDecalShadowRecoveryOpacityScale = 0.25f;
     constexpr float kMinTerrainDecalShadowRecoveryOpacityScale = 0.0f;
     constexpr float kMaxTerrainDecalShadowRecoveryOpacityScale = 1.0f;
+    constexpr int kDefaultTerrainDecalGeometryCacheBudgetKB = 4096;
+    constexpr int kMinTerrainDecalGeometryCacheBudgetKB = 0;
+    constexpr int kMaxTerrainDecalGeometryCacheBudgetKB = 262144;
+    constexpr bool kDefaultTerrainDecalIndexedSubmission = false;
+    constexpr int kDefaultTerrainDecalRebindBudgetMs = 4;
+    constexpr int kMinTerrainDecalRebindBudgetMs = 0;
+    constexpr int kMaxTerrainDecalRebindBudgetMs = 1000;
+    constexpr int kDefaultTerrainDecalRebindBudgetCount = 0;
+    constexpr int kMinTerrainDecalRebindBudgetCount = 0;
+    constexpr int kMaxTerrainDecalRebindBudgetCount = 1000000;
+    const std::string kDefaultTerrainDecalSidecarFormat = "1.1";
 
     const std::string kDefaultTheme = "dark";
     const std::string kSectionName = "SC4RenderServices";
@@ -124,7 +135,12 @@ Settings::Settings()
     , enableTerrainDecalService_(kDefaultEnableTerrainDecalService)
     , enableCustomTerrainDecalRenderer_(kDefaultEnableCustomTerrainDecalRenderer)
     , terrainDecalCustomDefaultDepthOffset_(kDefaultTerrainDecalCustomDefaultDepthOffset)
-    , terrainDecalShadowRecoveryOpacityScale_(kDefaultTerrainDecalShadowRecoveryOpacityScale) {}
+    , terrainDecalShadowRecoveryOpacityScale_(kDefaultTerrainDecalShadowRecoveryOpacityScale)
+    , terrainDecalGeometryCacheBudgetKB_(kDefaultTerrainDecalGeometryCacheBudgetKB)
+    , terrainDecalIndexedSubmission_(kDefaultTerrainDecalIndexedSubmission)
+    , terrainDecalRebindBudgetMs_(kDefaultTerrainDecalRebindBudgetMs)
+    , terrainDecalRebindBudgetCount_(kDefaultTerrainDecalRebindBudgetCount)
+    , terrainDecalSidecarFormat_(kDefaultTerrainDecalSidecarFormat) {}
 
 void Settings::Load(const std::filesystem::path& settingsFilePath) {
     // Reset to defaults
@@ -354,6 +370,90 @@ void Settings::Load(const std::filesystem::path& settingsFilePath) {
                 }
             }
         }
+
+        // TerrainDecalGeometryCacheBudgetKB
+        if (section.has("TerrainDecalGeometryCacheBudgetKB")) {
+            bool valid = false;
+            const std::string text = section.get("TerrainDecalGeometryCacheBudgetKB");
+            const int parsed = ParseInt(text, valid);
+            if (!valid) {
+                LOG_ERROR("Invalid TerrainDecalGeometryCacheBudgetKB value '{}' in {}. Using default {}.",
+                         text, settingsFilePath.string(), kDefaultTerrainDecalGeometryCacheBudgetKB);
+            } else {
+                terrainDecalGeometryCacheBudgetKB_ =
+                    std::clamp(parsed, kMinTerrainDecalGeometryCacheBudgetKB, kMaxTerrainDecalGeometryCacheBudgetKB);
+                if (terrainDecalGeometryCacheBudgetKB_ != parsed) {
+                    LOG_WARN("TerrainDecalGeometryCacheBudgetKB value {} out of range [{}, {}], clamped to {}.",
+                             parsed,
+                             kMinTerrainDecalGeometryCacheBudgetKB,
+                             kMaxTerrainDecalGeometryCacheBudgetKB,
+                             terrainDecalGeometryCacheBudgetKB_);
+                }
+            }
+        }
+
+        // TerrainDecalIndexedSubmission
+        if (section.has("TerrainDecalIndexedSubmission")) {
+            bool valid = false;
+            const std::string text = section.get("TerrainDecalIndexedSubmission");
+            terrainDecalIndexedSubmission_ = ParseBool(text, valid);
+            if (!valid) {
+                terrainDecalIndexedSubmission_ = kDefaultTerrainDecalIndexedSubmission;
+                LOG_ERROR("Invalid TerrainDecalIndexedSubmission value '{}' in {}. Using default false.", text, settingsFilePath.string());
+            }
+        }
+
+        // TerrainDecalRebindBudgetMs
+        if (section.has("TerrainDecalRebindBudgetMs")) {
+            bool valid = false;
+            const std::string text = section.get("TerrainDecalRebindBudgetMs");
+            const int parsed = ParseInt(text, valid);
+            if (!valid) {
+                LOG_ERROR("Invalid TerrainDecalRebindBudgetMs value '{}' in {}. Using default {}.",
+                         text, settingsFilePath.string(), kDefaultTerrainDecalRebindBudgetMs);
+            } else {
+                terrainDecalRebindBudgetMs_ =
+                    std::clamp(parsed, kMinTerrainDecalRebindBudgetMs, kMaxTerrainDecalRebindBudgetMs);
+                if (terrainDecalRebindBudgetMs_ != parsed) {
+                    LOG_WARN("TerrainDecalRebindBudgetMs value {} out of range [{}, {}], clamped to {}.",
+                             parsed,
+                             kMinTerrainDecalRebindBudgetMs,
+                             kMaxTerrainDecalRebindBudgetMs,
+                             terrainDecalRebindBudgetMs_);
+                }
+            }
+        }
+
+        // TerrainDecalRebindBudgetCount
+        if (section.has("TerrainDecalRebindBudgetCount")) {
+            bool valid = false;
+            const std::string text = section.get("TerrainDecalRebindBudgetCount");
+            const int parsed = ParseInt(text, valid);
+            if (!valid) {
+                LOG_ERROR("Invalid TerrainDecalRebindBudgetCount value '{}' in {}. Using default {}.",
+                         text, settingsFilePath.string(), kDefaultTerrainDecalRebindBudgetCount);
+            } else {
+                terrainDecalRebindBudgetCount_ =
+                    std::clamp(parsed, kMinTerrainDecalRebindBudgetCount, kMaxTerrainDecalRebindBudgetCount);
+                if (terrainDecalRebindBudgetCount_ != parsed) {
+                    LOG_WARN("TerrainDecalRebindBudgetCount value {} out of range [{}, {}], clamped to {}.",
+                             parsed,
+                             kMinTerrainDecalRebindBudgetCount,
+                             kMaxTerrainDecalRebindBudgetCount,
+                             terrainDecalRebindBudgetCount_);
+                }
+            }
+        }
+
+        // TerrainDecalSidecarFormat
+        if (section.has("TerrainDecalSidecarFormat")) {
+            const std::string text = section.get("TerrainDecalSidecarFormat");
+            if (text == "1.1" || text == "2.0") {
+                terrainDecalSidecarFormat_ = text;
+            } else {
+                LOG_ERROR("Invalid TerrainDecalSidecarFormat value '{}' in {}. Using default 1.1.", text, settingsFilePath.string());
+            }
+        }
     }
     catch (const std::exception& e) {
         LOG_ERROR("Error reading settings file {}: {}", settingsFilePath.string(), e.what());
@@ -377,3 +477,8 @@ bool Settings::GetEnableTerrainDecalService() const noexcept { return enableTerr
 bool Settings::GetEnableCustomTerrainDecalRenderer() const noexcept { return enableCustomTerrainDecalRenderer_; }
 int Settings::GetTerrainDecalCustomDefaultDepthOffset() const noexcept { return terrainDecalCustomDefaultDepthOffset_; }
 float Settings::GetTerrainDecalShadowRecoveryOpacityScale() const noexcept { return terrainDecalShadowRecoveryOpacityScale_; }
+int Settings::GetTerrainDecalGeometryCacheBudgetKB() const noexcept { return terrainDecalGeometryCacheBudgetKB_; }
+bool Settings::GetTerrainDecalIndexedSubmission() const noexcept { return terrainDecalIndexedSubmission_; }
+int Settings::GetTerrainDecalRebindBudgetMs() const noexcept { return terrainDecalRebindBudgetMs_; }
+int Settings::GetTerrainDecalRebindBudgetCount() const noexcept { return terrainDecalRebindBudgetCount_; }
+std::string Settings::GetTerrainDecalSidecarFormat() const noexcept { return terrainDecalSidecarFormat_; }
@@ -33,6 +33,11 @@ public:
     [[nodiscard]] bool GetEnableCustomTerrainDecalRenderer() const noexcept;
     [[nodiscard]] int GetTerrainDecalCustomDefaultDepthOffset() const noexcept;
     [[nodiscard]] float GetTerrainDecalShadowRecoveryOpacityScale() const noexcept;
+    [[nodiscard]] int GetTerrainDecalGeometryCacheBudgetKB() const noexcept;
+    [[nodiscard]] bool GetTerrainDecalIndexedSubmission() const noexcept;
+    [[nodiscard]] int GetTerrainDecalRebindBudgetMs() const noexcept;
+    [[nodiscard]] int GetTerrainDecalRebindBudgetCount() const noexcept;
+    [[nodiscard]] std::string GetTerrainDecalSidecarFormat() const noexcept;
 
 private:
     spdlog::level::level_enum logLevel_;
@@ -51,4 +56,9 @@ private:
     bool enableCustomTerrainDecalRenderer_;
     int terrainDecalCustomDefaultDepthOffset_;
     float terrainDecalShadowRecoveryOpacityScale_;
+    int terrainDecalGeometryCacheBudgetKB_;
+    bool terrainDecalIndexedSubmission_;
+    int terrainDecalRebindBudgetMs_;
+    int terrainDecalRebindBudgetCount_;
+    std::string terrainDecalSidecarFormat_;
 };
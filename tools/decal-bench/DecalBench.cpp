@@ -0,0 +1,794 @@
+// Host-side benchmark harness for ClippedTerrainDecalRenderer.
+//
+// The renderer only touches the game through HookAddresses: terrain globals are read through
+// pointers and drawing goes through function addresses. This harness points those at a synthetic
+// terrain grid and recording draw stubs, so the geometry core runs unmodified outside the game.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <vector>
+
+#include <spdlog/sinks/null_sink.h>
+
+#include "ClippedTerrainDecalRenderer.h"
+#include "TerrainGridView.h"
+#include "TerrainRevisionTracker.h"
+#include "utils/Logger.h"
+
+class SC4DrawContext
+{
+};
+
+std::shared_ptr<spdlog::logger> Logger::Get()
+{
+    static const auto logger =
+        std::make_shared<spdlog::logger>("SC4DecalBench", std::make_shared<spdlog::sinks::null_sink_mt>());
+    return logger;
+}
+
+namespace
+{
+    std::atomic<uint64_t> gAllocationCount{0};
+}
+
+void* operator new(const std::size_t size)
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* const block = std::malloc(size == 0 ? 1 : size)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+namespace
+{
+    using TerrainDecal::PackedTerrainVertex;
+
+    constexpr float kCellSize = 16.0f;
+    constexpr std::ptrdiff_t kOverlaySlotsPtrOffset = 0x98;
+    constexpr std::ptrdiff_t kOverlaySlotStride = 0xB4;
+    constexpr std::ptrdiff_t kOverlayRectOffset = 0x0C;
+    constexpr std::ptrdiff_t kOverlayMatrixOffset = 0x1C;
+    constexpr std::ptrdiff_t kOverlayOpacityOffset = 0x9C;
+    constexpr uint32_t kOverlayId = 1;
+    constexpr uint32_t kOverlaySlotCount = 4;
+
+    // Mirrors the layouts the renderer reads through terrainCellInfoRowsPtr.
+    struct HostRowTableEntry
+    {
+        const std::byte* data;
+        uint32_t unknown1;
+        uint32_t unknown2;
+    };
+
+    struct HostCellInfoEntry
+    {
+        int vertexIndex;
+        uint32_t flatYBits;
+    };
+
+    // Stand-in for the game's terrain globals. Heights roll gently and one block of cells is
+    // leveled, so both the shared-row sweep and the per-cell leveled path are exercised.
+    class SyntheticTerrain
+    {
+    public:
+        explicit SyntheticTerrain(const int cellCount)
+            : cellCountX_(cellCount)
+            , cellCountZ_(cellCount)
+            , vertexCountX_(cellCount + 1)
+            , vertexCountZ_(cellCount + 1)
+            , vertexCount_((cellCount + 1) * (cellCount + 1))
+            , leveledStart_(cellCount / 4)
+            , leveledEnd_(leveledStart_ + std::max(1, cellCount / 16))
+        {
+            vertices_.resize(static_cast<size_t>(vertexCount_));
+            for (int z = 0; z < vertexCountZ_; ++z) {
+                for (int x = 0; x < vertexCountX_; ++x) {
+                    auto& vertex = vertices_[static_cast<size_t>(z) * vertexCountX_ + x];
+                    vertex = {};
+                    vertex.x = static_cast<float>(x) * kCellSize;
+                    vertex.y = 250.0f + 12.0f * std::sin(static_cast<float>(x) * 0.21f) *
+                                            std::cos(static_cast<float>(z) * 0.17f);
+                    vertex.z = static_cast<float>(z) * kCellSize;
+                    vertex.diffuse = 0xFFFFFFFFu;
+                }
+            }
+
+            const uint32_t flatYBits = std::bit_cast<uint32_t>(255.0f);
+            cellInfos_.resize(static_cast<size_t>(cellCountZ_));
+            rows_.resize(static_cast<size_t>(cellCountZ_));
+            levelCellIndices_.assign(static_cast<size_t>(cellCountX_ + 1) * cellCountZ_ + 1, 0);
+            for (int z = 0; z < cellCountZ_; ++z) {
+                auto& infos = cellInfos_[static_cast<size_t>(z)];
+                const size_t rowBase = static_cast<size_t>(cellCountX_ + 1) * z;
+                for (int x = 0; x <= cellCountX_; ++x) {
+                    levelCellIndices_[rowBase + x] = static_cast<uint16_t>(infos.size());
+                    const bool leveled = x < cellCountX_ &&
+                                         x >= leveledStart_ && x < leveledEnd_ &&
+                                         z >= leveledStart_ && z < leveledEnd_;
+                    if (leveled) {
+                        infos.push_back({.vertexIndex = x, .flatYBits = flatYBits});
+                    }
+                }
+                rows_[static_cast<size_t>(z)] = {
+                    .data = reinterpret_cast<const std::byte*>(infos.data()),
+                    .unknown1 = 0,
+                    .unknown2 = 0,
+                };
+            }
+
+            verticesPtr_ = vertices_.data();
+            rowsPtr_ = rows_.data();
+            levelCellIndicesPtr_ = levelCellIndices_.data();
+        }
+
+        void Bind(TerrainDecal::HookAddresses& addresses) const noexcept
+        {
+            addresses.terrainGridVerticesPtr = reinterpret_cast<uintptr_t>(&verticesPtr_);
+            addresses.terrainCellInfoRowsPtr = reinterpret_cast<uintptr_t>(&rowsPtr_);
+            addresses.allLevelCellIndicesPtr = reinterpret_cast<uintptr_t>(&levelCellIndicesPtr_);
+            addresses.terrainCellCountXPtr = reinterpret_cast<uintptr_t>(&cellCountX_);
+            addresses.terrainCellCountZPtr = reinterpret_cast<uintptr_t>(&cellCountZ_);
+            addresses.terrainVertexCountXPtr = reinterpret_cast<uintptr_t>(&vertexCountX_);
+            addresses.terrainVertexCountZPtr = reinterpret_cast<uintptr_t>(&vertexCountZ_);
+            addresses.terrainVertexCountPtr = reinterpret_cast<uintptr_t>(&vertexCount_);
+        }
+
+        [[nodiscard]] int GetCellCount() const noexcept
+        {
+            return cellCountX_;
+        }
+
+        void OffsetVertexHeight(const int x, const int z, const float delta) noexcept
+        {
+            vertices_[static_cast<size_t>(z) * vertexCountX_ + x].y += delta;
+        }
+
+        // Leveled cells span [start, end) on both axes.
+        [[nodiscard]] int GetLeveledStart() const noexcept
+        {
+            return leveledStart_;
+        }
+
+        [[nodiscard]] int GetLeveledEnd() const noexcept
+        {
+            return leveledEnd_;
+        }
+
+    private:
+        int cellCountX_;
+        int cellCountZ_;
+        int vertexCountX_;
+        int vertexCountZ_;
+        int vertexCount_;
+        int leveledStart_;
+        int leveledEnd_;
+        std::vector<PackedTerrainVertex> vertices_;
+        std::vector<std::vector<HostCellInfoEntry>> cellInfos_;
+        std::vector<HostRowTableEntry> rows_;
+        std::vector<uint16_t> levelCellIndices_;
+        const PackedTerrainVertex* verticesPtr_ = nullptr;
+        const HostRowTableEntry* rowsPtr_ = nullptr;
+        const uint16_t* levelCellIndicesPtr_ = nullptr;
+    };
+
+    constexpr uint64_t kFnvOffsetBasis = 0xCBF29CE484222325ull;
+
+    // Submissions seen by the draw stubs since the last reset. Only sizes and a checksum are kept so
+    // recording does not allocate inside the measured loop.
+    struct DrawRecorder
+    {
+        uint32_t drawCalls = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint64_t checksum = kFnvOffsetBasis;
+    };
+
+    DrawRecorder gRecorder{};
+
+    [[nodiscard]] uint64_t Fnv1a(uint64_t hash, const void* const data, const size_t size) noexcept
+    {
+        const auto* const bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    // Indexed submissions are expanded before hashing and the hash carries across draw calls, so plain
+    // and indexed runs of one case report the same checksum however the batches were split.
+    [[nodiscard]] uint64_t HashTriangleList(uint64_t hash,
+                                            const PackedTerrainVertex* const vertices,
+                                            const uint32_t vertexCount,
+                                            const uint16_t* const indices,
+                                            const uint32_t indexCount) noexcept
+    {
+        if (!indices) {
+            return Fnv1a(hash, vertices, sizeof(PackedTerrainVertex) * vertexCount);
+        }
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            hash = Fnv1a(hash, &vertices[indices[i]], sizeof(PackedTerrainVertex));
+        }
+        return hash;
+    }
+
+    bool gHashSubmissions = false;
+
+    void RecordDrawPrims(SC4DrawContext*, uint32_t, uint32_t, const uint32_t vertexCount, const void* const vertices)
+    {
+        ++gRecorder.drawCalls;
+        if (gHashSubmissions) {
+            gRecorder.vertexCount += vertexCount;
+            gRecorder.checksum = HashTriangleList(
+                gRecorder.checksum, static_cast<const PackedTerrainVertex*>(vertices), vertexCount, nullptr, 0);
+        }
+    }
+
+    void RecordDrawPrimsIndexedRaw(SC4DrawContext*,
+                                   uint32_t,
+                                   uint32_t,
+                                   const uint32_t vertexCount,
+                                   const void* const vertices,
+                                   const uint32_t indexCount,
+                                   const uint16_t* const indices)
+    {
+        ++gRecorder.drawCalls;
+        if (gHashSubmissions) {
+            gRecorder.vertexCount += vertexCount;
+            gRecorder.indexCount += indexCount;
+            gRecorder.checksum = HashTriangleList(gRecorder.checksum,
+                                                  static_cast<const PackedTerrainVertex*>(vertices),
+                                                  vertexCount,
+                                                  indices,
+                                                  indexCount);
+        }
+    }
+
+    void IgnoreSetDepthOffset(SC4DrawContext*, int)
+    {
+    }
+
+    void IgnoreSetTexTransform4(SC4DrawContext*, const float*, int)
+    {
+    }
+
+    struct BenchCase
+    {
+        std::string_view name;
+        // Inclusive overlay rect in cells, as vanilla stores it.
+        int xStart;
+        int zStart;
+        int xEnd;
+        int zEnd;
+        // Footprint centre and size in world units, rotation in radians.
+        float centerX;
+        float centerZ;
+        float size;
+        float rotation;
+        bool hasUvWindow;
+        TerrainDecalUvWindow uvWindow;
+        // A non-finite slot matrix, which the renderer must hand back to vanilla.
+        bool nanMatrix;
+    };
+
+    struct BenchMode
+    {
+        std::string_view name;
+        bool indexed;
+        size_t geometryCacheBudgetBytes;
+    };
+
+    struct BenchResult
+    {
+        TerrainDecal::DrawResult drawResult = TerrainDecal::DrawResult::FallThroughToVanilla;
+        uint32_t cellsVisited = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint64_t checksum = 0;
+        double nsPerDraw = 0.0;
+        double allocationsPerDraw = 0.0;
+        // Shadow recovery redraw of the same overlay; only managed (UV window) cases are replayed.
+        bool replayed = false;
+        bool replayMatches = false;
+        double nsPerReplay = 0.0;
+    };
+
+    struct RevisionResult
+    {
+        int blockCount = 0;
+        double nsPerScan = 0.0;
+        // Ticks of kRevisionBlocksPerTick until the edited block was rehashed.
+        int ticksToDetect = 0;
+        uint32_t changedBlocks = 0;
+        bool editedBumped = false;
+        bool farUnchanged = false;
+    };
+
+    // Matches the service's per-tick budget.
+    constexpr uint32_t kRevisionBlocksPerTick = 256;
+
+    struct CacheCheckResult
+    {
+        // A terrain edit the revision tracker had not rehashed yet missed the cache and rebuilt what an
+        // uncached draw submits.
+        bool rebuiltAfterEdit = false;
+        bool rebuiltMatchesUncached = false;
+        // InvalidateOverlayGeometry dropped the entry and the next draw missed.
+        bool invalidateDropped = false;
+        // Overlays filling more than the budget evicted older entries and stayed within it.
+        uint64_t evictions = 0;
+        size_t bytesUsed = 0;
+        size_t byteBudget = 0;
+    };
+
+    // Fake overlay manager holding a slots pointer at the 641 offset and a small slot array.
+    class FakeOverlayManager
+    {
+    public:
+        FakeOverlayManager()
+        {
+            std::byte* const slots = slots_.data();
+            std::memcpy(manager_.data() + kOverlaySlotsPtrOffset, &slots, sizeof(slots));
+        }
+
+        [[nodiscard]] void* GetManager() noexcept
+        {
+            return manager_.data();
+        }
+
+        [[nodiscard]] std::byte* GetSlot(const uint32_t overlayId) noexcept
+        {
+            return slots_.data() + kOverlaySlotStride * overlayId;
+        }
+
+        void WriteSlot(const uint32_t overlayId, const BenchCase& benchCase)
+        {
+            std::byte* const slot = GetSlot(overlayId);
+            std::memset(slot, 0, kOverlaySlotStride);
+
+            const int32_t activeState = -1;
+            const uint32_t flags = 0;
+            const int32_t rect[] = {benchCase.xStart, benchCase.zStart, benchCase.xEnd, benchCase.zEnd};
+            std::memcpy(slot, &activeState, sizeof(activeState));
+            std::memcpy(slot + 0x04, &flags, sizeof(flags));
+            std::memcpy(slot + kOverlayRectOffset, rect, sizeof(rect));
+
+            // Row-vector footprint transform: u = x*m0 + z*m8 + m12, v = x*m1 + z*m9 + m13.
+            const float c = std::cos(benchCase.rotation) / benchCase.size;
+            const float s = std::sin(benchCase.rotation) / benchCase.size;
+            std::array<float, 16> matrix{
+                c, s, 0.0f, 0.0f,
+                0.0f, 0.0f, 0.0f, 0.0f,
+                -s, c, 0.0f, 0.0f,
+                0.5f - (c * benchCase.centerX - s * benchCase.centerZ),
+                0.5f - (s * benchCase.centerX + c * benchCase.centerZ),
+                0.0f, 1.0f,
+            };
+            if (benchCase.nanMatrix) {
+                matrix[0] = std::numeric_limits<float>::quiet_NaN();
+                matrix[13] = std::numeric_limits<float>::quiet_NaN();
+            }
+            std::memcpy(slot + kOverlayMatrixOffset, matrix.data(), sizeof(float) * matrix.size());
+
+            const float opacity = 1.0f;
+            std::memcpy(slot + kOverlayOpacityOffset, &opacity, sizeof(opacity));
+        }
+
+    private:
+        std::array<std::byte, 0x100> manager_{};
+        alignas(16) std::array<std::byte, kOverlaySlotStride * kOverlaySlotCount> slots_{};
+    };
+
+    SC4DrawContext gDrawContext;
+
+    [[nodiscard]] TerrainDecal::DrawRequest MakeRequest(const TerrainDecal::HookAddresses& addresses,
+                                                        FakeOverlayManager& overlayManager,
+                                                        const uint32_t overlayId) noexcept
+    {
+        return TerrainDecal::DrawRequest{
+            .overlayManager = overlayManager.GetManager(),
+            .drawContext = &gDrawContext,
+            .overlaySlotBase = overlayManager.GetSlot(overlayId),
+            .overlayRectOffset = kOverlayRectOffset,
+            .addresses = &addresses,
+            // Only checked for presence; the renderer reads terrain through the grid globals.
+            .terrain = reinterpret_cast<cISTETerrain*>(&gDrawContext),
+        };
+    }
+
+    // Draws once with the stubs hashing and returns the checksum of the submitted triangles.
+    [[nodiscard]] uint64_t DrawAndHash(TerrainDecal::ClippedTerrainDecalRenderer& renderer,
+                                       const TerrainDecal::DrawRequest& request)
+    {
+        gRecorder = {};
+        gHashSubmissions = true;
+        static_cast<void>(renderer.Draw(request));
+        gHashSubmissions = false;
+        return gRecorder.drawCalls > 0 ? gRecorder.checksum : 0;
+    }
+
+    [[nodiscard]] BenchResult RunCase(const TerrainDecal::HookAddresses& addresses,
+                                      FakeOverlayManager& overlayManager,
+                                      const BenchCase& benchCase,
+                                      const BenchMode& mode,
+                                      const int iterations)
+    {
+        overlayManager.WriteSlot(kOverlayId, benchCase);
+
+        TerrainDecal::ClippedTerrainDecalRenderer renderer(TerrainDecal::RendererOptions{
+            .enableClippedRendering = true,
+            .geometryCacheBudgetBytes = mode.geometryCacheBudgetBytes,
+            .enableIndexedSubmission = mode.indexed,
+        });
+        if (benchCase.hasUvWindow) {
+            renderer.SetOverlayUvWindow(kOverlayId, benchCase.uvWindow);
+        }
+
+        const TerrainDecal::DrawRequest request = MakeRequest(addresses, overlayManager, kOverlayId);
+
+        // The first draw grows the reusable buffers and fills the cache.
+        BenchResult result{};
+        gRecorder = {};
+        gHashSubmissions = true;
+        result.drawResult = renderer.Draw(request);
+        gHashSubmissions = false;
+        result.cellsVisited = renderer.GetLastDrawStats().cellsVisited;
+        result.vertexCount = gRecorder.vertexCount;
+        result.indexCount = gRecorder.indexCount;
+        result.checksum = gRecorder.drawCalls > 0 ? gRecorder.checksum : 0;
+
+        const uint64_t allocationsBefore = gAllocationCount.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            static_cast<void>(renderer.Draw(request));
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const uint64_t allocations = gAllocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        result.nsPerDraw = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+        result.allocationsPerDraw = static_cast<double>(allocations) / iterations;
+
+        // The last normal draw recorded the overlay; replaying it must submit the same triangles.
+        TerrainDecal::DrawRequest replayRequest = request;
+        replayRequest.mode = TerrainDecal::DrawMode::ShadowRecovery;
+        gRecorder = {};
+        gHashSubmissions = true;
+        static_cast<void>(renderer.Draw(replayRequest));
+        gHashSubmissions = false;
+        result.replayed = gRecorder.drawCalls > 0;
+        result.replayMatches = result.replayed && gRecorder.checksum == result.checksum;
+
+        const auto replayStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            static_cast<void>(renderer.Draw(replayRequest));
+        }
+        const auto replayEnd = std::chrono::steady_clock::now();
+        result.nsPerReplay = std::chrono::duration<double, std::nano>(replayEnd - replayStart).count() / iterations;
+        return result;
+    }
+
+    // Exercises the invalidation paths of the geometry cache on one overlay, then fills a small budget
+    // with every slot of the fake overlay manager.
+    [[nodiscard]] CacheCheckResult RunCacheChecks(SyntheticTerrain& terrain,
+                                                  const TerrainDecal::HookAddresses& addresses,
+                                                  FakeOverlayManager& overlayManager,
+                                                  const BenchCase& benchCase)
+    {
+        CacheCheckResult result{};
+        overlayManager.WriteSlot(kOverlayId, benchCase);
+        const TerrainDecal::DrawRequest request = MakeRequest(addresses, overlayManager, kOverlayId);
+
+        const TerrainDecal::TerrainGridView grid = TerrainDecal::CaptureTerrainGridView(addresses);
+        TerrainDecal::TerrainRevisionTracker tracker;
+        static_cast<void>(tracker.Update(grid, 0));
+
+        TerrainDecal::ClippedTerrainDecalRenderer cached(TerrainDecal::RendererOptions{
+            .enableClippedRendering = true,
+            .geometryCacheBudgetBytes = 4u * 1024u * 1024u,
+        });
+        cached.SetTerrainRevisionTracker(&tracker);
+        TerrainDecal::ClippedTerrainDecalRenderer uncached(TerrainDecal::RendererOptions{
+            .enableClippedRendering = true,
+        });
+        static_cast<void>(DrawAndHash(cached, request));
+
+        // Raise one vertex inside the decal without ticking the tracker, as if its scan had not reached the
+        // edit yet. The lookup's own height hash must still miss.
+        const int cell = (benchCase.xStart + benchCase.xEnd) / 2;
+        terrain.OffsetVertexHeight(cell, cell, 4.0f);
+        const uint64_t missesBefore = cached.GetGeometryCacheStats().misses;
+        const uint64_t rebuilt = DrawAndHash(cached, request);
+        result.rebuiltAfterEdit = cached.GetGeometryCacheStats().misses == missesBefore + 1;
+        result.rebuiltMatchesUncached = rebuilt != 0 && rebuilt == DrawAndHash(uncached, request);
+        terrain.OffsetVertexHeight(cell, cell, -4.0f);
+
+        static_cast<void>(DrawAndHash(cached, request));
+        const uint32_t entriesBefore = cached.GetGeometryCacheStats().entryCount;
+        cached.InvalidateOverlayGeometry(overlayManager.GetManager(), kOverlayId);
+        const TerrainDecal::ClippedGeometryCacheStats afterInvalidate = cached.GetGeometryCacheStats();
+        static_cast<void>(DrawAndHash(cached, request));
+        result.invalidateDropped = entriesBefore == 1 && afterInvalidate.entryCount == 0 &&
+                                   cached.GetGeometryCacheStats().misses == afterInvalidate.misses + 1;
+
+        // A budget of two and a half entries, filled with one entry per slot.
+        const size_t entryBytes = cached.GetGeometryCacheStats().bytesUsed;
+        TerrainDecal::ClippedTerrainDecalRenderer small(TerrainDecal::RendererOptions{
+            .enableClippedRendering = true,
+            .geometryCacheBudgetBytes = entryBytes * 5 / 2,
+        });
+        for (uint32_t overlayId = 0; overlayId < kOverlaySlotCount; ++overlayId) {
+            overlayManager.WriteSlot(overlayId, benchCase);
+            static_cast<void>(DrawAndHash(small, MakeRequest(addresses, overlayManager, overlayId)));
+        }
+        const TerrainDecal::ClippedGeometryCacheStats stats = small.GetGeometryCacheStats();
+        result.evictions = stats.evictions;
+        result.bytesUsed = stats.bytesUsed;
+        result.byteBudget = stats.byteBudget;
+        return result;
+    }
+
+    // Indexed and cached runs must submit the plain run's triangle list: the same expanded vertex count
+    // and the same checksum.
+    [[nodiscard]] bool SubmitsSameTriangles(const BenchResult& plain, const BenchResult& result) noexcept
+    {
+        const uint32_t triangleListLength = result.indexCount > 0 ? result.indexCount : result.vertexCount;
+        return result.drawResult == plain.drawResult && triangleListLength == plain.vertexCount &&
+               result.checksum == plain.checksum;
+    }
+
+    // Times full rescans of an unchanged grid, then edits one height and ticks until it is noticed.
+    [[nodiscard]] RevisionResult RunRevisionCase(SyntheticTerrain& terrain,
+                                                 const TerrainDecal::HookAddresses& addresses,
+                                                 const int iterations)
+    {
+        const TerrainDecal::TerrainGridView grid = TerrainDecal::CaptureTerrainGridView(addresses);
+        TerrainDecal::TerrainRevisionTracker tracker;
+        static_cast<void>(tracker.Update(grid, 0));
+
+        RevisionResult result{};
+        result.blockCount = tracker.GetBlockCountX() * tracker.GetBlockCountZ();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            static_cast<void>(tracker.Update(grid, 0));
+        }
+        const auto end = std::chrono::steady_clock::now();
+        result.nsPerScan = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+
+        // Off the block edges so exactly one block owns the vertex.
+        const int cell = terrain.GetCellCount() / 2 + 5;
+        const uint64_t editedBefore = tracker.GetRevisionForCells(cell, cell, cell + 1, cell + 1);
+        const uint64_t farBefore = tracker.GetRevisionForCells(0, 0, 1, 1);
+
+        terrain.OffsetVertexHeight(cell, cell, 4.0f);
+        const int maxTicks = result.blockCount / static_cast<int>(kRevisionBlocksPerTick) + 2;
+        while (result.changedBlocks == 0 && result.ticksToDetect < maxTicks) {
+            result.changedBlocks = tracker.Update(grid, kRevisionBlocksPerTick);
+            ++result.ticksToDetect;
+        }
+        terrain.OffsetVertexHeight(cell, cell, -4.0f);
+
+        result.editedBumped = tracker.GetRevisionForCells(cell, cell, cell + 1, cell + 1) > editedBefore;
+        result.farUnchanged = tracker.GetRevisionForCells(0, 0, 1, 1) == farBefore;
+        return result;
+    }
+
+    [[nodiscard]] const char* DescribeDrawResult(const TerrainDecal::DrawResult drawResult) noexcept
+    {
+        return drawResult == TerrainDecal::DrawResult::Handled ? "handled" : "vanilla";
+    }
+
+    void PrintUsage()
+    {
+        std::printf("usage: SC4DecalBench [--iterations N] [--grid CELLS]\n");
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    int iterations = 200;
+    int gridCells = 256;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--grid" && i + 1 < argc) {
+            gridCells = std::clamp(std::atoi(argv[++i]), 64, 1024);
+        }
+        else {
+            PrintUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    SyntheticTerrain terrain(gridCells);
+
+    TerrainDecal::HookAddresses addresses{};
+    addresses.gameVersion = 641;
+    addresses.drawPrims = reinterpret_cast<uintptr_t>(&RecordDrawPrims);
+    addresses.drawPrimsIndexedRaw = reinterpret_cast<uintptr_t>(&RecordDrawPrimsIndexedRaw);
+    addresses.setDepthOffset = reinterpret_cast<uintptr_t>(&IgnoreSetDepthOffset);
+    addresses.setTexTransform4 = reinterpret_cast<uintptr_t>(&IgnoreSetTexTransform4);
+    addresses.overlayRectOffset = kOverlayRectOffset;
+    addresses.overlaySlotsPtrOffset = kOverlaySlotsPtrOffset;
+    addresses.overlaySlotStride = kOverlaySlotStride;
+    terrain.Bind(addresses);
+
+    // Cases sit over the leveled block so the sweep mixes shared-row and per-cell loads.
+    const float mid = static_cast<float>(terrain.GetCellCount() / 4) * kCellSize;
+    const int midCell = terrain.GetCellCount() / 4;
+    // Every cell of this case takes the per-cell leveled load.
+    const int leveledStart = terrain.GetLeveledStart();
+    const int leveledEnd = terrain.GetLeveledEnd();
+    const float leveledMid = static_cast<float>(leveledStart + leveledEnd) * 0.5f * kCellSize;
+    const BenchCase cases[] = {
+        {
+            .name = "full-inside",
+            .xStart = midCell - 16, .zStart = midCell - 16, .xEnd = midCell + 15, .zEnd = midCell + 15,
+            .centerX = mid, .centerZ = mid, .size = 48.0f * kCellSize, .rotation = 0.0f,
+            .hasUvWindow = false, .uvWindow = {}, .nanMatrix = false,
+        },
+        {
+            .name = "partial-clip",
+            .xStart = midCell - 24, .zStart = midCell - 24, .xEnd = midCell + 23, .zEnd = midCell + 23,
+            .centerX = mid, .centerZ = mid, .size = 40.0f * kCellSize, .rotation = 0.6f,
+            .hasUvWindow = false, .uvWindow = {}, .nanMatrix = false,
+        },
+        {
+            .name = "atlas-window",
+            .xStart = midCell - 24, .zStart = midCell - 24, .xEnd = midCell + 23, .zEnd = midCell + 23,
+            .centerX = mid, .centerZ = mid, .size = 40.0f * kCellSize, .rotation = 0.3f,
+            .hasUvWindow = true,
+            .uvWindow = {.u1 = 0.25f, .v1 = 0.5f, .u2 = 0.375f, .v2 = 0.625f, .mode = TerrainDecalUvMode::ClipSubrect},
+            .nanMatrix = false,
+        },
+        {
+            .name = "leveled",
+            .xStart = leveledStart, .zStart = leveledStart, .xEnd = leveledEnd - 1, .zEnd = leveledEnd - 1,
+            .centerX = leveledMid, .centerZ = leveledMid,
+            .size = static_cast<float>(leveledEnd - leveledStart + 4) * kCellSize, .rotation = 0.0f,
+            .hasUvWindow = false, .uvWindow = {}, .nanMatrix = false,
+        },
+        {
+            .name = "nan-matrix",
+            .xStart = midCell - 16, .zStart = midCell - 16, .xEnd = midCell + 15, .zEnd = midCell + 15,
+            .centerX = mid, .centerZ = mid, .size = 40.0f * kCellSize, .rotation = 0.0f,
+            .hasUvWindow = false, .uvWindow = {}, .nanMatrix = true,
+        },
+    };
+
+    const BenchMode modes[] = {
+        {.name = "plain", .indexed = false, .geometryCacheBudgetBytes = 0},
+        {.name = "indexed", .indexed = true, .geometryCacheBudgetBytes = 0},
+        {.name = "cached", .indexed = false, .geometryCacheBudgetBytes = 4u * 1024u * 1024u},
+    };
+
+    std::printf("SC4DecalBench: grid=%dx%d cells, iterations=%d\n", gridCells, gridCells, iterations);
+    std::printf("%-13s %-8s %-8s %8s %8s %8s %12s %10s %10s %12s %7s  %s\n",
+                "case", "mode", "result", "cells", "vertices", "indices", "ns/draw", "ns/cell", "allocs", "ns/replay",
+                "replay", "checksum");
+
+    bool failed = false;
+    FakeOverlayManager overlayManager;
+    for (const BenchCase& benchCase : cases) {
+        // The first mode is the plain triangle list the other modes are checked against.
+        BenchResult plain{};
+        for (const BenchMode& mode : modes) {
+            const BenchResult result = RunCase(addresses, overlayManager, benchCase, mode, iterations);
+            if (&mode == &modes[0]) {
+                plain = result;
+            }
+            const double nsPerCell = result.cellsVisited > 0 ? result.nsPerDraw / result.cellsVisited : 0.0;
+            const char* const replay = !result.replayed ? "-" : (result.replayMatches ? "same" : "DIFF");
+            std::printf("%-13.*s %-8.*s %-8s %8u %8u %8u %12.1f %10.2f %10.2f %12.1f %7s  %016llx\n",
+                        static_cast<int>(benchCase.name.size()), benchCase.name.data(),
+                        static_cast<int>(mode.name.size()), mode.name.data(),
+                        DescribeDrawResult(result.drawResult),
+                        result.cellsVisited,
+                        result.vertexCount,
+                        result.indexCount,
+                        result.nsPerDraw,
+                        nsPerCell,
+                        result.allocationsPerDraw,
+                        result.nsPerReplay,
+                        replay,
+                        static_cast<unsigned long long>(result.checksum));
+            const bool drawn = result.drawResult == TerrainDecal::DrawResult::Handled && result.vertexCount > 0;
+            if (drawn == benchCase.nanMatrix) {
+                std::printf("FAIL: %.*s %.*s was %s, expected %s\n",
+                            static_cast<int>(benchCase.name.size()), benchCase.name.data(),
+                            static_cast<int>(mode.name.size()), mode.name.data(),
+                            drawn ? "drawn" : "not drawn",
+                            benchCase.nanMatrix ? "vanilla" : "a clipped draw");
+                failed = true;
+            }
+            if (result.replayed && !result.replayMatches) {
+                std::printf("FAIL: %.*s %.*s replay submitted different triangles than the draw\n",
+                            static_cast<int>(benchCase.name.size()), benchCase.name.data(),
+                            static_cast<int>(mode.name.size()), mode.name.data());
+                failed = true;
+            }
+            if (!SubmitsSameTriangles(plain, result)) {
+                std::printf("FAIL: %.*s %.*s submitted different triangles than plain\n",
+                            static_cast<int>(benchCase.name.size()), benchCase.name.data(),
+                            static_cast<int>(mode.name.size()), mode.name.data());
+                failed = true;
+            }
+            // The first draw grows the reusable buffers; the draws after it must not allocate.
+            if (result.allocationsPerDraw > 0.0) {
+                std::printf("FAIL: %.*s %.*s allocated %.2f times per steady-state draw\n",
+                            static_cast<int>(benchCase.name.size()), benchCase.name.data(),
+                            static_cast<int>(mode.name.size()), mode.name.data(),
+                            result.allocationsPerDraw);
+                failed = true;
+            }
+        }
+    }
+
+    const CacheCheckResult cache = RunCacheChecks(terrain, addresses, overlayManager, cases[1]);
+    std::printf("\ngeometry cache: terrain edit %s, invalidate %s, %llu eviction(s), %zu of %zu bytes used\n",
+                cache.rebuiltAfterEdit && cache.rebuiltMatchesUncached ? "rebuilt" : "STALE",
+                cache.invalidateDropped ? "dropped" : "KEPT",
+                static_cast<unsigned long long>(cache.evictions),
+                cache.bytesUsed,
+                cache.byteBudget);
+    if (!cache.rebuiltAfterEdit || !cache.rebuiltMatchesUncached) {
+        std::printf("FAIL: a terrain edit did not rebuild the cached geometry on the next draw\n");
+        failed = true;
+    }
+    if (!cache.invalidateDropped) {
+        std::printf("FAIL: InvalidateOverlayGeometry kept the cached entry\n");
+        failed = true;
+    }
+    if (cache.evictions == 0 || cache.bytesUsed > cache.byteBudget) {
+        std::printf("FAIL: the geometry cache did not evict to its byte budget\n");
+        failed = true;
+    }
+
+    const RevisionResult revisions = RunRevisionCase(terrain, addresses, iterations);
+    std::printf("\nterrain revisions: %d blocks, %.1f ns/full scan, %.2f ns/block, edit seen after %d tick(s) "
+                "of %u blocks, %u block(s) changed, edited rect %s, far rect %s\n",
+                revisions.blockCount,
+                revisions.nsPerScan,
+                revisions.blockCount > 0 ? revisions.nsPerScan / revisions.blockCount : 0.0,
+                revisions.ticksToDetect,
+                kRevisionBlocksPerTick,
+                revisions.changedBlocks,
+                revisions.editedBumped ? "bumped" : "STALE",
+                revisions.farUnchanged ? "unchanged" : "BUMPED");
+    if (!revisions.editedBumped) {
+        std::printf("FAIL: the edited block kept its revision\n");
+        failed = true;
+    }
+    if (!revisions.farUnchanged) {
+        std::printf("FAIL: a block away from the edit changed its revision\n");
+        failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,248 @@
+// Host-side check that the SSE2 footprint UV kernel matches the scalar reference bit for bit.
+//
+// Each round draws a random matrix, clip bounds and batch of vertices, runs both kernels on copies of
+// the batch and compares the UVs and inside flags. Batch sizes cover the four-wide loop, its scalar
+// tail and batches shorter than one vector. The first difference is printed and exits with 1.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "FootprintUvKernel.h"
+
+namespace
+{
+    using TerrainDecal::ClipBounds;
+    using TerrainDecal::ClipVertex;
+
+    constexpr size_t kMaxSmallBatch = 67;
+    constexpr size_t kLargeBatch = 1021;
+    // Written past the end of the flag buffer; a kernel that overruns `count` changes it.
+    constexpr uint8_t kFlagGuard = 0xA5;
+
+    class RandomSource
+    {
+    public:
+        explicit RandomSource(const uint32_t seed)
+            : engine_(seed)
+        {
+        }
+
+        [[nodiscard]] float Uniform(const float min, const float max)
+        {
+            return std::uniform_real_distribution<float>(min, max)(engine_);
+        }
+
+        [[nodiscard]] uint32_t Below(const uint32_t limit)
+        {
+            return std::uniform_int_distribution<uint32_t>(0, limit - 1)(engine_);
+        }
+
+        // Mostly ordinary values, with the occasional non-finite or w-threshold value mixed in.
+        [[nodiscard]] float Value(const float min, const float max)
+        {
+            switch (Below(64)) {
+            case 0:
+                return std::numeric_limits<float>::quiet_NaN();
+            case 1:
+                return std::numeric_limits<float>::infinity();
+            case 2:
+                return -std::numeric_limits<float>::infinity();
+            case 3:
+                return 0.0f;
+            case 4:
+                return TerrainDecal::kClipEpsilon;
+            default:
+                return Uniform(min, max);
+            }
+        }
+
+    private:
+        std::mt19937 engine_;
+    };
+
+    struct KernelInput
+    {
+        float matrix[16]{};
+        bool clipU = false;
+        bool clipV = false;
+        ClipBounds bounds{};
+    };
+
+    [[nodiscard]] KernelInput MakeInput(RandomSource& random)
+    {
+        KernelInput input;
+        // Footprint matrices are affine with a unit w column; projective ones exercise the divide.
+        const bool projective = random.Below(2) == 0;
+        for (int i = 0; i < 16; ++i) {
+            input.matrix[i] = random.Uniform(-0.05f, 0.05f);
+        }
+        input.matrix[12] = random.Uniform(-4.0f, 4.0f);
+        input.matrix[13] = random.Uniform(-4.0f, 4.0f);
+        if (projective) {
+            input.matrix[15] = random.Uniform(-2.0f, 2.0f);
+        }
+        else {
+            input.matrix[3] = 0.0f;
+            input.matrix[7] = 0.0f;
+            input.matrix[11] = 0.0f;
+            input.matrix[15] = 1.0f;
+        }
+        if (random.Below(16) == 0) {
+            input.matrix[random.Below(16)] = random.Value(-1.0f, 1.0f);
+        }
+
+        input.clipU = random.Below(2) == 0;
+        input.clipV = random.Below(2) == 0;
+        const float u0 = random.Uniform(-0.5f, 1.0f);
+        const float v0 = random.Uniform(-0.5f, 1.0f);
+        input.bounds = ClipBounds{
+            .minU = u0,
+            .maxU = u0 + random.Uniform(0.0f, 1.0f),
+            .minV = v0,
+            .maxV = v0 + random.Uniform(0.0f, 1.0f),
+        };
+        return input;
+    }
+
+    void FillVertices(RandomSource& random, std::vector<ClipVertex>& vertices)
+    {
+        for (ClipVertex& vertex : vertices) {
+            vertex = ClipVertex{};
+            vertex.vertex.x = random.Value(-200.0f, 200.0f);
+            vertex.vertex.y = random.Value(0.0f, 400.0f);
+            vertex.vertex.z = random.Value(-200.0f, 200.0f);
+            vertex.vertex.diffuse = 0xFFFFFFFFu;
+            // Stale values the kernels must overwrite.
+            vertex.clipU = random.Uniform(-1.0f, 1.0f);
+            vertex.clipV = random.Uniform(-1.0f, 1.0f);
+        }
+    }
+
+    // Moves one clip plane so that it passes exactly through a vertex of the batch, to exercise the
+    // inclusive bound comparisons.
+    void SnapBoundToVertex(RandomSource& random, const std::vector<ClipVertex>& vertices, KernelInput& input)
+    {
+        ClipVertex probe = vertices[random.Below(static_cast<uint32_t>(vertices.size()))];
+        TerrainDecal::EvaluateFootprintUv(input.matrix, probe);
+
+        const uint32_t side = random.Below(4);
+        const float value = side < 2 ? probe.clipU : probe.clipV;
+        if (!std::isfinite(value)) {
+            return;
+        }
+        const bool isMin = (side & 1) == 0;
+        const float bound = isMin ? value + TerrainDecal::kClipEpsilon : value - TerrainDecal::kClipEpsilon;
+        // The kernels compare against the bound widened by the epsilon; skip values that do not round back.
+        const float edge = isMin ? bound - TerrainDecal::kClipEpsilon : bound + TerrainDecal::kClipEpsilon;
+        if (edge != value) {
+            return;
+        }
+        float* const bounds[] = {&input.bounds.minU, &input.bounds.maxU, &input.bounds.minV, &input.bounds.maxV};
+        *bounds[side] = bound;
+    }
+
+    [[nodiscard]] bool SameBits(const float a, const float b) noexcept
+    {
+        return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+    }
+
+    [[nodiscard]] bool CheckBatch(RandomSource& random, const size_t count, const int round)
+    {
+        KernelInput input = MakeInput(random);
+
+        std::vector<ClipVertex> scalar(count);
+        FillVertices(random, scalar);
+        if (count > 0 && random.Below(2) == 0) {
+            SnapBoundToVertex(random, scalar, input);
+        }
+        std::vector<ClipVertex> sse2 = scalar;
+        std::vector<uint8_t> scalarFlags(count + 4, kFlagGuard);
+        std::vector<uint8_t> sse2Flags(count + 4, kFlagGuard);
+
+        TerrainDecal::EvaluateFootprintUvBatchScalar(
+            input.matrix, input.clipU, input.clipV, input.bounds, scalar.data(), scalarFlags.data(), count);
+        TerrainDecal::EvaluateFootprintUvBatchSse2(
+            input.matrix, input.clipU, input.clipV, input.bounds, sse2.data(), sse2Flags.data(), count);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (!SameBits(scalar[i].clipU, sse2[i].clipU) || !SameBits(scalar[i].clipV, sse2[i].clipV) ||
+                scalarFlags[i] != sse2Flags[i]) {
+                std::printf("MISMATCH: round %d, batch of %zu, vertex %zu (%g, %g, %g), clipU=%d clipV=%d\n",
+                            round, count, i,
+                            scalar[i].vertex.x, scalar[i].vertex.y, scalar[i].vertex.z,
+                            input.clipU ? 1 : 0, input.clipV ? 1 : 0);
+                std::printf("  scalar: u=%.9g (%08x) v=%.9g (%08x) inside=%u\n",
+                            scalar[i].clipU, std::bit_cast<uint32_t>(scalar[i].clipU),
+                            scalar[i].clipV, std::bit_cast<uint32_t>(scalar[i].clipV),
+                            scalarFlags[i]);
+                std::printf("  sse2:   u=%.9g (%08x) v=%.9g (%08x) inside=%u\n",
+                            sse2[i].clipU, std::bit_cast<uint32_t>(sse2[i].clipU),
+                            sse2[i].clipV, std::bit_cast<uint32_t>(sse2[i].clipV),
+                            sse2Flags[i]);
+                return false;
+            }
+        }
+        for (size_t i = count; i < sse2Flags.size(); ++i) {
+            if (sse2Flags[i] != kFlagGuard || scalarFlags[i] != kFlagGuard) {
+                std::printf("MISMATCH: round %d, batch of %zu wrote inside flag %zu\n", round, count, i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void PrintUsage()
+    {
+        std::printf("usage: SC4FootprintUvKernelCheck [--rounds N] [--seed N]\n");
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    int rounds = 200;
+    uint32_t seed = 0x5C4D3CA1u;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--rounds" && i + 1 < argc) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+        }
+        else {
+            PrintUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!TerrainDecal::HasSse2FootprintUvKernel()) {
+        std::printf("note: this build has no SSE2 kernel; checking its scalar fallback\n");
+    }
+
+    RandomSource random(seed);
+    size_t vertices = 0;
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t count = 0; count <= kMaxSmallBatch; ++count) {
+            if (!CheckBatch(random, count, round)) {
+                return 1;
+            }
+            vertices += count;
+        }
+        if (!CheckBatch(random, kLargeBatch, round)) {
+            return 1;
+        }
+        vertices += kLargeBatch;
+    }
+
+    std::printf("footprint uv kernel: %zu vertices in %d rounds match (seed %#x)\n", vertices, rounds, seed);
+    return 0;
+}
@@ -0,0 +1,204 @@
+// Microbenchmark for TerrainDecalRegistry against the std::map registry it replaced.
+//
+// Each size runs insert, find (hits on every live id), erase of every other id and a full iteration
+// that copies snapshots the way CopyDecals and OnSave_ do.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "TerrainDecalRegistry.h"
+
+namespace
+{
+    // The registry as it was before the slot map: one map node per record.
+    class MapRegistry
+    {
+    public:
+        [[nodiscard]] TerrainDecalId AllocateId() noexcept
+        {
+            return TerrainDecalId{nextId_++};
+        }
+
+        bool Insert(TerrainDecalRecord&& record)
+        {
+            return records_.emplace(record.id.value, std::move(record)).second;
+        }
+
+        bool Remove(const TerrainDecalId id)
+        {
+            return records_.erase(id.value) > 0;
+        }
+
+        [[nodiscard]] TerrainDecalRecord* Find(const TerrainDecalId id) noexcept
+        {
+            const auto it = records_.find(id.value);
+            return it != records_.end() ? &it->second : nullptr;
+        }
+
+        template <typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            for (const auto& [id, record] : records_) {
+                fn(record);
+            }
+        }
+
+    private:
+        std::map<uint32_t, TerrainDecalRecord> records_{};
+        uint32_t nextId_ = 1;
+    };
+
+    class SlotMapRegistry
+    {
+    public:
+        [[nodiscard]] TerrainDecalId AllocateId()
+        {
+            return registry_.AllocateId();
+        }
+
+        bool Insert(TerrainDecalRecord&& record)
+        {
+            return registry_.Insert(std::move(record));
+        }
+
+        bool Remove(const TerrainDecalId id)
+        {
+            return registry_.Remove(id);
+        }
+
+        [[nodiscard]] TerrainDecalRecord* Find(const TerrainDecalId id) noexcept
+        {
+            return registry_.Find(id);
+        }
+
+        template <typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            for (const TerrainDecalRecord& record : registry_.Records()) {
+                fn(record);
+            }
+        }
+
+    private:
+        TerrainDecalRegistry registry_{};
+    };
+
+    struct Timings
+    {
+        double insertNs = 0.0;
+        double findNs = 0.0;
+        double eraseNs = 0.0;
+        double iterateNs = 0.0;
+        uint64_t checksum = 0;
+    };
+
+    template <typename Clock = std::chrono::steady_clock>
+    [[nodiscard]] double ElapsedNs(const typename Clock::time_point start, const size_t operations)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(operations);
+    }
+
+    template <typename Registry>
+    [[nodiscard]] Timings Run(const size_t count, const uint32_t seed)
+    {
+        Registry registry;
+        Timings timings{};
+        std::vector<TerrainDecalId> ids;
+        ids.reserve(count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            TerrainDecalRecord record{};
+            record.id = registry.AllocateId();
+            record.state.opacity = static_cast<float>(i % 100) / 100.0f;
+            record.runtime.overlayId = static_cast<uint32_t>(i);
+            ids.push_back(record.id);
+            static_cast<void>(registry.Insert(std::move(record)));
+        }
+        timings.insertNs = ElapsedNs(start, count);
+
+        std::vector<TerrainDecalId> lookups = ids;
+        std::shuffle(lookups.begin(), lookups.end(), std::mt19937(seed));
+        uint64_t checksum = 0;
+        start = std::chrono::steady_clock::now();
+        for (const TerrainDecalId id : lookups) {
+            if (const TerrainDecalRecord* const record = registry.Find(id)) {
+                checksum += record->runtime.overlayId.value_or(0);
+            }
+        }
+        timings.findNs = ElapsedNs(start, lookups.size());
+
+        start = std::chrono::steady_clock::now();
+        size_t erased = 0;
+        for (size_t i = 0; i < lookups.size(); i += 2) {
+            erased += registry.Remove(lookups[i]) ? 1 : 0;
+        }
+        timings.eraseNs = ElapsedNs(start, std::max<size_t>(erased, 1));
+
+        std::vector<TerrainDecalSnapshot> snapshots;
+        snapshots.reserve(count);
+        start = std::chrono::steady_clock::now();
+        registry.ForEach([&](const TerrainDecalRecord& record) {
+            snapshots.push_back(TerrainDecalSnapshot{.id = record.id, .state = record.state});
+        });
+        timings.iterateNs = ElapsedNs(start, std::max<size_t>(snapshots.size(), 1));
+
+        timings.checksum = checksum + snapshots.size();
+        return timings;
+    }
+
+    void PrintRow(const std::string_view name, const size_t count, const Timings& timings)
+    {
+        std::printf("%-9.*s %8zu %10.1f %10.1f %10.1f %10.1f  %llu\n",
+                    static_cast<int>(name.size()), name.data(),
+                    count,
+                    timings.insertNs,
+                    timings.findNs,
+                    timings.eraseNs,
+                    timings.iterateNs,
+                    static_cast<unsigned long long>(timings.checksum));
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    int repeats = 5;
+    if (argc == 3 && std::string_view(argv[1]) == "--repeats") {
+        repeats = std::max(1, std::atoi(argv[2]));
+    }
+    else if (argc != 1) {
+        std::printf("usage: SC4DecalRegistryBench [--repeats N]\n");
+        return 1;
+    }
+
+    std::printf("SC4DecalRegistryBench: best of %d, ns per operation\n", repeats);
+    std::printf("%-9s %8s %10s %10s %10s %10s  %s\n", "registry", "decals", "insert", "find", "erase", "iterate", "checksum");
+
+    const auto best = [](Timings current, const Timings& sample) {
+        current.insertNs = std::min(current.insertNs, sample.insertNs);
+        current.findNs = std::min(current.findNs, sample.findNs);
+        current.eraseNs = std::min(current.eraseNs, sample.eraseNs);
+        current.iterateNs = std::min(current.iterateNs, sample.iterateNs);
+        return current;
+    };
+
+    for (const size_t count : {size_t{1000}, size_t{10000}, size_t{100000}}) {
+        Timings mapTimings = Run<MapRegistry>(count, 1);
+        Timings slotTimings = Run<SlotMapRegistry>(count, 1);
+        for (int i = 1; i < repeats; ++i) {
+            mapTimings = best(mapTimings, Run<MapRegistry>(count, 1));
+            slotTimings = best(slotTimings, Run<SlotMapRegistry>(count, 1));
+        }
+        PrintRow("std::map", count, mapTimings);
+        PrintRow("slot map", count, slotTimings);
+    }
+
+    return 0;
+}
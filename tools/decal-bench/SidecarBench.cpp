@@ -0,0 +1,408 @@
+// Microbenchmark for TerrainDecalSidecarCodec: the compact v2 format against the fixed-size v1.1 records,
+// moved either as blocks or field by field.
+//
+// The codec runs against in-memory streams (see stream-standin/) that count stream calls. Each size
+// writes and reads the same snapshots every way and checks that the v1.1 bytes on the wire match and
+// that decoding any stream re-encodes to the same v1.1 bytes. The size table compares v2 against v1.1
+// for randomised snapshots and for snapshots that keep most fields at their defaults, as placed decals do.
+// The last pass times a save through TerrainDecalSidecarCache after a handful of edits against a full
+// re-encode, and checks both sidecars decode to the same decals.
+// A thread sweep decodes a 200k-record sidecar in both formats at every decode thread count and checks
+// that the decals, and the errors for truncated or corrupted copies, match the single-threaded read.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "SidecarSupport.h"
+#include "TerrainDecalSidecarCache.h"
+#include "TerrainDecalSidecarCodec.h"
+
+namespace
+{
+    using SidecarSupport::DowngradeToV10;
+    using SidecarSupport::MakeSnapshots;
+    using SidecarSupport::MakeTypicalSnapshots;
+    using SidecarSupport::MemoryIStream;
+    using SidecarSupport::MemoryOStream;
+    using TerrainDecalSidecar::PersistedTerrainDecal;
+    using TerrainDecalSidecar::TerrainDecalChunkHeader;
+
+    constexpr uint32_t kHeaderBytes = 32;
+
+    void WriteHeaders(MemoryOStream& out, const uint32_t recordSize, const uint32_t recordCount)
+    {
+        const TerrainDecalSidecar::TerrainDecalSidecarHeader header{
+            .versionMajor = TerrainDecalSidecar::kLegacyVersionMajor,
+            .versionMinor = TerrainDecalSidecar::kLegacyVersionMinor,
+        };
+        out.SetUint32(header.magic);
+        out.SetUint16(header.versionMajor);
+        out.SetUint16(header.versionMinor);
+        out.SetUint32(header.flags);
+        out.SetUint32(header.chunkCount);
+        out.SetUint32(TerrainDecalSidecar::kChunkTagTerrainDecals);
+        out.SetUint32(recordSize * recordCount);
+        out.SetUint32(recordSize);
+        out.SetUint32(recordCount);
+    }
+
+    [[nodiscard]] std::vector<std::byte> EncodeLegacy(const std::vector<TerrainDecalSnapshot>& snapshots)
+    {
+        MemoryOStream out;
+        out.Reset(kHeaderBytes + snapshots.size() * sizeof(PersistedTerrainDecal));
+        TerrainDecalSidecar::WriteLegacy(out, snapshots);
+        return out.Bytes();
+    }
+
+    [[nodiscard]] std::vector<std::byte> EncodeCompact(const std::vector<TerrainDecalSnapshot>& snapshots,
+                                                       const TerrainDecalSidecar::WriteOptions& options = {})
+    {
+        MemoryOStream out;
+        out.Reset(kHeaderBytes + snapshots.size() * 16);
+        TerrainDecalSidecar::Write(out, snapshots, options);
+        return out.Bytes();
+    }
+
+    [[nodiscard]] TerrainDecalSidecar::ReadResult Decode(const std::vector<std::byte>& wire,
+                                                         const uint32_t decodeThreads = 0)
+    {
+        MemoryIStream in(wire);
+        return TerrainDecalSidecar::Read(in, {.decodeThreads = decodeThreads});
+    }
+
+    [[nodiscard]] std::vector<std::byte> EncodeRegions(const std::vector<TerrainDecalSnapshot>& snapshots)
+    {
+        TerrainDecalSidecarCache cache;
+        (void)cache.Rebuild(snapshots);
+        MemoryOStream out;
+        out.Reset(kHeaderBytes + snapshots.size() * 16);
+        cache.Write(out);
+        return out.Bytes();
+    }
+
+    // Truncated and corrupted copies of wire must fail, or not, the same way at every thread count.
+    [[nodiscard]] bool SameErrorsAcrossThreads(const std::vector<std::byte>& wire)
+    {
+        std::mt19937 rng(5);
+        for (int trial = 0; trial < 24; ++trial) {
+            std::vector<std::byte> damaged = wire;
+            if (trial % 2 == 0) {
+                damaged.resize(kHeaderBytes + rng() % (wire.size() - kHeaderBytes));
+            }
+            else {
+                damaged[kHeaderBytes + rng() % (wire.size() - kHeaderBytes)] ^= std::byte{0x5A};
+            }
+
+            const TerrainDecalSidecar::ReadResult serial = Decode(damaged, 1);
+            for (uint32_t threads = 2; threads <= TerrainDecalSidecar::kMaxDecodeThreads; ++threads) {
+                const TerrainDecalSidecar::ReadResult parallel = Decode(damaged, threads);
+                if (parallel.ok != serial.ok || parallel.error != serial.error ||
+                    EncodeLegacy(parallel.decals) != EncodeLegacy(serial.decals)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] TerrainDecalChunkHeader ChunkFor(const uint32_t recordSize, const uint32_t recordCount)
+    {
+        return TerrainDecalChunkHeader{
+            .tag = TerrainDecalSidecar::kChunkTagTerrainDecals,
+            .payloadBytes = recordSize * recordCount,
+            .recordSize = recordSize,
+            .recordCount = recordCount,
+        };
+    }
+
+    struct Timings
+    {
+        double bytesPerRecord = 0.0;
+        double writeNs = 0.0;
+        double readNs = 0.0;
+        uint64_t writeCalls = 0;
+        uint64_t readCalls = 0;
+    };
+
+    [[nodiscard]] std::vector<TerrainDecalSnapshot> SortedById(std::vector<TerrainDecalSnapshot> snapshots)
+    {
+        std::ranges::sort(snapshots, {}, [](const TerrainDecalSnapshot& snapshot) { return snapshot.id.value; });
+        return snapshots;
+    }
+
+    // Collects the decals a save has to re-encode, the way TerrainDecalService::OnSave_ does.
+    [[nodiscard]] std::vector<TerrainDecalSnapshot> CollectDirty(const TerrainDecalSidecarCache& cache,
+                                                                 const std::vector<TerrainDecalSnapshot>& snapshots)
+    {
+        std::vector<TerrainDecalSnapshot> dirty;
+        for (const TerrainDecalSnapshot& snapshot : snapshots) {
+            if (cache.IsDirty(snapshot.state.decalInfo.center)) {
+                dirty.push_back(snapshot);
+            }
+        }
+        return dirty;
+    }
+
+    template <typename Fn>
+    [[nodiscard]] double BestNs(const int repeats, const size_t records, Fn&& fn)
+    {
+        double best = 0.0;
+        for (int i = 0; i < repeats; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const double ns =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                static_cast<double>(std::max<size_t>(records, 1));
+            best = i == 0 ? ns : std::min(best, ns);
+        }
+        return best;
+    }
+
+    void PrintRow(const std::string_view name, const size_t count, const Timings& timings)
+    {
+        std::printf("%-10.*s %8zu %10.1f %10.1f %10.1f %12llu %12llu\n",
+                    static_cast<int>(name.size()), name.data(),
+                    count,
+                    timings.bytesPerRecord,
+                    timings.writeNs,
+                    timings.readNs,
+                    static_cast<unsigned long long>(timings.writeCalls),
+                    static_cast<unsigned long long>(timings.readCalls));
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    int repeats = 5;
+    if (argc == 3 && std::string_view(argv[1]) == "--repeats") {
+        repeats = std::max(1, std::atoi(argv[2]));
+    }
+    else if (argc != 1) {
+        std::printf("usage: SC4DecalSidecarBench [--repeats N]\n");
+        return 1;
+    }
+
+    std::printf("SC4DecalSidecarBench: best of %d, ns per record\n", repeats);
+    std::printf("%-10s %8s %10s %10s %10s %12s %12s\n",
+                "path", "decals", "bytes", "write", "read", "write calls", "read calls");
+
+    bool ok = true;
+    for (const size_t count : {size_t{1000}, size_t{10000}, size_t{100000}}) {
+        const std::vector<TerrainDecalSnapshot> snapshots = MakeSnapshots(count, 1);
+        const auto recordCount = static_cast<uint32_t>(count);
+        const TerrainDecalChunkHeader chunk = ChunkFor(sizeof(PersistedTerrainDecal), recordCount);
+
+        MemoryOStream blockOut;
+        MemoryOStream fieldOut;
+        MemoryOStream compactOut;
+        Timings block{};
+        Timings fieldwise{};
+        Timings compact{};
+
+        block.writeNs = BestNs(repeats, count, [&] {
+            blockOut.Reset(kHeaderBytes + count * sizeof(PersistedTerrainDecal));
+            TerrainDecalSidecar::WriteLegacy(blockOut, snapshots);
+        });
+        block.writeCalls = blockOut.Calls();
+
+        fieldwise.writeNs = BestNs(repeats, count, [&] {
+            fieldOut.Reset(kHeaderBytes + count * sizeof(PersistedTerrainDecal));
+            WriteHeaders(fieldOut, sizeof(PersistedTerrainDecal), recordCount);
+            TerrainDecalSidecar::WriteRecordsFieldwise(fieldOut, snapshots);
+        });
+        fieldwise.writeCalls = fieldOut.Calls();
+
+        if (blockOut.Bytes() != fieldOut.Bytes()) {
+            std::printf("MISMATCH: block and field-wise writes differ for %zu decals\n", count);
+            ok = false;
+        }
+
+        const std::vector<std::byte>& wire = blockOut.Bytes();
+        TerrainDecalSidecar::ReadResult blockResult{};
+        block.readNs = BestNs(repeats, count, [&] {
+            MemoryIStream in(wire);
+            blockResult = TerrainDecalSidecar::Read(in);
+            block.readCalls = in.Calls();
+        });
+
+        TerrainDecalSidecar::ReadResult fieldResult{};
+        fieldwise.readNs = BestNs(repeats, count, [&] {
+            MemoryIStream in(wire, kHeaderBytes);
+            fieldResult = TerrainDecalSidecar::ReadResult{};
+            fieldResult.decals.reserve(count);
+            fieldResult.ok = TerrainDecalSidecar::ReadRecordsFieldwise(in, chunk, fieldResult);
+            fieldwise.readCalls = in.Calls();
+        });
+
+        if (!blockResult.ok || !fieldResult.ok ||
+            EncodeLegacy(blockResult.decals) != wire || EncodeLegacy(fieldResult.decals) != wire) {
+            std::printf("MISMATCH: round trip failed for %zu decals\n", count);
+            ok = false;
+        }
+
+        // Sidecars written before depthOffset existed must decode identically on both paths.
+        constexpr uint32_t oldRecordSize = offsetof(PersistedTerrainDecal, depthOffset);
+        const std::vector<std::byte> oldWire = DowngradeToV10(wire);
+        MemoryIStream oldBlockIn(oldWire);
+        const TerrainDecalSidecar::ReadResult oldBlock = TerrainDecalSidecar::Read(oldBlockIn);
+        MemoryIStream oldFieldIn(oldWire, kHeaderBytes);
+        TerrainDecalSidecar::ReadResult oldField{};
+        oldField.ok = TerrainDecalSidecar::ReadRecordsFieldwise(oldFieldIn, ChunkFor(oldRecordSize, recordCount), oldField);
+        if (!oldBlock.ok || !oldField.ok || EncodeLegacy(oldBlock.decals) != EncodeLegacy(oldField.decals) ||
+            std::ranges::any_of(oldBlock.decals, [](const TerrainDecalSnapshot& s) { return s.state.depthOffset != -1; })) {
+            std::printf("MISMATCH: 1.0 layout decode differs for %zu decals\n", count);
+            ok = false;
+        }
+
+        compact.writeNs = BestNs(repeats, count, [&] {
+            compactOut.Reset(kHeaderBytes + count * 16);
+            TerrainDecalSidecar::Write(compactOut, snapshots);
+        });
+        compact.writeCalls = compactOut.Calls();
+
+        TerrainDecalSidecar::ReadResult compactResult{};
+        compact.readNs = BestNs(repeats, count, [&] {
+            MemoryIStream in(compactOut.Bytes());
+            compactResult = TerrainDecalSidecar::Read(in);
+            compact.readCalls = in.Calls();
+        });
+
+        if (!compactResult.ok || EncodeLegacy(compactResult.decals) != wire) {
+            std::printf("MISMATCH: v2 round trip failed for %zu decals\n", count);
+            ok = false;
+        }
+
+        block.bytesPerRecord = static_cast<double>(wire.size()) / static_cast<double>(count);
+        fieldwise.bytesPerRecord = block.bytesPerRecord;
+        compact.bytesPerRecord = static_cast<double>(compactOut.Bytes().size()) / static_cast<double>(count);
+
+        PrintRow("field-wise", count, fieldwise);
+        PrintRow("block", count, block);
+        PrintRow("v2", count, compact);
+    }
+
+    std::printf("\nsidecar size, bytes per record\n");
+    std::printf("%-10s %8s %10s %10s %10s %10s\n", "snapshots", "decals", "v1.1", "v2", "quantized", "v1.1/v2");
+    for (const size_t count : {size_t{1000}, size_t{50000}}) {
+        for (const bool typical : {false, true}) {
+            const std::vector<TerrainDecalSnapshot> snapshots =
+                typical ? MakeTypicalSnapshots(count, 2) : MakeSnapshots(count, 2);
+            const std::vector<std::byte> legacy = EncodeLegacy(snapshots);
+            const std::vector<std::byte> compact = EncodeCompact(snapshots);
+            const std::vector<std::byte> quantized = EncodeCompact(snapshots, {.quantizeCenterAndSize = true});
+
+            const TerrainDecalSidecar::ReadResult compactResult = Decode(compact);
+            const TerrainDecalSidecar::ReadResult quantizedResult = Decode(quantized);
+            if (!compactResult.ok || EncodeLegacy(compactResult.decals) != legacy ||
+                !quantizedResult.ok || quantizedResult.decals.size() != count) {
+                std::printf("MISMATCH: v2 size pass failed for %zu decals\n", count);
+                ok = false;
+            }
+
+            const auto perRecord = [count](const std::vector<std::byte>& bytes) {
+                return static_cast<double>(bytes.size()) / static_cast<double>(count);
+            };
+            std::printf("%-10s %8zu %10.1f %10.1f %10.1f %9.1fx\n",
+                        typical ? "typical" : "random",
+                        count,
+                        perRecord(legacy),
+                        perRecord(compact),
+                        perRecord(quantized),
+                        static_cast<double>(legacy.size()) / static_cast<double>(compact.size()));
+        }
+    }
+
+    constexpr size_t kIncrementalDecals = 50000;
+    constexpr size_t kEditedDecals = 16;
+    std::printf("\nsave after %zu edits in one region, %zu decals, ms per save\n", kEditedDecals, kIncrementalDecals);
+    std::printf("%-12s %10s %10s %10s\n", "save", "time", "regions", "decals");
+    {
+        std::vector<TerrainDecalSnapshot> snapshots = MakeTypicalSnapshots(kIncrementalDecals, 3);
+        TerrainDecalSidecarCache cache;
+        (void)cache.Rebuild(snapshots);
+
+        MemoryOStream fullOut;
+        TerrainDecalSidecarCache::SaveStats fullStats{};
+        const double fullMs = BestNs(repeats, 1, [&] {
+            cache.Invalidate();
+            fullStats = cache.Rebuild(CollectDirty(cache, snapshots));
+            fullOut.Reset(kHeaderBytes + snapshots.size() * 16);
+            cache.Write(fullOut);
+        }) / 1.0e6;
+
+        // Edits rotate decals that sit in the first region, as touching up one corner of a city would.
+        std::vector<size_t> editable;
+        for (size_t i = 0; i < snapshots.size(); ++i) {
+            const cS3DVector2& center = snapshots[i].state.decalInfo.center;
+            if (center.fX < TerrainDecalSidecarCache::kRegionSize && center.fY < TerrainDecalSidecarCache::kRegionSize) {
+                editable.push_back(i);
+            }
+        }
+
+        MemoryOStream incrementalOut;
+        TerrainDecalSidecarCache::SaveStats incrementalStats{};
+        std::mt19937 rng(4);
+        const double incrementalMs = BestNs(repeats, 1, [&] {
+            for (size_t i = 0; i < kEditedDecals; ++i) {
+                TerrainDecalSnapshot& edited = snapshots[editable[rng() % editable.size()]];
+                edited.state.decalInfo.rotationTurns += 0.125f;
+                cache.MarkDirty(edited.state.decalInfo.center);
+            }
+            incrementalStats = cache.Rebuild(CollectDirty(cache, snapshots));
+            incrementalOut.Reset(kHeaderBytes + snapshots.size() * 16);
+            cache.Write(incrementalOut);
+        }) / 1.0e6;
+
+        const TerrainDecalSidecar::ReadResult incremental = Decode(incrementalOut.Bytes());
+        const TerrainDecalSidecar::ReadResult flat = Decode(EncodeCompact(snapshots));
+        if (!incremental.ok || !flat.ok ||
+            EncodeLegacy(SortedById(incremental.decals)) != EncodeLegacy(SortedById(flat.decals))) {
+            std::printf("MISMATCH: incremental sidecar differs from a single-chunk sidecar\n");
+            ok = false;
+        }
+
+        std::printf("%-12s %10.3f %10u %10u\n", "full", fullMs, fullStats.encodedRegions, fullStats.encodedDecals);
+        std::printf("%-12s %10.3f %10u %10u\n", "incremental", incrementalMs,
+                    incrementalStats.encodedRegions, incrementalStats.encodedDecals);
+    }
+
+    constexpr size_t kSweepDecals = 200000;
+    std::printf("\ndecode thread sweep, %zu decals, ms per read\n", kSweepDecals);
+    std::printf("%-8s %8s %10s %10s\n", "format", "threads", "read", "speedup");
+    {
+        const std::vector<TerrainDecalSnapshot> snapshots = MakeTypicalSnapshots(kSweepDecals, 6);
+        for (const bool compact : {false, true}) {
+            const std::vector<std::byte> wire = compact ? EncodeRegions(snapshots) : EncodeLegacy(snapshots);
+            const TerrainDecalSidecar::ReadResult serial = Decode(wire, 1);
+            const std::vector<std::byte> serialDecals = EncodeLegacy(serial.decals);
+
+            double serialMs = 0.0;
+            for (uint32_t threads = 1; threads <= TerrainDecalSidecar::kMaxDecodeThreads; ++threads) {
+                TerrainDecalSidecar::ReadResult result{};
+                const double ms = BestNs(repeats, 1, [&] { result = Decode(wire, threads); }) / 1.0e6;
+                serialMs = threads == 1 ? ms : serialMs;
+                if (!result.ok || result.decals.size() != kSweepDecals || EncodeLegacy(result.decals) != serialDecals) {
+                    std::printf("MISMATCH: %u-thread decode differs from the serial decode\n", threads);
+                    ok = false;
+                }
+                std::printf("%-8s %8u %10.3f %9.2fx\n", compact ? "2.0" : "1.1", threads, ms, serialMs / ms);
+            }
+
+            if (!SameErrorsAcrossThreads(wire)) {
+                std::printf("MISMATCH: damaged %s sidecar fails differently across thread counts\n",
+                            compact ? "2.0" : "1.1");
+                ok = false;
+            }
+        }
+    }
+
+    std::printf("round trip: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+// In-memory streams and synthetic snapshots shared by SC4DecalSidecarBench and SC4DecalSidecarTool.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "cIGZIStream.h"
+#include "cIGZOStream.h"
+#include "public/cIGZTerrainDecalService.h"
+#include "TerrainDecalSidecarCodec.h"
+
+namespace SidecarSupport
+{
+    class MemoryOStream final : public cIGZOStream
+    {
+    public:
+        bool QueryInterface(uint32_t, void**) override { return false; }
+        uint32_t AddRef() override { return 1; }
+        uint32_t Release() override { return 1; }
+
+        bool SetUint16(const uint16_t value) override { return Append(&value, sizeof(value)); }
+        bool SetUint32(const uint32_t value) override { return Append(&value, sizeof(value)); }
+        bool SetFloat32(const float value) override { return Append(&value, sizeof(value)); }
+        bool SetVoid(const void* const buffer, const uint32_t size) override { return Append(buffer, size); }
+        int32_t GetError() override { return 0; }
+
+        [[nodiscard]] const std::vector<std::byte>& Bytes() const noexcept { return bytes_; }
+        [[nodiscard]] uint64_t Calls() const noexcept { return calls_; }
+
+        void Reset(const size_t capacity)
+        {
+            bytes_.clear();
+            bytes_.reserve(capacity);
+            calls_ = 0;
+        }
+
+    private:
+        bool Append(const void* const data, const size_t size)
+        {
+            ++calls_;
+            const auto* const first = static_cast<const std::byte*>(data);
+            bytes_.insert(bytes_.end(), first, first + size);
+            return true;
+        }
+
+        std::vector<std::byte> bytes_{};
+        uint64_t calls_ = 0;
+    };
+
+    class MemoryIStream final : public cIGZIStream
+    {
+    public:
+        explicit MemoryIStream(const std::vector<std::byte>& bytes, const size_t offset = 0)
+            : bytes_(bytes)
+            , offset_(offset)
+        {
+        }
+
+        bool QueryInterface(uint32_t, void**) override { return false; }
+        uint32_t AddRef() override { return 1; }
+        uint32_t Release() override { return 1; }
+
+        bool GetUint16(uint16_t& value) override { return Take(&value, sizeof(value)); }
+        bool GetUint32(uint32_t& value) override { return Take(&value, sizeof(value)); }
+        bool GetFloat32(float& value) override { return Take(&value, sizeof(value)); }
+        bool GetVoid(void* const buffer, const uint32_t size) override { return Take(buffer, size); }
+        int32_t GetError() override { return error_; }
+
+        [[nodiscard]] uint64_t Calls() const noexcept { return calls_; }
+
+    private:
+        bool Take(void* const data, const size_t size)
+        {
+            ++calls_;
+            if (bytes_.size() - offset_ < size) {
+                error_ = 1;
+                return false;
+            }
+            std::memcpy(data, bytes_.data() + offset_, size);
+            offset_ += size;
+            return true;
+        }
+
+        const std::vector<std::byte>& bytes_;
+        size_t offset_ = 0;
+        uint64_t calls_ = 0;
+        int32_t error_ = 0;
+    };
+
+    [[nodiscard]] inline std::vector<TerrainDecalSnapshot> MakeSnapshots(const size_t count, const uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.0f, 4096.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        std::vector<TerrainDecalSnapshot> snapshots(count);
+        for (size_t i = 0; i < count; ++i) {
+            TerrainDecalSnapshot& snapshot = snapshots[i];
+            snapshot.id = TerrainDecalId{static_cast<uint32_t>(i + 1)};
+            snapshot.state.textureKey = cGZPersistResourceKey(0x7AB50E44, 0x1ABE787D, rng());
+            snapshot.state.overlayType = static_cast<cISTETerrainView::tOverlayManagerType>(rng() % 4);
+            snapshot.state.decalInfo.center = cS3DVector2(position(rng), position(rng));
+            snapshot.state.decalInfo.baseSize = 4.0f + unit(rng) * 60.0f;
+            snapshot.state.decalInfo.rotationTurns = unit(rng);
+            snapshot.state.decalInfo.aspectMultiplier = 1.0f;
+            snapshot.state.decalInfo.uvScaleU = 1.0f;
+            snapshot.state.decalInfo.uvScaleV = 1.0f;
+            snapshot.state.opacity = unit(rng);
+            snapshot.state.enabled = (rng() & 1u) != 0;
+            snapshot.state.color = cS3DVector3(unit(rng), unit(rng), unit(rng));
+            snapshot.state.drawMode = static_cast<uint8_t>(rng() % 3);
+            snapshot.state.flags = rng() & 0xFFu;
+            snapshot.state.hasUvWindow = (rng() & 1u) != 0;
+            snapshot.state.uvWindow = TerrainDecalUvWindow{
+                .u1 = 0.25f,
+                .v1 = 0.0f,
+                .u2 = 0.5f,
+                .v2 = 0.25f,
+                .mode = (rng() & 1u) != 0 ? TerrainDecalUvMode::ClipSubrect : TerrainDecalUvMode::StretchSubrect,
+            };
+            snapshot.state.depthOffset = static_cast<int32_t>(rng() % 8) - 1;
+        }
+        return snapshots;
+    }
+
+    // Decals as the tools place them: a small texture set, default colour, opacity and UV window, and
+    // sizes from the slider's half-unit steps. Centres stay arbitrary floats.
+    [[nodiscard]] inline std::vector<TerrainDecalSnapshot> MakeTypicalSnapshots(const size_t count, const uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.0f, 4096.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        std::vector<TerrainDecalSnapshot> snapshots(count);
+        for (size_t i = 0; i < count; ++i) {
+            TerrainDecalSnapshot& snapshot = snapshots[i];
+            snapshot.id = TerrainDecalId{static_cast<uint32_t>(i + 1)};
+            snapshot.state.textureKey = cGZPersistResourceKey(0x7AB50E44, 0x1ABE787D, 0x1000 + rng() % 32);
+            snapshot.state.overlayType = cISTETerrainView::tOverlayManagerType::DynamicLand;
+            snapshot.state.decalInfo.center = cS3DVector2(position(rng), position(rng));
+            snapshot.state.decalInfo.baseSize = 0.5f * static_cast<float>(8 + rng() % 120);
+            snapshot.state.decalInfo.rotationTurns = rng() % 4 == 0 ? unit(rng) : 0.0f;
+        }
+        return snapshots;
+    }
+
+    // Rewrites a 1.1 sidecar with the 1.0 record layout, which has no depthOffset.
+    [[nodiscard]] inline std::vector<std::byte> DowngradeToV10(const std::vector<std::byte>& v11)
+    {
+        using TerrainDecalSidecar::PersistedTerrainDecal;
+        constexpr size_t kHeaderBytes = 32;
+        constexpr uint32_t oldRecordSize = offsetof(PersistedTerrainDecal, depthOffset);
+
+        uint32_t recordCount = 0;
+        std::memcpy(&recordCount, v11.data() + kHeaderBytes - sizeof(uint32_t), sizeof(recordCount));
+
+        const TerrainDecalSidecar::TerrainDecalSidecarHeader header{
+            .versionMajor = TerrainDecalSidecar::kLegacyVersionMajor,
+            .versionMinor = 0,
+        };
+        MemoryOStream out;
+        out.Reset(kHeaderBytes + static_cast<size_t>(recordCount) * oldRecordSize);
+        out.SetUint32(header.magic);
+        out.SetUint16(header.versionMajor);
+        out.SetUint16(header.versionMinor);
+        out.SetUint32(header.flags);
+        out.SetUint32(header.chunkCount);
+        out.SetUint32(TerrainDecalSidecar::kChunkTagTerrainDecals);
+        out.SetUint32(oldRecordSize * recordCount);
+        out.SetUint32(oldRecordSize);
+        out.SetUint32(recordCount);
+        for (uint32_t i = 0; i < recordCount; ++i) {
+            out.SetVoid(v11.data() + kHeaderBytes + static_cast<size_t>(i) * sizeof(PersistedTerrainDecal), oldRecordSize);
+        }
+        return out.Bytes();
+    }
+}
@@ -0,0 +1,544 @@
+// Command-line tool for terrain decal sidecars (the TDCS record a city save stores managed decals in).
+//
+//   SC4DecalSidecarTool validate <sidecar>
+//   SC4DecalSidecarTool dump <sidecar> [--format csv|json]
+//   SC4DecalSidecarTool convert <in> <out> --to 1.0|1.1|2.0
+//   SC4DecalSidecarTool bench [--decals N[,N...]] [--repeats N] [--data typical|random]
+//
+// <sidecar> is the raw record body (type E5C2B9A8, group 'TDCS', instance 1) as exported from the save
+// with a DBPF editor. Everything goes through TerrainDecalSidecarCodec, so the tool accepts and writes
+// exactly what the plugin does. validate and convert exit 1 on a malformed sidecar; usage errors exit 2.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "SidecarSupport.h"
+#include "TerrainDecalSidecarCache.h"
+#include "TerrainDecalSidecarCodec.h"
+
+namespace
+{
+    using SidecarSupport::MemoryIStream;
+    using SidecarSupport::MemoryOStream;
+
+    constexpr int kExitInvalid = 1;
+    constexpr int kExitUsage = 2;
+
+    int Usage()
+    {
+        std::fprintf(stderr,
+                     "usage: SC4DecalSidecarTool validate <sidecar>\n"
+                     "       SC4DecalSidecarTool dump <sidecar> [--format csv|json]\n"
+                     "       SC4DecalSidecarTool convert <in> <out> --to 1.0|1.1|2.0\n"
+                     "       SC4DecalSidecarTool bench [--decals N[,N...]] [--repeats N] [--data typical|random]\n");
+        return kExitUsage;
+    }
+
+    [[nodiscard]] bool ReadFile(const char* const path, std::vector<std::byte>& bytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "cannot open %s\n", path);
+            return false;
+        }
+
+        std::vector<char> chars{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        bytes.resize(chars.size());
+        std::memcpy(bytes.data(), chars.data(), chars.size());
+        return true;
+    }
+
+    [[nodiscard]] bool WriteFile(const char* const path, const std::vector<std::byte>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) {
+            std::fprintf(stderr, "cannot write %s\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::string TagName(const uint32_t tag)
+    {
+        std::string name(4, '?');
+        for (int i = 0; i < 4; ++i) {
+            const char c = static_cast<char>((tag >> (8 * i)) & 0xFF);
+            name[i] = c >= 0x20 && c < 0x7F ? c : '?';
+        }
+        return name;
+    }
+
+    // Little-endian reader over the raw sidecar, used to describe the layout before the codec decodes it.
+    class LayoutCursor
+    {
+    public:
+        explicit LayoutCursor(const std::vector<std::byte>& bytes) : bytes_(bytes) {}
+
+        template <typename T>
+        bool Get(T& value)
+        {
+            if (bytes_.size() - offset_ < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, bytes_.data() + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        bool Skip(const size_t size)
+        {
+            if (bytes_.size() - offset_ < size) {
+                return false;
+            }
+            offset_ += size;
+            return true;
+        }
+
+        // Leading varint of the next size bytes, without consuming them.
+        bool PeekVarint(const size_t size, uint64_t& value) const
+        {
+            value = 0;
+            const size_t end = std::min(bytes_.size(), offset_ + size);
+            for (size_t i = offset_, shift = 0; i < end && shift < 64; ++i, shift += 7) {
+                const auto byte = static_cast<uint8_t>(bytes_[i]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] size_t Remaining() const noexcept { return bytes_.size() - offset_; }
+
+    private:
+        const std::vector<std::byte>& bytes_;
+        size_t offset_ = 0;
+    };
+
+    [[nodiscard]] bool DescribeLegacyChunk(LayoutCursor& cursor)
+    {
+        using namespace TerrainDecalSidecar;
+
+        TerrainDecalChunkHeader chunk{};
+        if (!cursor.Get(chunk.tag) || !cursor.Get(chunk.payloadBytes) ||
+            !cursor.Get(chunk.recordSize) || !cursor.Get(chunk.recordCount)) {
+            std::printf("error: truncated chunk header\n");
+            return false;
+        }
+
+        std::printf("chunk 0: %s, %u bytes, %u records of %u bytes\n",
+                    TagName(chunk.tag).c_str(), chunk.payloadBytes, chunk.recordCount, chunk.recordSize);
+
+        constexpr uint32_t v10RecordSize = offsetof(PersistedTerrainDecal, depthOffset);
+        bool ok = true;
+        if (chunk.tag != kChunkTagTerrainDecals) {
+            std::printf("error: expected chunk tag %s\n", TagName(kChunkTagTerrainDecals).c_str());
+            ok = false;
+        }
+        if (chunk.recordSize != v10RecordSize && chunk.recordSize < sizeof(PersistedTerrainDecal)) {
+            std::printf("error: record size %u is neither the 1.0 (%u) nor the 1.1 (%zu) layout\n",
+                        chunk.recordSize, v10RecordSize, sizeof(PersistedTerrainDecal));
+            ok = false;
+        }
+        else if (chunk.recordSize > sizeof(PersistedTerrainDecal)) {
+            std::printf("note: records are %u bytes; bytes past %zu belong to a newer minor version and are ignored\n",
+                        chunk.recordSize, sizeof(PersistedTerrainDecal));
+        }
+        if (chunk.payloadBytes != static_cast<uint64_t>(chunk.recordCount) * chunk.recordSize) {
+            std::printf("error: payload is %u bytes, %u records of %u bytes need %llu\n",
+                        chunk.payloadBytes, chunk.recordCount, chunk.recordSize,
+                        static_cast<unsigned long long>(static_cast<uint64_t>(chunk.recordCount) * chunk.recordSize));
+            ok = false;
+        }
+        if (!cursor.Skip(chunk.payloadBytes)) {
+            std::printf("error: payload runs %zu bytes past the end of the sidecar\n",
+                        chunk.payloadBytes - cursor.Remaining());
+            ok = false;
+        }
+        return ok;
+    }
+
+    [[nodiscard]] bool DescribeCompactChunks(LayoutCursor& cursor, const uint32_t chunkCount)
+    {
+        using namespace TerrainDecalSidecar;
+
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            TerrainDecalCompactChunkHeader chunk{};
+            if (!cursor.Get(chunk.tag) || !cursor.Get(chunk.payloadBytes)) {
+                std::printf("error: truncated header for chunk %u\n", i);
+                return false;
+            }
+
+            uint64_t count = 0;
+            const bool hasCount = cursor.PeekVarint(chunk.payloadBytes, count);
+            if (chunk.tag == kChunkTagTextureKeys) {
+                std::printf("chunk %u: %s, %u bytes, %llu texture keys\n", i, TagName(chunk.tag).c_str(),
+                            chunk.payloadBytes, static_cast<unsigned long long>(count));
+            }
+            else if (chunk.tag == kChunkTagCompactDecals) {
+                std::printf("chunk %u: %s, %u bytes, %llu records\n", i, TagName(chunk.tag).c_str(),
+                            chunk.payloadBytes, static_cast<unsigned long long>(count));
+            }
+            else {
+                std::printf("chunk %u: %s, %u bytes, unknown tag (skipped)\n", i, TagName(chunk.tag).c_str(),
+                            chunk.payloadBytes);
+            }
+
+            if (!hasCount && (chunk.tag == kChunkTagTextureKeys || chunk.tag == kChunkTagCompactDecals)) {
+                std::printf("error: chunk %u has no valid count\n", i);
+                return false;
+            }
+            if (!cursor.Skip(chunk.payloadBytes)) {
+                std::printf("error: chunk %u runs %zu bytes past the end of the sidecar\n",
+                            i, chunk.payloadBytes - cursor.Remaining());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Prints the header and chunk table, then decodes the whole sidecar with the codec.
+    [[nodiscard]] bool Validate(const std::vector<std::byte>& bytes)
+    {
+        using namespace TerrainDecalSidecar;
+
+        LayoutCursor cursor(bytes);
+        TerrainDecalSidecarHeader header{};
+        if (!cursor.Get(header.magic) || !cursor.Get(header.versionMajor) || !cursor.Get(header.versionMinor) ||
+            !cursor.Get(header.flags) || !cursor.Get(header.chunkCount)) {
+            std::printf("error: %zu bytes is too short for a sidecar header\n", bytes.size());
+            return false;
+        }
+
+        std::printf("header: magic %s, version %u.%u, flags %08X, %u chunks, %zu bytes\n",
+                    TagName(header.magic).c_str(), header.versionMajor, header.versionMinor,
+                    header.flags, header.chunkCount, bytes.size());
+        if (header.magic != kMagic) {
+            std::printf("error: expected magic %s\n", TagName(kMagic).c_str());
+            return false;
+        }
+
+        bool ok = true;
+        if (header.versionMajor == kLegacyVersionMajor) {
+            if (header.chunkCount != 1) {
+                std::printf("error: 1.x sidecars have exactly one chunk\n");
+                return false;
+            }
+            ok = DescribeLegacyChunk(cursor);
+        }
+        else if (header.versionMajor == kVersionMajor) {
+            ok = DescribeCompactChunks(cursor, header.chunkCount);
+        }
+        else {
+            std::printf("error: major version %u is not supported (reads %u and %u)\n",
+                        header.versionMajor, kLegacyVersionMajor, kVersionMajor);
+            return false;
+        }
+
+        if (ok && cursor.Remaining() != 0) {
+            std::printf("warning: %zu trailing bytes after the last chunk\n", cursor.Remaining());
+        }
+
+        MemoryIStream in(bytes);
+        const ReadResult result = Read(in);
+        if (!result.ok) {
+            std::printf("error: decode failed: %s\n", result.error.c_str());
+            return false;
+        }
+
+        std::unordered_set<uint32_t> ids;
+        uint32_t duplicates = 0;
+        uint32_t zeroIds = 0;
+        for (const TerrainDecalSnapshot& decal : result.decals) {
+            if (decal.id.value == 0) {
+                ++zeroIds;
+            }
+            else if (!ids.insert(decal.id.value).second) {
+                ++duplicates;
+            }
+        }
+
+        std::printf("decoded %zu decals\n", result.decals.size());
+        if (zeroIds != 0 || duplicates != 0) {
+            std::printf("warning: %u decals with id 0 and %u duplicate ids; the game skips them on load\n",
+                        zeroIds, duplicates);
+        }
+        return ok;
+    }
+
+    [[nodiscard]] bool Decode(const std::vector<std::byte>& bytes, std::vector<TerrainDecalSnapshot>& decals)
+    {
+        MemoryIStream in(bytes);
+        TerrainDecalSidecar::ReadResult result = TerrainDecalSidecar::Read(in);
+        if (!result.ok) {
+            std::fprintf(stderr, "invalid sidecar: %s\n", result.error.c_str());
+            return false;
+        }
+        decals = std::move(result.decals);
+        return true;
+    }
+
+    void DumpCsv(const std::vector<TerrainDecalSnapshot>& decals)
+    {
+        std::printf("id,textureType,textureGroup,textureInstance,overlayType,centerX,centerZ,baseSize,"
+                    "rotationTurns,aspectMultiplier,uvScaleU,uvScaleV,uvOffset,unknown8,opacity,enabled,"
+                    "colorR,colorG,colorB,flags,drawMode,hasUvWindow,u1,v1,u2,v2,uvMode,depthOffset\n");
+        for (const TerrainDecalSnapshot& decal : decals) {
+            const TerrainDecalState& s = decal.state;
+            const cISTEOverlayManager::cDecalInfo& info = s.decalInfo;
+            std::printf("%u,0x%08X,0x%08X,0x%08X,%u,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%d,"
+                        "%.9g,%.9g,%.9g,%u,%u,%d,%.9g,%.9g,%.9g,%.9g,%u,%d\n",
+                        decal.id.value,
+                        s.textureKey.type, s.textureKey.group, s.textureKey.instance,
+                        static_cast<uint32_t>(s.overlayType),
+                        info.center.fX, info.center.fY, info.baseSize, info.rotationTurns, info.aspectMultiplier,
+                        info.uvScaleU, info.uvScaleV, info.uvOffset, info.unknown8,
+                        s.opacity, s.enabled ? 1 : 0,
+                        s.color.fX, s.color.fY, s.color.fZ,
+                        s.flags, static_cast<uint32_t>(s.drawMode), s.hasUvWindow ? 1 : 0,
+                        s.uvWindow.u1, s.uvWindow.v1, s.uvWindow.u2, s.uvWindow.v2,
+                        static_cast<uint32_t>(s.uvWindow.mode), s.depthOffset);
+        }
+    }
+
+    void DumpJson(const std::vector<TerrainDecalSnapshot>& decals)
+    {
+        std::printf("[\n");
+        for (size_t i = 0; i < decals.size(); ++i) {
+            const TerrainDecalSnapshot& decal = decals[i];
+            const TerrainDecalState& s = decal.state;
+            const cISTEOverlayManager::cDecalInfo& info = s.decalInfo;
+            std::printf("  {\"id\": %u, \"texture\": [\"0x%08X\", \"0x%08X\", \"0x%08X\"], \"overlayType\": %u, "
+                        "\"center\": [%.9g, %.9g], \"baseSize\": %.9g, \"rotationTurns\": %.9g, "
+                        "\"aspectMultiplier\": %.9g, \"uvScale\": [%.9g, %.9g], \"uvOffset\": %.9g, "
+                        "\"unknown8\": %.9g, \"opacity\": %.9g, \"enabled\": %s, \"color\": [%.9g, %.9g, %.9g], "
+                        "\"flags\": %u, \"drawMode\": %u, \"hasUvWindow\": %s, "
+                        "\"uvWindow\": [%.9g, %.9g, %.9g, %.9g], \"uvMode\": %u, \"depthOffset\": %d}%s\n",
+                        decal.id.value,
+                        s.textureKey.type, s.textureKey.group, s.textureKey.instance,
+                        static_cast<uint32_t>(s.overlayType),
+                        info.center.fX, info.center.fY, info.baseSize, info.rotationTurns,
+                        info.aspectMultiplier, info.uvScaleU, info.uvScaleV, info.uvOffset,
+                        info.unknown8, s.opacity, s.enabled ? "true" : "false", s.color.fX, s.color.fY, s.color.fZ,
+                        s.flags, static_cast<uint32_t>(s.drawMode), s.hasUvWindow ? "true" : "false",
+                        s.uvWindow.u1, s.uvWindow.v1, s.uvWindow.u2, s.uvWindow.v2,
+                        static_cast<uint32_t>(s.uvWindow.mode), s.depthOffset,
+                        i + 1 < decals.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+
+    enum class Format
+    {
+        V10,
+        V11,
+        V20,
+    };
+
+    [[nodiscard]] bool ParseFormat(const std::string_view text, Format& format)
+    {
+        if (text == "1.0") {
+            format = Format::V10;
+        }
+        else if (text == "1.1") {
+            format = Format::V11;
+        }
+        else if (text == "2.0") {
+            format = Format::V20;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    // 2.0 goes through TerrainDecalSidecarCache so the chunks are split by region exactly as a save does.
+    [[nodiscard]] std::vector<std::byte> Encode(const std::vector<TerrainDecalSnapshot>& decals, const Format format)
+    {
+        MemoryOStream out;
+        out.Reset(32 + decals.size() * sizeof(TerrainDecalSidecar::PersistedTerrainDecal));
+        if (format == Format::V20) {
+            TerrainDecalSidecarCache cache;
+            (void)cache.Rebuild(decals);
+            cache.Write(out);
+            return out.Bytes();
+        }
+
+        TerrainDecalSidecar::WriteLegacy(out, decals);
+        return format == Format::V10 ? SidecarSupport::DowngradeToV10(out.Bytes()) : out.Bytes();
+    }
+
+    [[nodiscard]] double ElapsedMs(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int RunBench(const std::vector<size_t>& counts, const int repeats, const bool typical)
+    {
+        std::printf("SC4DecalSidecarTool bench: %s snapshots, best of %d\n", typical ? "typical" : "random", repeats);
+        std::printf("%-8s %8s %10s %10s %10s %10s %12s %12s\n",
+                    "format", "decals", "bytes/rec", "size KB", "write ms", "read ms", "write dec/s", "read dec/s");
+
+        bool ok = true;
+        for (const size_t count : counts) {
+            const std::vector<TerrainDecalSnapshot> snapshots =
+                typical ? SidecarSupport::MakeTypicalSnapshots(count, 1) : SidecarSupport::MakeSnapshots(count, 1);
+
+            for (const Format format : {Format::V11, Format::V20}) {
+                std::vector<std::byte> wire;
+                double writeMs = 0.0;
+                double readMs = 0.0;
+                for (int i = 0; i < repeats; ++i) {
+                    auto start = std::chrono::steady_clock::now();
+                    wire = Encode(snapshots, format);
+                    const double write = ElapsedMs(start);
+
+                    start = std::chrono::steady_clock::now();
+                    MemoryIStream in(wire);
+                    const TerrainDecalSidecar::ReadResult result = TerrainDecalSidecar::Read(in);
+                    const double read = ElapsedMs(start);
+                    ok = ok && result.ok && result.decals.size() == count;
+
+                    writeMs = i == 0 ? write : std::min(writeMs, write);
+                    readMs = i == 0 ? read : std::min(readMs, read);
+                }
+
+                const auto perSecond = [count](const double ms) {
+                    return ms > 0.0 ? static_cast<double>(count) * 1000.0 / ms : 0.0;
+                };
+                std::printf("%-8s %8zu %10.1f %10.1f %10.3f %10.3f %12.3g %12.3g\n",
+                            format == Format::V20 ? "2.0" : "1.1",
+                            count,
+                            static_cast<double>(wire.size()) / static_cast<double>(std::max<size_t>(count, 1)),
+                            static_cast<double>(wire.size()) / 1024.0,
+                            writeMs,
+                            readMs,
+                            perSecond(writeMs),
+                            perSecond(readMs));
+            }
+        }
+
+        if (!ok) {
+            std::printf("decode failed\n");
+        }
+        return ok ? 0 : kExitInvalid;
+    }
+
+    [[nodiscard]] bool ParseCounts(const std::string_view text, std::vector<size_t>& counts)
+    {
+        counts.clear();
+        size_t first = 0;
+        while (first <= text.size()) {
+            const size_t comma = std::min(text.find(',', first), text.size());
+            const std::string item(text.substr(first, comma - first));
+            char* end = nullptr;
+            const unsigned long long value = std::strtoull(item.c_str(), &end, 10);
+            if (item.empty() || *end != '\0' || value == 0 || value > 10'000'000) {
+                return false;
+            }
+            counts.push_back(static_cast<size_t>(value));
+            first = comma + 1;
+        }
+        return !counts.empty();
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    if (argc < 2) {
+        return Usage();
+    }
+
+    const std::string_view command = argv[1];
+    if (command == "validate" && argc == 3) {
+        std::vector<std::byte> bytes;
+        if (!ReadFile(argv[2], bytes)) {
+            return kExitInvalid;
+        }
+        const bool ok = Validate(bytes);
+        std::printf("%s\n", ok ? "OK" : "INVALID");
+        return ok ? 0 : kExitInvalid;
+    }
+
+    if (command == "dump" && (argc == 3 || argc == 5)) {
+        bool json = false;
+        if (argc == 5) {
+            const std::string_view format = argv[4];
+            if (std::string_view(argv[3]) != "--format" || (format != "csv" && format != "json")) {
+                return Usage();
+            }
+            json = format == "json";
+        }
+
+        std::vector<std::byte> bytes;
+        std::vector<TerrainDecalSnapshot> decals;
+        if (!ReadFile(argv[2], bytes) || !Decode(bytes, decals)) {
+            return kExitInvalid;
+        }
+        json ? DumpJson(decals) : DumpCsv(decals);
+        return 0;
+    }
+
+    if (command == "convert" && argc == 6 && std::string_view(argv[4]) == "--to") {
+        Format format{};
+        if (!ParseFormat(argv[5], format)) {
+            return Usage();
+        }
+
+        std::vector<std::byte> bytes;
+        std::vector<TerrainDecalSnapshot> decals;
+        if (!ReadFile(argv[2], bytes) || !Decode(bytes, decals)) {
+            return kExitInvalid;
+        }
+
+        const std::vector<std::byte> converted = Encode(decals, format);
+        if (!WriteFile(argv[3], converted)) {
+            return kExitInvalid;
+        }
+        std::printf("wrote %zu decals, %zu bytes (was %zu)\n", decals.size(), converted.size(), bytes.size());
+        return 0;
+    }
+
+    if (command == "bench") {
+        std::vector<size_t> counts{1000, 10000, 50000};
+        int repeats = 5;
+        bool typical = true;
+        for (int i = 2; i < argc; i += 2) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                return Usage();
+            }
+            const std::string_view value = argv[i + 1];
+            if (option == "--decals") {
+                if (!ParseCounts(value, counts)) {
+                    return Usage();
+                }
+            }
+            else if (option == "--repeats") {
+                repeats = std::max(1, std::atoi(argv[i + 1]));
+            }
+            else if (option == "--data" && (value == "typical" || value == "random")) {
+                typical = value == "typical";
+            }
+            else {
+                return Usage();
+            }
+        }
+        return RunBench(counts, repeats, typical);
+    }
+
+    return Usage();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cIGZUnknown.h"
+
+// Host stand-in for the game's output stream interface, limited to what TerrainDecalSidecarCodec calls.
+// Only the sidecar bench and tool build against it; the plugin uses the real gzcom-dll header.
+class cIGZOStream : public cIGZUnknown
+{
+public:
+    virtual bool SetUint16(uint16_t value) = 0;
+    virtual bool SetUint32(uint32_t value) = 0;
+    virtual bool SetFloat32(float value) = 0;
+    virtual bool SetVoid(const void* buffer, uint32_t size) = 0;
+    virtual int32_t GetError() = 0;
+};